@@ -2,99 +2,219 @@
 
 int32_t CAtomBiquad::init(const CQuarkProps &props)
 {
-    setProps(props);
-
-    m_TargetStates = new tAtomBiquadStates *[props.m_NumChOut];
-    m_DeltaStates = new tAtomBiquadStates *[props.m_NumChOut];
-    m_States = new tAtomBiquadStates *[props.m_NumChOut];
-    m_TargetCoeffs = new tAtomBiquadCoeffs *[props.m_NumChOut];
-    m_DeltaCoeffs = new tAtomBiquadCoeffs *[props.m_NumChOut];
-    m_Coeffs = new tAtomBiquadCoeffs *[props.m_NumChOut];
+    if (0 != initMem(props))
+        return -1;
 
     for (auto ch = 0; ch < props.m_NumChOut; ch++)
     {
-        m_TargetStates[ch] = new tAtomBiquadStates[props.m_NumEl]();
-        m_DeltaStates[ch] = new tAtomBiquadStates[props.m_NumEl]();
-        m_States[ch] = new tAtomBiquadStates[props.m_NumEl]();
-        m_TargetCoeffs[ch] = new tAtomBiquadCoeffs[props.m_NumEl]();
-        m_DeltaCoeffs[ch] = new tAtomBiquadCoeffs[props.m_NumEl]();
-        m_Coeffs[ch] = new tAtomBiquadCoeffs[props.m_NumEl]();
         for(auto el = 0; el < props.m_NumEl; el++)
             m_Coeffs[ch][el].b1 = 1.0F; // init state = bypass
-        
     }
 
+    updateActiveSections();
+
     return 0;
 }
 
+size_t CAtomBiquad::getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo,
+                                      const size_t paramQueueSize)
+{
+    CAtomBiquad atom;
+    return atom.measureMem(props, interleavedIo, paramQueueSize);
+}
+
+void CAtomBiquad::layoutMem(CAtomMemLayout &mem)
+{
+    cint32_t numCh = m_Props.m_NumChOut;
+    cint32_t numEl = m_Props.m_NumEl;
+
+    m_TargetCoeffs = mem.take<tAtomBiquadCoeffs *>(numCh);
+    m_DeltaCoeffs = mem.take<tAtomBiquadCoeffs *>(numCh);
+    m_Coeffs = mem.take<tAtomBiquadCoeffs *>(numCh);
+    m_States = mem.take<tAtomBiquadStates *>(numCh);
+    m_ActiveEl = mem.take<int32_t *>(numCh);
+    m_NumActiveEl = mem.take<int32_t>(numCh);
+    m_StateEnergy = mem.take<float32_t>(numCh);
+
+    // one contiguous array per quantity, split in rows per channel
+    tAtomBiquadCoeffs *targetCoeffs = mem.take<tAtomBiquadCoeffs>(numCh * numEl);
+    tAtomBiquadCoeffs *deltaCoeffs = mem.take<tAtomBiquadCoeffs>(numCh * numEl);
+    tAtomBiquadCoeffs *coeffs = mem.take<tAtomBiquadCoeffs>(numCh * numEl);
+    tAtomBiquadStates *states = mem.take<tAtomBiquadStates>(numCh * numEl);
+    int32_t *activeEl = mem.take<int32_t>(numCh * numEl);
+
+    if (mem.isCarving())
+    {
+        for (auto ch = 0; ch < numCh; ch++)
+        {
+            m_TargetCoeffs[ch] = &targetCoeffs[ch * numEl];
+            m_DeltaCoeffs[ch] = &deltaCoeffs[ch * numEl];
+            m_Coeffs[ch] = &coeffs[ch * numEl];
+            m_States[ch] = &states[ch * numEl];
+            m_ActiveEl[ch] = &activeEl[ch * numEl];
+        }
+    }
+}
+
 void CAtomBiquad::play(float32_t **const in, float32_t **const out)
 {
     if (NULL != out && NULL != in)
+        playSegments(in, out);
+}
+
+void CAtomBiquad::playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                            cint32_t start, cint32_t len)
+{
+    if (NULL != out && NULL != in)
+        playSliceIo(CAtomPlanar<float32_t>(in), CAtomPlanar<float32_t>(out), chBegin, chEnd, start, len);
+}
+
+void CAtomBiquad::playInterleaved(const float32_t *in, float32_t *out)
+{
+    if (NULL != out && NULL != in)
+        playSegmentsInterleaved(in, out);
+}
+
+void CAtomBiquad::playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len)
+{
+    playSliceIo(CAtomInterleaved<const float32_t>(in, m_Props.m_NumChIn),
+                CAtomInterleaved<float32_t>(out, m_Props.m_NumChOut), 0, m_Props.m_NumChOut, start, len);
+}
+
+template <class IN, class OUT>
+void CAtomBiquad::playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                              cint32_t start, cint32_t len)
+{
+    constexpr bool_t planar = IN::PLANAR && OUT::PLANAR;
+    cint32_t numMorph = getNumMorphSamples(len);
+    cint32_t stepOut = out.step();
+    if (numMorph > 0)
     {
-        if (m_MorphBlocksizeCnt > 0)
+        for (auto ch = chBegin; ch < chEnd; ch++)
         {
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+            const float32_t *pIn = in.ptr(ch, start);
+            float32_t *pOut = out.ptr(ch, start);
+            int32_t stepIn = in.step();
+            for (auto n = 0; n < m_NumActiveEl[ch]; n++)
             {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                for (auto el = 0; el < m_Props.m_NumEl; el++)
+                auto el = m_ActiveEl[ch][n];
+                tAtomBiquadCoeffs *pCoeffs = &m_Coeffs[ch][el];
+                tAtomBiquadCoeffs *pCoeffsDelta = &m_DeltaCoeffs[ch][el];
+                tAtomBiquadStates *pStates = &m_States[ch][el];
+                float32_t *pS2 = &pStates->s2;
+                float32_t *pS1 = &pStates->s1;
+                for (auto i = 0; i < numMorph; i++)
                 {
-                    tAtomBiquadCoeffs *pCoeffs = &m_Coeffs[ch][el];
-                    tAtomBiquadCoeffs *pCoeffsDelta = &m_DeltaCoeffs[ch][el];
-                    tAtomBiquadStates *pStates = &m_States[ch][el];
-                    float32_t *pS2 = &pStates->s2;
-                    float32_t *pS1 = &pStates->s1;
-                    for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                    {
-                        *pCoeffs += *pCoeffsDelta;
-                        // TDF-II
-                        float32_t x = pIn[i];
-                        float32_t y = *pS1 + pCoeffs->b0 * x;
-                        pOut[i] = y;
-                        *pS1 = *pS2 + x * pCoeffs->b1 - pCoeffs->a1 * y;
-                        *pS2 = x * pCoeffs->b2 - pCoeffs->a2 * y;
-                    }
-                    pIn = pOut;
+                    *pCoeffs += *pCoeffsDelta;
+                    // TDF-II
+                    float32_t x = pIn[i * stepIn];
+                    float32_t y = *pS1 + pCoeffs->b0 * x;
+                    pOut[i * stepOut] = y;
+                    *pS1 = *pS2 + x * pCoeffs->b1 - pCoeffs->a1 * y;
+                    *pS2 = x * pCoeffs->b2 - pCoeffs->a2 * y;
                 }
-            }
-            if (--m_MorphBlocksizeCnt <= 0)
-            {
-                for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+                if (numMorph < len)
                 {
-                    for (auto el = 0; el < m_Props.m_NumEl; el++)
-                    {
-                        m_Coeffs[ch][el] = m_TargetCoeffs[ch][el];
-                        m_DeltaCoeffs[ch][el] = {0};
-                    }
+                    // morph ends within the segment
+                    *pCoeffs = m_TargetCoeffs[ch][el];
+                    if constexpr (planar)
+                        processSection(&pIn[numMorph], &pOut[numMorph], *pCoeffs, *pStates, len - numMorph);
+                    else
+                        processSectionStrided(&pIn[numMorph * stepIn], stepIn, &pOut[numMorph * stepOut], stepOut,
+                                              *pCoeffs, *pStates, len - numMorph);
                 }
+                if (m_StateFlush)
+                    flushState(*pStates);
+                pIn = pOut;
+                stepIn = stepOut;
+            }
+            if (pIn != pOut)
+            {
+                for (auto i = 0; i < len; i++)
+                    pOut[i * stepOut] = pIn[i * stepIn];
             }
+            // force a new energy measurement once the morph is over
+            m_StateEnergy[ch] = SILENCE_ENERGY;
         }
-        else
+    }
+    else
+    {
+        for (auto ch = chBegin; ch < chEnd; ch++)
         {
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+            const float32_t *pIn = in.ptr(ch, start);
+            float32_t *pOut = out.ptr(ch, start);
+            int32_t stepIn = in.step();
+
+            if (skipSilence(ch, pIn, pOut, len, stepIn, stepOut))
+                continue;
+
+            float32_t stateEnergy = 0.0F;
+            for (auto n = 0; n < m_NumActiveEl[ch]; n++)
             {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                for (auto el = 0; el < m_Props.m_NumEl; el++)
+                auto el = m_ActiveEl[ch][n];
+                tAtomBiquadStates *pStates = &m_States[ch][el];
+                if constexpr (planar)
+                {
+                    // the first section reads the input, the next ones run in-place
+                    if (pIn != pOut)
+                        processSectionRestrict(pIn, pOut, m_Coeffs[ch][el], *pStates, len);
+                    else
+                        processSection(pIn, pOut, m_Coeffs[ch][el], *pStates, len);
+                }
+                else
                 {
-                    tAtomBiquadCoeffs *pCoeffs = &m_Coeffs[ch][el];
-                    tAtomBiquadStates *pStates = &m_States[ch][el];
-                    float32_t *pS2 = &pStates->s2;
-                    float32_t *pS1 = &pStates->s1;
-                    for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                    {
-                        // TDF-II
-                        float32_t x = pIn[i];
-                        float32_t y = *pS1 + pCoeffs->b0 * x;
-                        pOut[i] = y;
-                        *pS1 = *pS2 + x * pCoeffs->b1 - pCoeffs->a1 * y;
-                        *pS2 = x * pCoeffs->b2 - pCoeffs->a2 * y;
-                    }
-                    pIn = pOut;
+                    processSectionStrided(pIn, stepIn, pOut, stepOut, m_Coeffs[ch][el], *pStates, len);
                 }
+                if (m_StateFlush)
+                    flushState(*pStates);
+                stateEnergy += pStates->s1 * pStates->s1 + pStates->s2 * pStates->s2;
+                pIn = pOut;
+                stepIn = stepOut;
+            }
+            if (pIn != pOut)
+            {
+                for (auto i = 0; i < len; i++)
+                    pOut[i * stepOut] = pIn[i * stepIn];
             }
+            m_StateEnergy[ch] = stateEnergy;
+        }
+    }
+}
+
+bool_t CAtomBiquad::skipSilence(cint32_t ch, const float32_t *pIn, float32_t *pOut, cint32_t len,
+                                cint32_t stepIn, cint32_t stepOut)
+{
+    float32_t inEnergy = 0.0F;
+    for (auto i = 0; i < len; i++)
+        inEnergy += pIn[i * stepIn] * pIn[i * stepIn];
+
+    if (inEnergy < SILENCE_ENERGY && m_StateEnergy[ch] < SILENCE_ENERGY)
+    {
+        // silent input and decayed states: flush once, then skip
+        if (m_StateEnergy[ch] > 0.0F)
+        {
+            for (auto el = 0; el < m_Props.m_NumEl; el++)
+                m_States[ch][el] = {0};
+            m_StateEnergy[ch] = 0.0F;
+        }
+        for (auto i = 0; i < len; i++)
+            pOut[i * stepOut] = 0.0F;
+        return true;
+    }
+    return false;
+}
+
+void CAtomBiquad::endMorph(void)
+{
+    for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+    {
+        for (auto el = 0; el < m_Props.m_NumEl; el++)
+        {
+            m_Coeffs[ch][el] = m_TargetCoeffs[ch][el];
+            m_DeltaCoeffs[ch][el] = {0};
         }
     }
+    updateActiveSections();
 }
 
 void CAtomBiquad::set(void *params, cint32_t len)
@@ -110,13 +230,79 @@ void CAtomBiquad::set(void *params, cint32_t len)
             p_biq_params++;
         }
 
-        startMorph();
+        commitParams();
     }
 }
 
+int32_t CAtomBiquad::post(void *params, cint32_t len, cint32_t offset)
+{
+    int32_t retval = -1;
+    if (NULL != params && len > 0)
+    {
+        tAtomBiquadParams *p_biq_params = reinterpret_cast<tAtomBiquadParams *>(params);
+        int32_t num = len / sizeof(tAtomBiquadParams);
+
+        retval = 0;
+        for (auto i = 0; i < num && 0 == retval; i++)
+        {
+            tAtomParamMsg msg;
+            if (prepareCoeffs(*p_biq_params, msg))
+            {
+                msg.offset = offset;
+                retval = pushParam(msg);
+            }
+            else
+                retval = -1;
+            p_biq_params++;
+        }
+    }
+    return retval;
+}
+
+bool_t CAtomBiquad::prepareCoeffs(const tAtomBiquadParams &params, tAtomParamMsg &msg)
+{
+    static_assert(sizeof(tAtomBiquadCoeffs) <= sizeof(msg.val), "coefficients do not fit a message");
+
+    if (
+        nullptr == m_Coeffs ||
+        params.ch < 0 || params.ch >= m_Props.m_NumChIn ||
+        params.el < 0 || params.el >= m_Props.m_NumEl ||
+        params.type >= NUM_BIQT)
+        return false;
+
+    tAtomBiquadCoeffs coeffs;
+    calculateCoeffs(params, m_Props.m_Fs, coeffs);
+    msg.ch = params.ch;
+    msg.el = params.el;
+    memcpy(msg.val, &coeffs, sizeof(coeffs));
+    return true;
+}
+
+void CAtomBiquad::applyParam(const tAtomParamMsg &msg)
+{
+    tAtomBiquadCoeffs *tc = &m_TargetCoeffs[msg.ch][msg.el];
+    memcpy(tc, msg.val, sizeof(tAtomBiquadCoeffs));
+
+    tAtomBiquadCoeffs *c = &m_Coeffs[msg.ch][msg.el];
+    if (m_MorphSamplesTotal > 0)
+    {
+        m_DeltaCoeffs[msg.ch][msg.el] = (*tc - *c) / (float32_t)m_MorphSamplesTotal;
+    }
+    else
+    {
+        *c = *tc;
+    }
+}
+
+void CAtomBiquad::commitParams(void)
+{
+    startMorph();
+    updateActiveSections();
+}
+
 void CAtomBiquad::calculateDeltas(void)
 {
-    if (m_MorphBlocksizeTotal > 0)
+    if (m_MorphSamplesTotal > 0)
     {
         for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
         {
@@ -126,7 +312,7 @@ void CAtomBiquad::calculateDeltas(void)
                 tAtomBiquadCoeffs *tc = &m_TargetCoeffs[ch][el];
                 tAtomBiquadCoeffs *dc = &m_DeltaCoeffs[ch][el];
 
-                *dc = (*tc - *c) / (float32_t)(m_MorphBlocksizeTotal * m_Props.m_BlockSize);
+                *dc = (*tc - *c) / (float32_t)m_MorphSamplesTotal;
             }
         }
     }
@@ -140,184 +326,190 @@ void CAtomBiquad::calculateDeltas(void)
                 memset(&m_DeltaCoeffs[ch][el], 0, sizeof(tAtomBiquadCoeffs));
             }
         }
+        updateActiveSections();
     }
 }
 
-void CAtomBiquad::calculateCoeffsCookbook(const tAtomBiquadParams &params)
+void CAtomBiquad::updateActiveSections(void)
 {
-    if (
-        nullptr != m_Coeffs &&
-        params.ch < m_Props.m_NumChIn &&
-        params.el < m_Props.m_NumEl &&
-        params.type < NUM_BIQT)
+    for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
     {
-        // clipping values
-        float32_t gainDb = CLIP(params.gainDb, MUTE_DB_FS, 50.F);
-        float32_t f0 = CLIP(params.freq, 0.F, m_Props.m_Fs * 0.5F);
-        float32_t q = CLIP(params.q, 0.01F, 50.0F);
-        // intermediate variables
-        float32_t A = sqrtf(powf(10.F, (gainDb * 0.05F)));
-        float32_t a0;
-        tAtomBiquadCoeffs *tc = &m_TargetCoeffs[params.ch][params.el];
-
-        float32_t w0 = 2.F * (float32_t)M_PI * f0 / m_Props.m_Fs;
-        float32_t cosw0 = cosf(w0);
-        float32_t sinw0 = sinf(w0);
-        float32_t alpha = sinw0 / (2.F * q);
-
-        switch (params.type)
-        {
-        case BIQT_LPF_6DB:
+        int32_t numActive = 0;
+        for (auto el = 0; el < m_Props.m_NumEl; el++)
         {
-            // H(s) = 1 / (s + 1)
-            float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
-            a0 = K + 1.F;
-            tc->a1 = (1.F - K);
-            tc->a2 = 0.0F;
-            tc->b0 = 1.0F;
-            tc->b1 = 1.0F;
-            tc->b2 = 0.0F;
+            if (!m_Coeffs[ch][el].isIdentity() || !m_TargetCoeffs[ch][el].isIdentity())
+                m_ActiveEl[ch][numActive++] = el;
+            else
+                m_States[ch][el] = {0}; // skipped, so that it starts clean once active
         }
-        break;
-        case BIQT_LPF:
-        {
-            tc->b0 = (1.F - cosw0) * 0.5F;
-            tc->b1 = 1.F - cosw0;
-            tc->b2 = (1.F - cosw0) * 0.5F;
-            a0 = 1.F + alpha;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha;
-        }
-        break;
-        case BIQT_HPF_6DB:
-        {
-            // H(s) = s / (s + 1)
-            float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
-            a0 = K + 1.F;
-            tc->a1 = 1.F - K;
-            tc->b0 = K;
-            tc->b1 = -K;
-            tc->b2 = 0.0F;
-        }
-        break;
-        case BIQT_HPF:
-        {
-            tc->b0 = (1.F + cosw0) * 0.5F;
-            tc->b1 = -(1.F + cosw0);
-            tc->b2 = (1.F + cosw0) * 0.5F;
-            a0 = 1.F + alpha;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha;
-        }
-        break;
-        case BIQT_PEAK:
-        {
-            tc->b0 = 1.F + alpha * A;
-            tc->b1 = -2.F * cosw0;
-            tc->b2 = 1.F - alpha * A;
-            a0 = 1.F + alpha / A;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha / A;
-        }
-        break;
-        case BIQT_NOTCH:
-        {
-            tc->b0 = 1.F;
-            tc->b1 = -2.F * cosw0;
-            tc->b2 = 1.F;
-            a0 = 1.F + alpha;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha;
-        }
-        break;
-        case BIQT_BPF:
-        {
-            tc->b0 = alpha;
-            tc->b1 = 0.F;
-            tc->b2 = -alpha;
-            a0 = 1.F + alpha;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha;
-        }
-        break;
-        case BIQT_HSH:
-        {
-            float32_t Ap1 = A + 1.F;
-            float32_t Am1 = A - 1.F;
-            float32_t sqrtA = sqrtf(A);
-            tc->b0 = A * (Ap1 + Am1 * cosw0 + 2.F * sqrtA * alpha);
-            tc->b1 = -2.F * A * (Am1 + Ap1 * cosw0);
-            tc->b2 = A * (Ap1 + Am1 * cosw0 - 2.F * sqrtA * alpha);
-            a0 = Ap1 - Am1 * cosw0 + 2.F * sqrtA * alpha;
-            tc->a1 = 2.F * (Am1 - Ap1 * cosw0);
-            tc->a2 = Ap1 - Am1 * cosw0 - 2.F * sqrtA * alpha;
-        }
-        break;
-        case BIQT_LSH:
-        {
-            float32_t Ap1 = A + 1.F;
-            float32_t Am1 = A - 1.F;
-            float32_t sqrtA = sqrtf(A);
-            tc->b0 = A * (Ap1 - Am1 * cosw0 + 2.F * sqrtA * alpha);
-            tc->b1 = 2.F * A * (Am1 - Ap1 * cosw0);
-            tc->b2 = A * (Ap1 - Am1 * cosw0 - 2.F * sqrtA * alpha);
-            a0 = Ap1 + Am1 * cosw0 + 2.F * sqrtA * alpha;
-            tc->a1 = -2.F * (Am1 + Ap1 * cosw0);
-            tc->a2 = Ap1 + Am1 * cosw0 - 2.F * sqrtA * alpha;
-        }
-        break;
-#if 0 //  TODO: below is not stable
-        case BIQT_APF_180:
-        {
-            // H(s) = (s - 1) / (s + 1)
-            float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
-            a0 = K - 1.0F;
-            tc->a1 = -(K + 1.0F);
-            tc->a2 = 0.0F;
-            tc->b0 = (K + 1.0F);
-            tc->b1 = (1.0F - K);
-            tc->b2 = 0.0F;
-        }
-        break;
-#endif
-        case BIQT_APF:
-        {
-            tc->b0 = 1.F - alpha;
-            tc->b1 = -2.F * cosw0;
-            tc->b2 = 1.F + alpha;
-            a0 = 1.F + alpha;
-            tc->a1 = -2.F * cosw0;
-            tc->a2 = 1.F - alpha;
-        }
-        break;
+        m_NumActiveEl[ch] = numActive;
+    }
+}
 
-        case BIQT_BYPASS:
-        default:
-        {
-            a0 = 1.0F;
-            tc->a1 = 0.0F;
-            tc->a2 = 0.0F;
-            tc->b0 = 1.0F;
-            tc->b1 = 0.0F;
-            tc->b2 = 0.0F;
-        }
-        break;
-        }
+void CAtomBiquad::calculateCoeffsCookbook(const tAtomBiquadParams &params)
+{
+    tAtomParamMsg msg;
+    if (prepareCoeffs(params, msg))
+        applyParam(msg);
+}
+
+void CAtomBiquad::calculateCoeffs(const tAtomBiquadParams &params, cint32_t fs, tAtomBiquadCoeffs &coeffs)
+{
+    // clipping values
+    float32_t gainDb = CLIP(params.gainDb, MUTE_DB_FS, 50.F);
+    float32_t f0 = CLIP(params.freq, 0.F, fs * 0.5F);
+    float32_t q = CLIP(params.q, 0.01F, 50.0F);
+    // intermediate variables
+    float32_t A = sqrtf(powf(10.F, (gainDb * 0.05F)));
+    float32_t a0;
+    tAtomBiquadCoeffs *tc = &coeffs;
 
-        tc->b0 /= a0;
-        tc->b1 /= a0;
-        tc->b2 /= a0;
-        tc->a1 /= a0;
-        tc->a2 /= a0;
+    float32_t w0 = 2.F * (float32_t)M_PI * f0 / fs;
+    float32_t cosw0 = cosf(w0);
+    float32_t sinw0 = sinf(w0);
+    float32_t alpha = sinw0 / (2.F * q);
 
-        tAtomBiquadCoeffs *c = &m_Coeffs[params.ch][params.el];
-        if (m_MorphBlocksizeTotal > 0)
-        {
-            m_DeltaCoeffs[params.ch][params.el] = (*tc - *c) / (float32_t)(m_MorphBlocksizeTotal * m_Props.m_BlockSize);
-        }
-        else
-        {
-            *c = *tc;
-        }
+    switch (params.type)
+    {
+    case BIQT_LPF_6DB:
+    {
+        // H(s) = 1 / (s + 1)
+        float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
+        a0 = K + 1.F;
+        tc->a1 = (1.F - K);
+        tc->a2 = 0.0F;
+        tc->b0 = 1.0F;
+        tc->b1 = 1.0F;
+        tc->b2 = 0.0F;
     }
-}
+    break;
+    case BIQT_LPF:
+    {
+        tc->b0 = (1.F - cosw0) * 0.5F;
+        tc->b1 = 1.F - cosw0;
+        tc->b2 = (1.F - cosw0) * 0.5F;
+        a0 = 1.F + alpha;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha;
+    }
+    break;
+    case BIQT_HPF_6DB:
+    {
+        // H(s) = s / (s + 1)
+        float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
+        a0 = K + 1.F;
+        tc->a1 = 1.F - K;
+        tc->a2 = 0.0F;
+        tc->b0 = K;
+        tc->b1 = -K;
+        tc->b2 = 0.0F;
+    }
+    break;
+    case BIQT_HPF:
+    {
+        tc->b0 = (1.F + cosw0) * 0.5F;
+        tc->b1 = -(1.F + cosw0);
+        tc->b2 = (1.F + cosw0) * 0.5F;
+        a0 = 1.F + alpha;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha;
+    }
+    break;
+    case BIQT_PEAK:
+    {
+        tc->b0 = 1.F + alpha * A;
+        tc->b1 = -2.F * cosw0;
+        tc->b2 = 1.F - alpha * A;
+        a0 = 1.F + alpha / A;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha / A;
+    }
+    break;
+    case BIQT_NOTCH:
+    {
+        tc->b0 = 1.F;
+        tc->b1 = -2.F * cosw0;
+        tc->b2 = 1.F;
+        a0 = 1.F + alpha;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha;
+    }
+    break;
+    case BIQT_BPF:
+    {
+        tc->b0 = alpha;
+        tc->b1 = 0.F;
+        tc->b2 = -alpha;
+        a0 = 1.F + alpha;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha;
+    }
+    break;
+    case BIQT_HSH:
+    {
+        float32_t Ap1 = A + 1.F;
+        float32_t Am1 = A - 1.F;
+        float32_t sqrtA = sqrtf(A);
+        tc->b0 = A * (Ap1 + Am1 * cosw0 + 2.F * sqrtA * alpha);
+        tc->b1 = -2.F * A * (Am1 + Ap1 * cosw0);
+        tc->b2 = A * (Ap1 + Am1 * cosw0 - 2.F * sqrtA * alpha);
+        a0 = Ap1 - Am1 * cosw0 + 2.F * sqrtA * alpha;
+        tc->a1 = 2.F * (Am1 - Ap1 * cosw0);
+        tc->a2 = Ap1 - Am1 * cosw0 - 2.F * sqrtA * alpha;
+    }
+    break;
+    case BIQT_LSH:
+    {
+        float32_t Ap1 = A + 1.F;
+        float32_t Am1 = A - 1.F;
+        float32_t sqrtA = sqrtf(A);
+        tc->b0 = A * (Ap1 - Am1 * cosw0 + 2.F * sqrtA * alpha);
+        tc->b1 = 2.F * A * (Am1 - Ap1 * cosw0);
+        tc->b2 = A * (Ap1 - Am1 * cosw0 - 2.F * sqrtA * alpha);
+        a0 = Ap1 + Am1 * cosw0 + 2.F * sqrtA * alpha;
+        tc->a1 = -2.F * (Am1 + Ap1 * cosw0);
+        tc->a2 = Ap1 + Am1 * cosw0 - 2.F * sqrtA * alpha;
+    }
+    break;
+    case BIQT_APF_180:
+    {
+        // H(s) = (s - 1) / (s + 1)
+        float32_t K = (1.F + cosw0) / sinw0; // 1 / tan(w0/2)
+        a0 = K + 1.0F;
+        tc->a1 = 1.0F - K;
+        tc->a2 = 0.0F;
+        tc->b0 = K - 1.0F;
+        tc->b1 = -(K + 1.0F);
+        tc->b2 = 0.0F;
+    }
+    break;
+    case BIQT_APF:
+    {
+        tc->b0 = 1.F - alpha;
+        tc->b1 = -2.F * cosw0;
+        tc->b2 = 1.F + alpha;
+        a0 = 1.F + alpha;
+        tc->a1 = -2.F * cosw0;
+        tc->a2 = 1.F - alpha;
+    }
+    break;
+
+    case BIQT_BYPASS:
+    default:
+    {
+        a0 = 1.0F;
+        tc->a1 = 0.0F;
+        tc->a2 = 0.0F;
+        tc->b0 = 1.0F;
+        tc->b1 = 0.0F;
+        tc->b2 = 0.0F;
+    }
+    break;
+    }
+
+    tc->b0 /= a0;
+    tc->b1 /= a0;
+    tc->b2 /= a0;
+    tc->a1 /= a0;
+    tc->a2 /= a0;
+}
\ No newline at end of file
@@ -76,6 +76,11 @@ public:
             lhs.b2 /= factor;
             return lhs; // return the result by value (uses move constructor)
         }
+
+        bool_t isIdentity(void) const
+        {
+            return b0 == 1.0F && b1 == 0.0F && b2 == 0.0F && a1 == 0.0F && a2 == 0.0F;
+        }
     } tAtomBiquadCoeffs;
 
     typedef struct
@@ -84,21 +89,63 @@ public:
         float32_t s2;
     } tAtomBiquadStates;
 
+    using CAudioQuarkLinearMorph<float32_t>::init;
+    using CAudioQuarkLinearMorph<float32_t>::play;
+    using CAudioQuarkLinearMorph<float32_t>::playInterleaved;
+
     /**
      * @brief See base class definition
      */
     int32_t init(const CQuarkProps &props) override;
 
+    /**
+     * @brief See base class definition
+     */
+    static size_t getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo = false,
+                                    const size_t paramQueueSize = ATOM_PARAM_QUEUE_SIZE);
+
     /**
      * @brief See base class definition
      */
     void play(float32_t **const in, float32_t **const out) override;
 
+    /**
+     * @brief See base class definition
+     */
+    void playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                   cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playInterleaved(const float32_t *in, float32_t *out) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isSliceable(void) const override { return true; };
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isInPlace(void) const override { return true; };
+
     /**
      * @brief See base class definition
      */
     void set(void *params, cint32_t len) override;
 
+    /**
+     * @brief See base class definition. Expects an array of tAtomBiquadParams,
+     *        the coefficients are calculated on the calling thread.
+     */
+    int32_t post(void *params, cint32_t len, cint32_t offset = 0) override;
+
     /**
      * @brief Calculate the biquad ai bi coefficients
      *
@@ -122,13 +169,267 @@ public:
      */
     void calculateCoeffsCookbook(const tAtomBiquadParams &params);
 
+    /**
+     * @brief Calculate the normalized coefficients of a single section, as
+     *        described in calculateCoeffsCookbook(), without touching any
+     *        instance. params.ch and params.el are ignored.
+     *
+     * @param params
+     * @param fs Sampling rate
+     * @param coeffs Output coefficients
+     */
+    static void calculateCoeffs(const tAtomBiquadParams &params, cint32_t fs, tAtomBiquadCoeffs &coeffs);
+
+    /**
+     * @brief TDF-II kernel of a single section. pIn and pOut may alias.
+     *
+     * @param pIn
+     * @param pOut
+     * @param c Section coefficients
+     * @param st Section states
+     * @param len Number of samples
+     */
+    static inline void processSection(const float32_t *pIn, float32_t *pOut,
+                                      const tAtomBiquadCoeffs &c, tAtomBiquadStates &st, cint32_t len)
+    {
+        float32_t s1 = st.s1;
+        float32_t s2 = st.s2;
+        for (auto i = 0; i < len; i++)
+        {
+            // TDF-II
+            float32_t x = pIn[i];
+            float32_t y = s1 + c.b0 * x;
+            pOut[i] = y;
+            s1 = s2 + x * c.b1 - c.a1 * y;
+            s2 = x * c.b2 - c.a2 * y;
+        }
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    /**
+     * @brief Same as processSection(), out-of-place: pIn and pOut must not
+     *        overlap
+     */
+    static inline void processSectionRestrict(const float32_t *RESTRICT pIn, float32_t *RESTRICT pOut,
+                                              const tAtomBiquadCoeffs &c, tAtomBiquadStates &st,
+                                              cint32_t len)
+    {
+        float32_t s1 = st.s1;
+        float32_t s2 = st.s2;
+        for (auto i = 0; i < len; i++)
+        {
+            // TDF-II
+            float32_t x = pIn[i];
+            float32_t y = s1 + c.b0 * x;
+            pOut[i] = y;
+            s1 = s2 + x * c.b1 - c.a1 * y;
+            s2 = x * c.b2 - c.a2 * y;
+        }
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    /**
+     * @brief Same as processSection(), on samples stepIn / stepOut apart,
+     *        e.g. a channel of interleaved frames
+     */
+    static inline void processSectionStrided(const float32_t *pIn, cint32_t stepIn, float32_t *pOut,
+                                             cint32_t stepOut, const tAtomBiquadCoeffs &c,
+                                             tAtomBiquadStates &st, cint32_t len)
+    {
+        float32_t s1 = st.s1;
+        float32_t s2 = st.s2;
+        for (auto i = 0; i < len; i++)
+        {
+            // TDF-II
+            float32_t x = pIn[i * stepIn];
+            float32_t y = s1 + c.b0 * x;
+            pOut[i * stepOut] = y;
+            s1 = s2 + x * c.b1 - c.a1 * y;
+            s2 = x * c.b2 - c.a2 * y;
+        }
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    /**
+     * @brief Two sections fed by the same input, e.g. the LPF/HPF pair of a band
+     *        split. Each input sample is loaded once for both. pIn may alias
+     *        either output.
+     *
+     * @param pIn
+     * @param pOutA
+     * @param pOutB
+     * @param cA
+     * @param cB
+     * @param stA
+     * @param stB
+     * @param len Number of samples
+     */
+    static inline void processSectionSplit(const float32_t *pIn, float32_t *pOutA, float32_t *pOutB,
+                                           const tAtomBiquadCoeffs &cA, const tAtomBiquadCoeffs &cB,
+                                           tAtomBiquadStates &stA, tAtomBiquadStates &stB, cint32_t len)
+    {
+        float32_t s1A = stA.s1;
+        float32_t s2A = stA.s2;
+        float32_t s1B = stB.s1;
+        float32_t s2B = stB.s2;
+        for (auto i = 0; i < len; i++)
+        {
+            float32_t x = pIn[i];
+            float32_t yA = s1A + cA.b0 * x;
+            float32_t yB = s1B + cB.b0 * x;
+            pOutA[i] = yA;
+            pOutB[i] = yB;
+            s1A = s2A + x * cA.b1 - cA.a1 * yA;
+            s2A = x * cA.b2 - cA.a2 * yA;
+            s1B = s2B + x * cB.b1 - cB.a1 * yB;
+            s2B = x * cB.b2 - cB.a2 * yB;
+        }
+        stA.s1 = s1A;
+        stA.s2 = s2A;
+        stB.s1 = s1B;
+        stB.s2 = s2B;
+    }
+
+    /**
+     * @brief Per channel state of the sample kernel, see tick()
+     */
+    typedef struct
+    {
+        const tAtomBiquadCoeffs *coeffs;
+        tAtomBiquadStates *states;
+        const int32_t *activeEl;
+        int32_t numActiveEl;
+    } tAtomBiquadTick;
+
+    /**
+     * @brief Load the current (not morphing) state of channel ch for tick()
+     *
+     * @param ch
+     * @return tAtomBiquadTick
+     */
+    inline tAtomBiquadTick beginTick(cint32_t ch) const
+    {
+        return {m_Coeffs[ch], m_States[ch], m_ActiveEl[ch], m_NumActiveEl[ch]};
+    }
+
+    /**
+     * @brief Process one sample through the active sections, see CAtomChain
+     *
+     * @param t
+     * @param x
+     * @return float32_t
+     */
+    inline float32_t tick(const tAtomBiquadTick &t, float32_t x) const
+    {
+        for (auto n = 0; n < t.numActiveEl; n++)
+        {
+            const tAtomBiquadCoeffs &c = t.coeffs[t.activeEl[n]];
+            tAtomBiquadStates &st = t.states[t.activeEl[n]];
+            // TDF-II
+            float32_t y = st.s1 + c.b0 * x;
+            st.s1 = st.s2 + x * c.b1 - c.a1 * y;
+            st.s2 = x * c.b2 - c.a2 * y;
+            x = y;
+        }
+        return x;
+    }
+
+    /**
+     * @brief Flush the states of channel ch after tick() and update its
+     *        energy for silence detection
+     *
+     * @param ch
+     * @param t
+     */
+    inline void endTick(cint32_t ch, const tAtomBiquadTick &t)
+    {
+        float32_t stateEnergy = 0.0F;
+        for (auto n = 0; n < t.numActiveEl; n++)
+        {
+            tAtomBiquadStates &st = t.states[t.activeEl[n]];
+            if (m_StateFlush)
+                flushState(st);
+            stateEnergy += st.s1 * st.s1 + st.s2 * st.s2;
+        }
+        m_StateEnergy[ch] = stateEnergy;
+    }
+
 protected:
+    /**
+     * @brief Kernel of playSlice() on planar or interleaved views, see
+     *        CAtomPlanar and CAtomInterleaved
+     */
+    template <class IN, class OUT>
+    void playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                     cint32_t start, cint32_t len);
+
     void calculateDeltas(void) override;
 
+    /**
+     * @brief Validate params and calculate the target coefficients of its
+     *        section into msg
+     *
+     * @param params
+     * @param msg
+     * @return bool_t false if params is out of range
+     */
+    bool_t prepareCoeffs(const tAtomBiquadParams &params, tAtomParamMsg &msg);
+
+    void applyParam(const tAtomParamMsg &msg) override;
+
+    void commitParams(void) override;
+
+    void endMorph(void) override;
+
+    void layoutMem(CAtomMemLayout &mem) override;
+
+    /**
+     * @brief Rebuild the per channel list of sections that need processing.
+     *        Sections whose current and target coefficients are both identity
+     *        (e.g. BIQT_BYPASS) are skipped in play. Sections that become active
+     *        start with cleared states.
+     */
+    void updateActiveSections(void);
+
+    /**
+     * @brief Silence detection of a channel outside of morphs: if both the
+     *        input and the states are silent, output zeros (clearing the
+     *        states once) so that the sections can be skipped
+     *
+     * @param ch
+     * @param pIn
+     * @param pOut
+     * @param len Number of samples
+     * @param stepIn Distance between input samples, e.g. the number of
+     *        channels of interleaved frames
+     * @param stepOut Distance between output samples
+     * @return bool_t true if the channel was skipped
+     */
+    bool_t skipSilence(cint32_t ch, const float32_t *pIn, float32_t *pOut, cint32_t len,
+                       cint32_t stepIn = 1, cint32_t stepOut = 1);
+
+    /**
+     * @brief Zero the states that fell below DENORMAL_FLUSH_THRES
+     *
+     * @param states
+     */
+    inline void flushState(tAtomBiquadStates &states)
+    {
+        if (fabsf(states.s1) < DENORMAL_FLUSH_THRES)
+            states.s1 = 0.0F;
+        if (fabsf(states.s2) < DENORMAL_FLUSH_THRES)
+            states.s2 = 0.0F;
+    }
+
     tAtomBiquadCoeffs **m_TargetCoeffs = nullptr;
     tAtomBiquadCoeffs **m_DeltaCoeffs = nullptr;
     tAtomBiquadCoeffs **m_Coeffs = nullptr;
-    tAtomBiquadStates **m_TargetStates = nullptr;
-    tAtomBiquadStates **m_DeltaStates = nullptr;
     tAtomBiquadStates **m_States = nullptr;
+
+    int32_t **m_ActiveEl = nullptr;
+    int32_t *m_NumActiveEl = nullptr;
+    float32_t *m_StateEnergy = nullptr;
 };
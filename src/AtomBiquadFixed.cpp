@@ -0,0 +1,77 @@
+#include <algorithm>
+#include "AtomBiquadFixed.h"
+
+namespace
+{
+    template <int32_t NCH, int32_t NEL>
+    CAtomBiquad *createBs(cint32_t bs)
+    {
+        switch (bs)
+        {
+        case 32:
+            return new CAtomBiquadFixed<NCH, NEL, 32>();
+        case 64:
+            return new CAtomBiquadFixed<NCH, NEL, 64>();
+        case 128:
+            return new CAtomBiquadFixed<NCH, NEL, 128>();
+        case 256:
+            return new CAtomBiquadFixed<NCH, NEL, 256>();
+        default:
+            return nullptr;
+        }
+    }
+
+    template <int32_t NCH>
+    CAtomBiquad *createEl(cint32_t numEl, cint32_t bs)
+    {
+        switch (numEl)
+        {
+        case 1:
+            return createBs<NCH, 1>(bs);
+        case 2:
+            return createBs<NCH, 2>(bs);
+        case 4:
+            return createBs<NCH, 4>(bs);
+        case 8:
+            return createBs<NCH, 8>(bs);
+        default:
+            return nullptr;
+        }
+    }
+
+    CAtomBiquad *createFixed(const CQuarkProps &props)
+    {
+        if (props.m_NumChIn != props.m_NumChOut)
+            return nullptr;
+
+        switch (props.m_NumChOut)
+        {
+        case 1:
+            return createEl<1>(props.m_NumEl, props.m_BlockSize);
+        case 2:
+            return createEl<2>(props.m_NumEl, props.m_BlockSize);
+        default:
+            return nullptr;
+        }
+    }
+}
+
+std::unique_ptr<CAtomBiquad> CAtomBiquadFactory::create(const CQuarkProps &props)
+{
+    std::unique_ptr<CAtomBiquad> atom(createFixed(props));
+    if (!atom)
+        atom.reset(new CAtomBiquad());
+
+    if (0 != atom->init(props))
+        atom.reset();
+    return atom;
+}
+
+bool_t CAtomBiquadFactory::isSpecialized(const CQuarkProps &props)
+{
+    auto isIn = [](cint32_t val, std::initializer_list<int32_t> set)
+    { return std::find(set.begin(), set.end(), val) != set.end(); };
+
+    return props.m_NumChIn == props.m_NumChOut && isIn(props.m_NumChOut, {1, 2}) &&
+           isIn(props.m_NumEl, {1, 2, 4, 8}) && isIn(props.m_BlockSize, {32, 64, 128, 256});
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <memory>
+#include "AtomBiquad.h"
+
+/**
+ * @brief CAtomBiquad specialized at compile time on the number of channels,
+ *        sections and the block size. Outside of morphs, full blocks run a
+ *        cascade kernel with constant trip counts: the NEL sections are
+ *        unrolled and their states kept in registers, so each sample passes
+ *        through all of them at once, instead of one pass over the block per
+ *        section. Morphs, partial segments (see playSegments()) and everything
+ *        else are handled by CAtomBiquad, with the same results.
+ *
+ *        Bypassed sections are not skipped but run as identity, which is
+ *        exact. init() fails if props do not match the template parameters,
+ *        see CAtomBiquadFactory to pick a specialization at runtime.
+ *
+ * @tparam NCH Number of channels
+ * @tparam NEL Number of sections per channel
+ * @tparam BS Block size
+ */
+template <int32_t NCH, int32_t NEL, int32_t BS>
+class CAtomBiquadFixed : public CAtomBiquad
+{
+    static_assert(NCH > 0 && NEL > 0 && BS > 0, "invalid specialization");
+
+public:
+    using CAtomBiquad::init;
+
+    /**
+     * @brief See base class definition. Fails if props does not match the
+     *        template parameters.
+     */
+    int32_t init(const CQuarkProps &props) override
+    {
+        if (!matches(props))
+            return -1;
+        return CAtomBiquad::init(props);
+    };
+
+    /**
+     * @brief See base class definition
+     */
+    void playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                   cint32_t start, cint32_t len) override
+    {
+        if (len != BS || getNumMorphSamples(len) > 0)
+        {
+            CAtomBiquad::playSlice(in, out, chBegin, chEnd, start, len);
+        }
+        else if (NULL != out && NULL != in)
+        {
+            for (auto ch = chBegin; ch < MIN(chEnd, NCH); ch++)
+            {
+                const float32_t *pIn = in[ch];
+                float32_t *pOut = out[ch];
+                if (skipSilence(ch, pIn, pOut, BS))
+                    continue;
+
+                tAtomBiquadStates *pStates = m_States[ch];
+                processCascade(pIn, pOut, m_Coeffs[ch], pStates);
+
+                float32_t stateEnergy = 0.0F;
+                for (auto el = 0; el < NEL; el++)
+                {
+                    if (m_StateFlush)
+                        flushState(pStates[el]);
+                    stateEnergy += pStates[el].s1 * pStates[el].s1 + pStates[el].s2 * pStates[el].s2;
+                }
+                m_StateEnergy[ch] = stateEnergy;
+            }
+        }
+    };
+
+    /**
+     * @brief Whether props match the specialization
+     *
+     * @param props
+     * @return bool_t
+     */
+    static bool_t matches(const CQuarkProps &props)
+    {
+        return props.m_NumChOut == NCH && props.m_NumChIn == NCH && props.m_NumEl == NEL &&
+               props.m_BlockSize == BS;
+    };
+
+protected:
+    /**
+     * @brief TDF-II cascade of the NEL sections of one channel over a block.
+     *        pIn and pOut may alias.
+     *
+     * @param pIn
+     * @param pOut
+     * @param c Coefficients of the NEL sections
+     * @param st States of the NEL sections
+     */
+    static inline void processCascade(const float32_t *pIn, float32_t *pOut,
+                                      const tAtomBiquadCoeffs *c, tAtomBiquadStates *st)
+    {
+        float32_t s1[NEL];
+        float32_t s2[NEL];
+        for (auto el = 0; el < NEL; el++)
+        {
+            s1[el] = st[el].s1;
+            s2[el] = st[el].s2;
+        }
+        for (auto i = 0; i < BS; i++)
+        {
+            float32_t x = pIn[i];
+            for (auto el = 0; el < NEL; el++)
+            {
+                float32_t y = s1[el] + c[el].b0 * x;
+                s1[el] = s2[el] + x * c[el].b1 - c[el].a1 * y;
+                s2[el] = x * c[el].b2 - c[el].a2 * y;
+                x = y;
+            }
+            pOut[i] = x;
+        }
+        for (auto el = 0; el < NEL; el++)
+        {
+            st[el].s1 = s1[el];
+            st[el].s2 = s2[el];
+        }
+    };
+};
+
+/**
+ * @brief Creates the biquad atom matching props: a precompiled CAtomBiquadFixed
+ *        if one exists, a CAtomBiquad otherwise. The precompiled set covers 1
+ *        and 2 channels, 1, 2, 4 and 8 sections, and block sizes of 32, 64,
+ *        128 and 256.
+ */
+class CAtomBiquadFactory
+{
+public:
+    /**
+     * @brief Create and initialize a biquad atom for props
+     *
+     * @param props
+     * @return std::unique_ptr<CAtomBiquad> nullptr if init failed
+     */
+    static std::unique_ptr<CAtomBiquad> create(const CQuarkProps &props);
+
+    /**
+     * @brief Whether create() picks a specialization for props
+     *
+     * @param props
+     * @return bool_t
+     */
+    static bool_t isSpecialized(const CQuarkProps &props);
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <tuple>
+#include <array>
+#include <utility>
+#include "AudioAtom.h"
+
+/**
+ * @brief Serial chain of atoms known at compile time, e.g.
+ *        CAtomChain<CAtomGain, CAtomDiode, CAtomBiquad>. The atoms are members
+ *        of the chain, called without virtual dispatch, and all have the
+ *        channel count of the chain on both sides.
+ *
+ *        When no atom is morphing and no event is pending within the block,
+ *        the atoms are fused: each sample goes through all of them in one loop
+ *        over the block (see the tick() kernels of the atoms), so the signal
+ *        stays in registers instead of making one round-trip through the
+ *        output buffer per atom. Otherwise the atoms play one after the other,
+ *        the first one from in to out and the next ones in-place on out, so
+ *        all atoms but the first need to be in-place (see isInPlace()).
+ *
+ *        Parameters are set or posted on the atoms directly, see getAtom().
+ *        Each atom needs to provide beginTick(), tick() and endTick().
+ *
+ * @tparam Atoms
+ */
+template <class... Atoms>
+class CAtomChain : public CAudioQuark<float32_t>
+{
+    static_assert(sizeof...(Atoms) > 0, "empty chain");
+
+public:
+    static constexpr size_t NUM_ATOMS = sizeof...(Atoms);
+
+    using CAudioQuark<float32_t>::init;
+    using CAudioQuark<float32_t>::play;
+    using CAudioQuark<float32_t>::playInterleaved;
+
+    /**
+     * @brief See base class definition. All atoms are initialized with props,
+     *        m_NumChIn and m_NumChOut must match.
+     */
+    int32_t init(const CQuarkProps &props) override
+    {
+        std::array<int32_t, NUM_ATOMS> numEl;
+        numEl.fill(props.m_NumEl);
+        return init(props, numEl);
+    };
+
+    /**
+     * @brief Same as init(const CQuarkProps &), with the number of elements of
+     *        each atom, e.g. the number of sections of a CAtomBiquad
+     *
+     * @param props
+     * @param numEl
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t init(const CQuarkProps &props, const std::array<int32_t, NUM_ATOMS> &numEl)
+    {
+        if (props.m_NumChIn != props.m_NumChOut)
+            return -1;
+
+        setProps(props);
+        m_ParamQueueSize = 0; // parameters go to the atoms directly
+        return initAtoms(props, numEl, std::index_sequence_for<Atoms...>{});
+    };
+
+    /**
+     * @brief See base class definition
+     */
+    void play(float32_t **const in, float32_t **const out) override
+    {
+        if (NULL != out && NULL != in)
+        {
+            if (drainAtoms(std::index_sequence_for<Atoms...>{}))
+                playFused(CAtomPlanar<float32_t>(in), CAtomPlanar<float32_t>(out),
+                          std::index_sequence_for<Atoms...>{});
+            else
+                playSerial(in, out, std::index_sequence_for<Atoms...>{});
+        }
+    };
+
+    /**
+     * @brief See base class definition. The fused kernel runs on the frames
+     *        directly, the serial one through the interleaved play of each atom.
+     */
+    void playInterleaved(const float32_t *in, float32_t *out) override
+    {
+        if (NULL != out && NULL != in)
+        {
+            if (drainAtoms(std::index_sequence_for<Atoms...>{}))
+                playFused(CAtomInterleaved<const float32_t>(in, m_Props.m_NumChIn),
+                          CAtomInterleaved<float32_t>(out, m_Props.m_NumChOut),
+                          std::index_sequence_for<Atoms...>{});
+            else
+                playSerialInterleaved(in, out, std::index_sequence_for<Atoms...>{});
+        }
+    };
+
+    /**
+     * @brief See base class definition. The fused kernel is in-place, the
+     *        serial one only if all atoms are.
+     */
+    bool_t isInPlace(void) const override
+    {
+        return std::apply([](const auto &...atom)
+                          { return (atom.isInPlace() && ...); },
+                          m_Atoms);
+    };
+
+    /**
+     * @brief Get atom I of the chain
+     *
+     * @tparam I
+     * @return Atom&
+     */
+    template <size_t I>
+    typename std::tuple_element<I, std::tuple<Atoms...>>::type &getAtom(void)
+    {
+        return std::get<I>(m_Atoms);
+    };
+
+    /**
+     * @brief Whether the last block was fused
+     *
+     * @return bool_t
+     */
+    bool_t isFused(void) const { return m_Fused; };
+
+protected:
+    template <size_t... I>
+    int32_t initAtoms(const CQuarkProps &props, const std::array<int32_t, NUM_ATOMS> &numEl,
+                      std::index_sequence<I...>)
+    {
+        int32_t retval = 0;
+        auto initAtom = [&](auto &atom, cint32_t el)
+        {
+            CQuarkProps atomProps = props;
+            atomProps.m_NumEl = el;
+            if (0 == retval && 0 != atom.init(atomProps))
+                retval = -1;
+        };
+        (initAtom(std::get<I>(m_Atoms), numEl[I]), ...);
+        return retval;
+    };
+
+    /**
+     * @brief Drain the parameters of all atoms, for the frames of this block
+     *
+     * @return bool_t true if the block can be fused
+     */
+    template <size_t... I>
+    bool_t drainAtoms(std::index_sequence<I...>)
+    {
+        m_Fused = true;
+        auto drainAtom = [&](auto &atom)
+        {
+            atom.setNumFrames(m_NumFrames);
+            atom.drainParams();
+            m_Fused = m_Fused && !atom.isMorphing() && atom.getSegmentEnd() >= m_NumFrames;
+        };
+        (drainAtom(std::get<I>(m_Atoms)), ...);
+        return m_Fused;
+    };
+
+    template <class IN, class OUT, size_t... I>
+    void playFused(const IN &in, const OUT &out, std::index_sequence<I...>)
+    {
+        cint32_t bs = m_NumFrames;
+        cint32_t stepIn = in.step();
+        cint32_t stepOut = out.step();
+        for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+        {
+            const float32_t *pIn = in.ptr(ch, 0);
+            float32_t *pOut = out.ptr(ch, 0);
+            auto ticks = std::make_tuple(std::get<I>(m_Atoms).beginTick(ch)...);
+            for (auto i = 0; i < bs; i++)
+            {
+                float32_t x = pIn[i * stepIn];
+                ((x = std::get<I>(m_Atoms).tick(std::get<I>(ticks), x)), ...);
+                pOut[i * stepOut] = x;
+            }
+            (std::get<I>(m_Atoms).endTick(ch, std::get<I>(ticks)), ...);
+        }
+    };
+
+    template <size_t... I>
+    void playSerial(float32_t **const in, float32_t **const out, std::index_sequence<I...>)
+    {
+        ((std::get<I>(m_Atoms).playDrained((I == 0) ? in : out, out)), ...);
+    };
+
+    template <size_t... I>
+    void playSerialInterleaved(const float32_t *in, float32_t *out, std::index_sequence<I...>)
+    {
+        ((std::get<I>(m_Atoms).playDrainedInterleaved((I == 0) ? in : out, out)), ...);
+    };
+
+    std::tuple<Atoms...> m_Atoms;
+    bool_t m_Fused = false;
+};
@@ -0,0 +1,244 @@
+#include "AtomCrossover.h"
+
+int32_t CAtomCrossover::init(const CQuarkProps &props)
+{
+    if (props.m_NumEl < 1 || props.m_NumChOut != props.m_NumChIn * props.m_NumEl)
+        return -1;
+
+    if (0 != initMem(props))
+        return -1;
+
+    // default: LR4, logarithmically spread between 100Hz and 10kHz
+    for (auto xo = 0; xo < m_NumXovers; xo++)
+    {
+        m_Xovers[xo].type = XOVER_LR4;
+        m_Xovers[xo].freq = 100.F * powf(100.F, (xo + 1) / (float32_t)props.m_NumEl);
+        calculateCoeffs(xo);
+    }
+
+    return 0;
+}
+
+size_t CAtomCrossover::getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo,
+                                         const size_t paramQueueSize)
+{
+    CAtomCrossover atom;
+    return atom.measureMem(props, interleavedIo, paramQueueSize);
+}
+
+void CAtomCrossover::layoutMem(CAtomMemLayout &mem)
+{
+    m_NumXovers = MAX(m_Props.m_NumEl - 1, 0);
+    m_NumStatesCh = 2 * m_NumXovers * MAX_SECTIONS + m_Props.m_NumEl * m_NumXovers * MAX_AP_SECTIONS;
+    m_Xovers = mem.take<tCrossoverCoeffs>(m_NumXovers);
+    m_States = mem.take<CAtomBiquad::tAtomBiquadStates>(m_Props.m_NumChIn * m_NumStatesCh);
+}
+
+void CAtomCrossover::play(float32_t **const in, float32_t **const out)
+{
+    if (NULL != out && NULL != in)
+        playSegments(in, out);
+}
+
+void CAtomCrossover::playFrames(float32_t **const in, float32_t **const out, cint32_t start, cint32_t len)
+{
+    if (NULL != out && NULL != in)
+    {
+        cint32_t numCh = m_Props.m_NumChIn;
+        cint32_t lastBand = m_Props.m_NumEl - 1;
+
+        for (auto ch = 0; ch < numCh; ch++)
+        {
+            const float32_t *pRem = &in[ch][start];
+
+            if (m_NumXovers == 0)
+            {
+                float32_t *pOut = &out[ch][start];
+                if (pRem != pOut)
+                {
+                    for (auto i = 0; i < len; i++)
+                        pOut[i] = pRem[i];
+                }
+                continue;
+            }
+
+            // split the remainder at each crossover: lowpass into its band,
+            // highpass into the last band's buffer, which feeds the next split
+            for (auto xo = 0; xo < m_NumXovers; xo++)
+            {
+                const tCrossoverCoeffs *pXo = &m_Xovers[xo];
+                float32_t *pLow = &out[xo * numCh + ch][start];
+                float32_t *pHigh = &out[lastBand * numCh + ch][start];
+                CAtomBiquad::tAtomBiquadStates *pStLp = getStatesLp(ch, xo);
+                CAtomBiquad::tAtomBiquadStates *pStHp = getStatesHp(ch, xo);
+
+                CAtomBiquad::processSectionSplit(pRem, pLow, pHigh, pXo->lp[0], pXo->hp[0],
+                                                 pStLp[0], pStHp[0], len);
+                for (auto s = 1; s < pXo->numSections; s++)
+                {
+                    CAtomBiquad::processSection(pLow, pLow, pXo->lp[s], pStLp[s], len);
+                    CAtomBiquad::processSection(pHigh, pHigh, pXo->hp[s], pStHp[s], len);
+                }
+                pRem = pHigh;
+            }
+
+            // phase compensation: band b gets the allpass of all crossovers above it
+            for (auto band = 0; band < lastBand - 1; band++)
+            {
+                float32_t *pBand = &out[band * numCh + ch][start];
+                for (auto xo = band + 1; xo < m_NumXovers; xo++)
+                {
+                    const tCrossoverCoeffs *pXo = &m_Xovers[xo];
+                    CAtomBiquad::tAtomBiquadStates *pStAp = getStatesAp(ch, band, xo);
+                    for (auto s = 0; s < pXo->numApSections; s++)
+                        CAtomBiquad::processSection(pBand, pBand, pXo->ap[s], pStAp[s], len);
+                }
+            }
+        }
+    }
+}
+
+void CAtomCrossover::set(void *params, cint32_t len)
+{
+    if (NULL != params && len > 0)
+    {
+        tAtomCrossoverParams *pXoParams = reinterpret_cast<tAtomCrossoverParams *>(params);
+        int32_t num = len / sizeof(tAtomCrossoverParams);
+
+        for (auto i = 0; i < num; i++)
+        {
+            tAtomParamMsg msg;
+            if (pXoParams->type < NUM_XOVER && prepareParam(0, pXoParams->el, pXoParams->freq, msg))
+            {
+                msg.val[1] = (float32_t)pXoParams->type;
+                applyParam(msg);
+            }
+            pXoParams++;
+        }
+    }
+}
+
+void CAtomCrossover::set(cint32_t ch, cint32_t el, cfloat32_t value)
+{
+    tAtomParamMsg msg;
+    if (prepareParam(ch, el, value, msg))
+        applyParam(msg);
+}
+
+int32_t CAtomCrossover::post(void *params, cint32_t len, cint32_t offset)
+{
+    int32_t retval = -1;
+    if (NULL != params && len > 0)
+    {
+        tAtomCrossoverParams *pXoParams = reinterpret_cast<tAtomCrossoverParams *>(params);
+        int32_t num = len / sizeof(tAtomCrossoverParams);
+
+        retval = 0;
+        for (auto i = 0; i < num && 0 == retval; i++)
+        {
+            tAtomParamMsg msg;
+            if (pXoParams->type < NUM_XOVER && prepareParam(0, pXoParams->el, pXoParams->freq, msg))
+            {
+                msg.val[1] = (float32_t)pXoParams->type;
+                msg.offset = offset;
+                retval = pushParam(msg);
+            }
+            else
+            {
+                retval = -1;
+            }
+            pXoParams++;
+        }
+    }
+    return retval;
+}
+
+bool_t CAtomCrossover::prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg)
+{
+    if (el < 0 || el >= m_NumXovers)
+        return false;
+
+    msg.ch = ch;
+    msg.el = el;
+    msg.val[0] = value;
+    msg.val[1] = -1.F; // keep the type
+    return true;
+}
+
+void CAtomCrossover::applyParam(const tAtomParamMsg &msg)
+{
+    if (msg.val[1] >= 0.F)
+        m_Xovers[msg.el].type = (int32_t)msg.val[1];
+    m_Xovers[msg.el].freq = msg.val[0];
+    calculateCoeffs(msg.el);
+}
+
+void CAtomCrossover::calculateCoeffs(cint32_t el)
+{
+    tCrossoverCoeffs *pXo = &m_Xovers[el];
+    CAtomBiquad::tAtomBiquadParams params = {0, 0, CAtomBiquad::BIQT_BYPASS, pXo->freq, 0.707F, 0.F};
+
+    switch (pXo->type)
+    {
+    case XOVER_LR2:
+    {
+        // LR2 = (1st order Butterworth)^2. Highpass inverted, so that
+        // LP - HP = (1 - s) / (1 + s) is the allpass sum
+        pXo->numSections = 2;
+        pXo->numApSections = 1;
+        params.type = CAtomBiquad::BIQT_LPF_6DB;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->lp[0]);
+        params.type = CAtomBiquad::BIQT_HPF_6DB;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->hp[0]);
+        pXo->lp[1] = pXo->lp[0];
+        pXo->hp[1] = pXo->hp[0];
+        pXo->hp[1].b0 = -pXo->hp[1].b0;
+        pXo->hp[1].b1 = -pXo->hp[1].b1;
+        pXo->hp[1].b2 = -pXo->hp[1].b2;
+        params.type = CAtomBiquad::BIQT_APF_180;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->ap[0]);
+        pXo->ap[0].b0 = -pXo->ap[0].b0;
+        pXo->ap[0].b1 = -pXo->ap[0].b1;
+    }
+    break;
+
+    case XOVER_LR8:
+    {
+        // LR8 = (4th order Butterworth)^2, each made of 2 sections
+        cfloat32_t q[MAX_AP_SECTIONS] = {0.54119610F, 1.3065630F};
+        pXo->numSections = 4;
+        pXo->numApSections = 2;
+        for (auto s = 0; s < MAX_AP_SECTIONS; s++)
+        {
+            params.q = q[s];
+            params.type = CAtomBiquad::BIQT_LPF;
+            CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->lp[s]);
+            params.type = CAtomBiquad::BIQT_HPF;
+            CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->hp[s]);
+            params.type = CAtomBiquad::BIQT_APF;
+            CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->ap[s]);
+            pXo->lp[s + 2] = pXo->lp[s];
+            pXo->hp[s + 2] = pXo->hp[s];
+        }
+    }
+    break;
+
+    case XOVER_LR4:
+    default:
+    {
+        // LR4 = (2nd order Butterworth)^2
+        pXo->numSections = 2;
+        pXo->numApSections = 1;
+        params.q = 0.70710678F;
+        params.type = CAtomBiquad::BIQT_LPF;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->lp[0]);
+        params.type = CAtomBiquad::BIQT_HPF;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->hp[0]);
+        params.type = CAtomBiquad::BIQT_APF;
+        CAtomBiquad::calculateCoeffs(params, m_Props.m_Fs, pXo->ap[0]);
+        pXo->lp[1] = pXo->lp[0];
+        pXo->hp[1] = pXo->hp[0];
+    }
+    break;
+    }
+}
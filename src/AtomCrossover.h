@@ -0,0 +1,134 @@
+#pragma once
+
+#include "AudioAtom.h"
+#include "AtomBiquad.h"
+
+/**
+ * @brief Linkwitz-Riley multiband splitter. Each of the m_NumChIn input
+ *        channels is split into m_NumEl bands, band b of channel ch being
+ *        written to out[b * m_NumChIn + ch], so m_NumChOut must be
+ *        m_NumChIn * m_NumEl. The m_NumEl - 1 crossover points are shared by
+ *        all channels and should be given in ascending frequency order.
+ *
+ *        The split is done as a tree: the highpass output of crossover j feeds
+ *        crossover j + 1, and every band below crossover j gets the allpass
+ *        equivalent of crossover j, so that the bands sum up to an allpass.
+ */
+class CAtomCrossover : public CAudioQuark<float32_t>
+{
+public:
+    enum eCrossoverType
+    {
+        XOVER_LR2 = 0,
+        XOVER_LR4,
+        XOVER_LR8,
+        NUM_XOVER,
+    };
+
+    typedef struct
+    {
+        int32_t el; // crossover index, from 0 to m_NumEl - 2
+        int32_t type;
+        float32_t freq;
+    } tAtomCrossoverParams;
+
+    using CAudioQuark<float32_t>::init;
+    using CAudioQuark<float32_t>::play;
+    using CAudioQuark<float32_t>::playInterleaved;
+
+    /**
+     * @brief See base class definition
+     */
+    int32_t init(const CQuarkProps &props) override;
+
+    /**
+     * @brief See base class definition
+     */
+    static size_t getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo = false,
+                                    const size_t paramQueueSize = ATOM_PARAM_QUEUE_SIZE);
+
+    /**
+     * @brief See base class definition
+     */
+    void play(float32_t **const in, float32_t **const out) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playFrames(float32_t **const in, float32_t **const out, cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition. Input channel ch may alias output
+     *        ch, the lowest band.
+     */
+    bool_t isInPlace(void) const override { return true; };
+
+    /**
+     * @brief See base class definition. Expects an array of tAtomCrossoverParams
+     */
+    void set(void *params, cint32_t len) override;
+
+    /**
+     * @brief Set the frequency of crossover el, keeping its type. ch is
+     *        ignored, as crossovers are shared by all channels.
+     */
+    void set(cint32_t ch, cint32_t el, cfloat32_t value) override;
+
+    /**
+     * @brief See base class definition. Expects an array of tAtomCrossoverParams.
+     *        The sections of a crossover do not fit a message, so unlike the
+     *        other atoms, they are calculated when the message is applied.
+     */
+    int32_t post(void *params, cint32_t len, cint32_t offset = 0) override;
+
+protected:
+    static const int32_t MAX_SECTIONS = 4;    // LR8: 2x 4th order Butterworth
+    static const int32_t MAX_AP_SECTIONS = 2; // LR8: 4th order allpass
+
+    typedef struct
+    {
+        int32_t type;
+        float32_t freq;
+        int32_t numSections;
+        int32_t numApSections;
+        CAtomBiquad::tAtomBiquadCoeffs lp[MAX_SECTIONS];
+        CAtomBiquad::tAtomBiquadCoeffs hp[MAX_SECTIONS];
+        CAtomBiquad::tAtomBiquadCoeffs ap[MAX_AP_SECTIONS];
+    } tCrossoverCoeffs;
+
+    /**
+     * @brief Calculate the sections of crossover el from its type and frequency
+     *
+     * @param el
+     */
+    void calculateCoeffs(cint32_t el);
+
+    void layoutMem(CAtomMemLayout &mem) override;
+
+    bool_t prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg) override;
+
+    void applyParam(const tAtomParamMsg &msg) override;
+
+    // states per channel: lowpass and highpass sections of each crossover,
+    // followed by the allpass compensation sections of each band
+    inline CAtomBiquad::tAtomBiquadStates *getStatesLp(cint32_t ch, cint32_t xo)
+    {
+        return &m_States[ch * m_NumStatesCh + xo * MAX_SECTIONS];
+    }
+
+    inline CAtomBiquad::tAtomBiquadStates *getStatesHp(cint32_t ch, cint32_t xo)
+    {
+        return &m_States[ch * m_NumStatesCh + (m_NumXovers + xo) * MAX_SECTIONS];
+    }
+
+    inline CAtomBiquad::tAtomBiquadStates *getStatesAp(cint32_t ch, cint32_t band, cint32_t xo)
+    {
+        return &m_States[ch * m_NumStatesCh + 2 * m_NumXovers * MAX_SECTIONS +
+                         (band * m_NumXovers + xo) * MAX_AP_SECTIONS];
+    }
+
+    tCrossoverCoeffs *m_Xovers = nullptr;
+    CAtomBiquad::tAtomBiquadStates *m_States = nullptr;
+    int32_t m_NumXovers = 0;
+    int32_t m_NumStatesCh = 0;
+};
@@ -15,19 +15,14 @@ const CAtomDiode::tAtomDiodeSpiceParams CAtomDiode::m_DiodeParams[NUM_DIODE_T] =
 
 int32_t CAtomDiode::init(const CQuarkProps &props)
 {
-    setProps(props);
-
     const tAtomDiodeSpiceParams *pParams = &m_DiodeParams[m_Mode];
     float32_t a1 = 1.F / (pParams->N * m_Vt);
     float32_t a0 = pParams->IS * (0.F + pParams->RS); // 0 explicit here to indicate R=0 at init
     float32_t logA0A1 = LOG(a0 * a1);
 
-    m_TargetA0 = new float32_t[props.m_NumChOut];
-    m_DeltaA0 = new float32_t[props.m_NumChOut]();
-    m_A0 = new float32_t[props.m_NumChOut];
-    m_TargetLogA0A1 = new float32_t[props.m_NumChOut];
-    m_DeltaLogA0A1 = new float32_t[props.m_NumChOut]();
-    m_LogA0A1 = new float32_t[props.m_NumChOut];
+    if (0 != initMem(props))
+        return -1;
+
     for (auto i = 0; i < props.m_NumChOut; i++)
     {
         m_A0[i] = a0;
@@ -36,9 +31,6 @@ int32_t CAtomDiode::init(const CQuarkProps &props)
         m_TargetLogA0A1[i] = logA0A1;
     }
 
-    m_MakeUpDeltaGains = new float32_t[props.m_NumChOut]();
-    m_MakeUpTargetGains = new float32_t[props.m_NumChOut];
-    m_MakeUpGains = new float32_t[props.m_NumChOut];
     for (auto i = 0; i < props.m_NumChOut; i++)
     {
         m_MakeUpGains[i] = 1.0F;
@@ -48,77 +40,119 @@ int32_t CAtomDiode::init(const CQuarkProps &props)
     return 0;
 }
 
+size_t CAtomDiode::getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo,
+                                     const size_t paramQueueSize)
+{
+    CAtomDiode atom;
+    return atom.measureMem(props, interleavedIo, paramQueueSize);
+}
+
+void CAtomDiode::layoutMem(CAtomMemLayout &mem)
+{
+    m_TargetA0 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_DeltaA0 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_A0 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_TargetLogA0A1 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_DeltaLogA0A1 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_LogA0A1 = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_MakeUpGains = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_MakeUpDeltaGains = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_MakeUpTargetGains = mem.take<float32_t>(m_Props.m_NumChOut);
+}
+
 void CAtomDiode::play(float32_t **const in, float32_t **const out)
 {
-    const tAtomDiodeSpiceParams *pParams = &m_DiodeParams[m_Mode];
+    if (NULL != out && NULL != in)
+        playSegments(in, out);
+}
 
-    float32_t a1 = 1.F / (pParams->N * m_Vt);
+void CAtomDiode::playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                           cint32_t start, cint32_t len)
+{
+    if (NULL != out && NULL != in)
+        playSliceIo(CAtomPlanar<float32_t>(in), CAtomPlanar<float32_t>(out), chBegin, chEnd, start, len);
+}
 
+void CAtomDiode::playInterleaved(const float32_t *in, float32_t *out)
+{
     if (NULL != out && NULL != in)
+        playSegmentsInterleaved(in, out);
+}
+
+void CAtomDiode::playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len)
+{
+    playSliceIo(CAtomInterleaved<const float32_t>(in, m_Props.m_NumChIn),
+                CAtomInterleaved<float32_t>(out, m_Props.m_NumChOut), 0, m_Props.m_NumChOut, start, len);
+}
+
+template <class IN, class OUT>
+void CAtomDiode::playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                             cint32_t start, cint32_t len)
+{
+    cfloat32_t a1 = getA1();
+    cint32_t numMorph = getNumMorphSamples(len);
+    cint32_t stepIn = in.step();
+    cint32_t stepOut = out.step();
+    for (auto ch = chBegin; ch < chEnd; ch++)
     {
-        if (m_MorphBlocksizeCnt > 0)
+        auto *pIn = in.ptr(ch, start);
+        float32_t *pOut = out.ptr(ch, start);
+
+        if (numMorph > 0)
         {
             // morphing
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
-            {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                float32_t *pA0 = &m_A0[ch];
-                float32_t *pDeltaA0 = &m_DeltaA0[ch];
-                float32_t *pLogA0A1 = &m_LogA0A1[ch];
-                float32_t *pDeltaLogA0A1 = &m_DeltaLogA0A1[ch];
-                float32_t *pMupGain = &m_MakeUpGains[ch];
-                float32_t *pMupDeltaGain = &m_MakeUpDeltaGains[ch];
-
-                for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                {
-                    *pA0 += *pDeltaA0;
-                    *pLogA0A1 += *pDeltaLogA0A1;
-                    *pMupGain += *pMupDeltaGain;
-                    float32_t absIn = fabs(pIn[i]);
-                    float32_t w = NAtomHelper::WrightOmegaReal<float32_t>(a1 * (absIn + *pA0) + *pLogA0A1);
-                    pOut[i] = absIn + *pA0 - w / a1;
-                    if (pIn[i] < 0.F)
-                        pOut[i] *= -*pMupGain;
-                    else
-                        pOut[i] *= *pMupGain;
-                }
-            }
-            if (--m_MorphBlocksizeCnt <= 0)
+            float32_t *pA0 = &m_A0[ch];
+            float32_t *pDeltaA0 = &m_DeltaA0[ch];
+            float32_t *pLogA0A1 = &m_LogA0A1[ch];
+            float32_t *pDeltaLogA0A1 = &m_DeltaLogA0A1[ch];
+            float32_t *pMupGain = &m_MakeUpGains[ch];
+            float32_t *pMupDeltaGain = &m_MakeUpDeltaGains[ch];
+
+            for (auto i = 0; i < numMorph; i++)
             {
-                for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
-                {
-                    m_A0[ch] = m_TargetA0[ch];
-                    m_LogA0A1[ch] = m_TargetLogA0A1[ch];
-                }
+                *pA0 += *pDeltaA0;
+                *pLogA0A1 += *pDeltaLogA0A1;
+                *pMupGain += *pMupDeltaGain;
+                pOut[i * stepOut] = tick({*pA0, *pLogA0A1, *pMupGain, a1}, pIn[i * stepIn]);
             }
-        }
-        else
-        {
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+            if (numMorph < len)
             {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                float32_t *pMupGain = &m_MakeUpGains[ch];
-                float32_t a0 = m_A0[ch];
-                float32_t logA0A1 = m_LogA0A1[ch];
-                for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                {
-                    float32_t absIn = fabs(pIn[i]);
-                    float32_t w = NAtomHelper::WrightOmegaReal<float32_t>(a1 * (absIn + a0) + logA0A1);
-                    pOut[i] = absIn + a0 - w / a1;
-                    if (pIn[i] < 0.F)
-                        pOut[i] *= -*pMupGain;
-                    else
-                        pOut[i] *= *pMupGain;
-                }
+                // morph ends within the segment
+                m_A0[ch] = m_TargetA0[ch];
+                m_LogA0A1[ch] = m_TargetLogA0A1[ch];
             }
         }
+
+        const tAtomDiodeTick t = beginTick(ch);
+        for (auto i = numMorph; i < len; i++)
+            pOut[i * stepOut] = tick(t, pIn[i * stepIn]);
+    }
+}
+
+void CAtomDiode::endMorph(void)
+{
+    for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+    {
+        m_A0[ch] = m_TargetA0[ch];
+        m_LogA0A1[ch] = m_TargetLogA0A1[ch];
     }
 }
 
 void CAtomDiode::set(cint32_t ch, cint32_t el, cfloat32_t value)
 {
+    tAtomParamMsg msg;
+    if (prepareParam(ch, el, value, msg))
+    {
+        applyParam(msg);
+        commitParams();
+    }
+}
+
+bool_t CAtomDiode::prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg)
+{
+    if (ch != SET_ALL_CH_IND && (ch < 0 || ch >= m_Props.m_NumChOut))
+        return false;
+
     float32_t targetGain = CLIP(value, 0.F, 10000000.F);
     float32_t mupTargetGain = 1.0F;
     const tAtomDiodeSpiceParams *pParams = &m_DiodeParams[m_Mode];
@@ -134,31 +168,37 @@ void CAtomDiode::set(cint32_t ch, cint32_t el, cfloat32_t value)
         mupTargetGain = 1.F / out;
     }
 
-    if (ch == SET_ALL_CH_IND)
-    {
-        for (auto c = 0; c < m_Props.m_NumChOut; c++)
-        {
-            m_TargetA0[c] = a0;
-            m_TargetLogA0A1[c] = logA0A1;
-            m_MakeUpTargetGains[c] = mupTargetGain;
-        }
-    }
-    else
+    msg.ch = ch;
+    msg.el = el;
+    msg.val[0] = a0;
+    msg.val[1] = logA0A1;
+    msg.val[2] = mupTargetGain;
+    return true;
+}
+
+void CAtomDiode::applyParam(const tAtomParamMsg &msg)
+{
+    cint32_t chBegin = (msg.ch == SET_ALL_CH_IND) ? 0 : msg.ch;
+    cint32_t chEnd = (msg.ch == SET_ALL_CH_IND) ? m_Props.m_NumChOut : msg.ch + 1;
+    for (auto c = chBegin; c < chEnd; c++)
     {
-        m_TargetA0[ch] = a0;
-        m_TargetLogA0A1[ch] = logA0A1;
-        m_MakeUpTargetGains[ch] = mupTargetGain;
+        m_TargetA0[c] = msg.val[0];
+        m_TargetLogA0A1[c] = msg.val[1];
+        m_MakeUpTargetGains[c] = msg.val[2];
     }
+}
 
+void CAtomDiode::commitParams(void)
+{
     calculateDeltas();
     startMorph();
 }
 
 void CAtomDiode::calculateDeltas(void)
 {
-    if (m_MorphBlocksizeTotal > 0.F)
+    if (m_MorphSamplesTotal > 0)
     {
-        const auto den = (m_MorphBlocksizeTotal * m_Props.m_BlockSize);
+        const auto den = m_MorphSamplesTotal;
         for (auto c = 0; c < m_Props.m_NumChOut; c++)
         {
             m_DeltaA0[c] = (m_TargetA0[c] - m_A0[c]) / den;
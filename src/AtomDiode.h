@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AudioAtom.h"
+#include "AtomHelper.h"
 
 /**
  * @brief
@@ -26,24 +27,128 @@ public:
         float32_t TT;
     } tAtomDiodeSpiceParams;
 
+    /**
+     * @brief Per channel state of the sample kernel, see tick()
+     */
+    typedef struct
+    {
+        float32_t a0;
+        float32_t logA0A1;
+        float32_t mup; // makeup gain
+        float32_t a1;
+    } tAtomDiodeTick;
+
+    using CAudioQuarkLinearMorph<float32_t>::init;
+    using CAudioQuarkLinearMorph<float32_t>::play;
+    using CAudioQuarkLinearMorph<float32_t>::playInterleaved;
+
     /**
      * @brief See base class definition
      */
     int32_t init(const CQuarkProps &props) override;
 
+    /**
+     * @brief See base class definition
+     */
+    static size_t getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo = false,
+                                    const size_t paramQueueSize = ATOM_PARAM_QUEUE_SIZE);
+
     /**
      * @brief See base class definition
      */
     void play(float32_t **const in, float32_t **const out) override;
 
+    /**
+     * @brief See base class definition
+     */
+    void playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                   cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playInterleaved(const float32_t *in, float32_t *out) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isSliceable(void) const override { return true; };
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isInPlace(void) const override { return true; };
+
     /**
      * @brief See base class definition
      */
     void set(cint32_t ch, cint32_t el, cfloat32_t value) override;
 
+    /**
+     * @brief Load the current (not morphing) state of channel ch for tick()
+     *
+     * @param ch
+     * @return tAtomDiodeTick
+     */
+    inline tAtomDiodeTick beginTick(cint32_t ch) const
+    {
+        return {m_A0[ch], m_LogA0A1[ch], m_MakeUpGains[ch], getA1()};
+    }
+
+    /**
+     * @brief Process one sample, see CAtomChain
+     *
+     * @param t
+     * @param x
+     * @return float32_t
+     */
+    inline float32_t tick(const tAtomDiodeTick &t, cfloat32_t x) const
+    {
+        float32_t absIn = fabs(x);
+        float32_t w = NAtomHelper::WrightOmegaReal<float32_t>(t.a1 * (absIn + t.a0) + t.logA0A1);
+        float32_t y = absIn + t.a0 - w / t.a1;
+        return (x < 0.F) ? y * -t.mup : y * t.mup;
+    }
+
+    /**
+     * @brief Store the state of channel ch after tick(), nothing to store
+     *
+     * @param ch
+     * @param t
+     */
+    inline void endTick(cint32_t ch, const tAtomDiodeTick &t) {}
+
 protected:
+    /**
+     * @brief Kernel of playSlice() on planar or interleaved views, see
+     *        CAtomPlanar and CAtomInterleaved
+     */
+    template <class IN, class OUT>
+    void playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                     cint32_t start, cint32_t len);
+
+    inline float32_t getA1(void) const
+    {
+        return 1.F / (m_DiodeParams[m_Mode].N * m_Vt);
+    }
+
     void calculateDeltas(void) override;
 
+    bool_t prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg) override;
+
+    void applyParam(const tAtomParamMsg &msg) override;
+
+    void commitParams(void) override;
+
+    void endMorph(void) override;
+
+    void layoutMem(CAtomMemLayout &mem) override;
+
     // Diode parameters
     static const tAtomDiodeSpiceParams m_DiodeParams[NUM_DIODE_T];
 
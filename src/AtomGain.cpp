@@ -2,86 +2,148 @@
 
 int32_t CAtomGain::init(const CQuarkProps &props)
 {
-    setProps(props);
+    return initMem(props);
+}
 
-    m_TargetGains = new float32_t[props.m_NumChOut]();
-    m_DeltaGains = new float32_t[props.m_NumChOut]();
-    m_Gains = new float32_t[props.m_NumChOut]();
+size_t CAtomGain::getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo,
+                                    const size_t paramQueueSize)
+{
+    CAtomGain atom;
+    return atom.measureMem(props, interleavedIo, paramQueueSize);
+}
 
-    return 0;
+void CAtomGain::layoutMem(CAtomMemLayout &mem)
+{
+    m_TargetGains = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_DeltaGains = mem.take<float32_t>(m_Props.m_NumChOut);
+    m_Gains = mem.take<float32_t>(m_Props.m_NumChOut);
 }
 
 void CAtomGain::play(float32_t **const in, float32_t **const out)
 {
     if (NULL != out && NULL != in)
+        playSegments(in, out);
+}
+
+void CAtomGain::playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                          cint32_t start, cint32_t len)
+{
+    if (NULL != out && NULL != in)
+        playSliceIo(CAtomPlanar<float32_t>(in), CAtomPlanar<float32_t>(out), chBegin, chEnd, start, len);
+}
+
+void CAtomGain::playInterleaved(const float32_t *in, float32_t *out)
+{
+    if (NULL != out && NULL != in)
+        playSegmentsInterleaved(in, out);
+}
+
+void CAtomGain::playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len)
+{
+    playSliceIo(CAtomInterleaved<const float32_t>(in, m_Props.m_NumChIn),
+                CAtomInterleaved<float32_t>(out, m_Props.m_NumChOut), 0, m_Props.m_NumChOut, start, len);
+}
+
+template <class IN, class OUT>
+void CAtomGain::playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                            cint32_t start, cint32_t len)
+{
+    cint32_t numMorph = getNumMorphSamples(len);
+    cint32_t stepIn = in.step();
+    cint32_t stepOut = out.step();
+    for (auto ch = chBegin; ch < chEnd; ch++)
     {
-        if (m_MorphBlocksizeCnt > 0)
+        auto *pIn = in.ptr(ch, start);
+        float32_t *pOut = out.ptr(ch, start);
+
+        if (numMorph > 0)
         {
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
-            {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                float32_t *pGain = &m_Gains[ch];
-                float32_t *pDeltaGain = &m_DeltaGains[ch];
-
-                for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                {
-                    *pGain += *pDeltaGain;
-                    pOut[i] = pIn[i] * *pGain;
-                }
-            }
-            if (--m_MorphBlocksizeCnt <= 0)
+            float32_t *pGain = &m_Gains[ch];
+            float32_t *pDeltaGain = &m_DeltaGains[ch];
+
+            for (auto i = 0; i < numMorph; i++)
             {
-                for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
-                {
-                    m_Gains[ch] = m_TargetGains[ch];
-                }
+                *pGain += *pDeltaGain;
+                pOut[i * stepOut] = pIn[i * stepIn] * *pGain;
             }
+            if (numMorph < len)
+                m_Gains[ch] = m_TargetGains[ch]; // morph ends within the segment
+        }
+
+        if constexpr (IN::PLANAR && OUT::PLANAR)
+        {
+            if (pIn == pOut)
+                scaleInPlace(&pOut[numMorph], m_Gains[ch], len - numMorph);
+            else
+                scale(&pIn[numMorph], &pOut[numMorph], m_Gains[ch], len - numMorph);
         }
         else
         {
-            for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
-            {
-                float32_t *pIn = in[ch];
-                float32_t *pOut = out[ch];
-                float32_t gain = m_Gains[ch];
-
-                for (auto i = 0; i < m_Props.m_BlockSize; i++)
-                {
-                    pOut[i] = pIn[i] * gain;
-                }
-            }
+            float32_t gain = m_Gains[ch];
+            for (auto i = numMorph; i < len; i++)
+                pOut[i * stepOut] = pIn[i * stepIn] * gain;
         }
     }
 }
 
+void CAtomGain::endMorph(void)
+{
+    for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+    {
+        m_Gains[ch] = m_TargetGains[ch];
+    }
+}
+
 void CAtomGain::set(cint32_t ch, cint32_t el, cfloat32_t value)
 {
+    tAtomParamMsg msg;
+    if (prepareParam(ch, el, value, msg))
+    {
+        applyParam(msg);
+        commitParams();
+    }
+}
+
+bool_t CAtomGain::prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg)
+{
+    if (ch != SET_ALL_CH_IND && (ch < 0 || ch >= m_Props.m_NumChOut))
+        return false;
+
     float32_t gainDb = CLIP(value, MUTE_DB_FS, 50.0F);
-    float32_t targetGainLin = gainDb <= MUTE_DB_FS ? 0.0F : powf(10.F, gainDb * 0.05F);
+    msg.ch = ch;
+    msg.el = el;
+    msg.val[0] = gainDb <= MUTE_DB_FS ? 0.0F : powf(10.F, gainDb * 0.05F);
+    return true;
+}
 
-    if (ch == SET_ALL_CH_IND)
+void CAtomGain::applyParam(const tAtomParamMsg &msg)
+{
+    if (msg.ch == SET_ALL_CH_IND)
     {
         for (auto c = 0; c < m_Props.m_NumChOut; c++)
         {
-            m_TargetGains[c] = targetGainLin;
+            m_TargetGains[c] = msg.val[0];
         }
     }
     else
     {
-        m_TargetGains[ch] = targetGainLin;
+        m_TargetGains[msg.ch] = msg.val[0];
     }
+}
+
+void CAtomGain::commitParams(void)
+{
     calculateDeltas();
     startMorph();
 }
 
 void CAtomGain::calculateDeltas(void)
 {
-    if (m_MorphBlocksizeTotal > 0.F)
+    if (m_MorphSamplesTotal > 0)
     {
         for (auto c = 0; c < m_Props.m_NumChOut; c++)
         {
-            m_DeltaGains[c] = (m_TargetGains[c] - m_Gains[c]) / (m_MorphBlocksizeTotal * m_Props.m_BlockSize);
+            m_DeltaGains[c] = (m_TargetGains[c] - m_Gains[c]) / m_MorphSamplesTotal;
         }
     }
     else
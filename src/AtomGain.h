@@ -9,24 +9,139 @@
 class CAtomGain : public CAudioQuarkLinearMorph<float32_t>
 {
 public:
+    using CAudioQuarkLinearMorph<float32_t>::init;
+    using CAudioQuarkLinearMorph<float32_t>::play;
+    using CAudioQuarkLinearMorph<float32_t>::playInterleaved;
+
     /**
      * @brief See base class definition
      */
     int32_t init(const CQuarkProps &props) override;
 
+    /**
+     * @brief See base class definition
+     */
+    static size_t getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo = false,
+                                    const size_t paramQueueSize = ATOM_PARAM_QUEUE_SIZE);
+
     /**
      * @brief See base class definition
      */
     void play(float32_t **const in, float32_t **const out) override;
 
+    /**
+     * @brief See base class definition
+     */
+    void playSlice(float32_t **const in, float32_t **const out, cint32_t chBegin, cint32_t chEnd,
+                   cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playInterleaved(const float32_t *in, float32_t *out) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void playFramesInterleaved(const float32_t *in, float32_t *out, cint32_t start, cint32_t len) override;
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isSliceable(void) const override { return true; };
+
+    /**
+     * @brief See base class definition
+     */
+    bool_t isInPlace(void) const override { return true; };
+
     /**
      * @brief See base class definition
      */
     void set(cint32_t ch, cint32_t el, cfloat32_t value) override;
 
+    /**
+     * @brief Per channel state of the sample kernel, see tick()
+     */
+    typedef struct
+    {
+        float32_t gain;
+    } tAtomGainTick;
+
+    /**
+     * @brief Load the current (not morphing) state of channel ch for tick()
+     *
+     * @param ch
+     * @return tAtomGainTick
+     */
+    inline tAtomGainTick beginTick(cint32_t ch) const { return {m_Gains[ch]}; }
+
+    /**
+     * @brief Process one sample, see CAtomChain
+     *
+     * @param t
+     * @param x
+     * @return float32_t
+     */
+    inline float32_t tick(const tAtomGainTick &t, cfloat32_t x) const { return x * t.gain; }
+
+    /**
+     * @brief Store the state of channel ch after tick(), nothing to store
+     *
+     * @param ch
+     * @param t
+     */
+    inline void endTick(cint32_t ch, const tAtomGainTick &t) {}
+
 protected:
+    /**
+     * @brief Kernel of playSlice() on planar or interleaved views, see
+     *        CAtomPlanar and CAtomInterleaved
+     */
+    template <class IN, class OUT>
+    void playSliceIo(const IN &in, const OUT &out, cint32_t chBegin, cint32_t chEnd,
+                     cint32_t start, cint32_t len);
+
+    /**
+     * @brief Out-of-place static gain, pIn and pOut must not overlap
+     *
+     * @param pIn
+     * @param pOut
+     * @param gain
+     * @param len Number of samples
+     */
+    static inline void scale(const float32_t *RESTRICT pIn, float32_t *RESTRICT pOut, cfloat32_t gain,
+                             cint32_t len)
+    {
+        for (auto i = 0; i < len; i++)
+            pOut[i] = pIn[i] * gain;
+    }
+
+    /**
+     * @brief In-place static gain
+     *
+     * @param pBuf
+     * @param gain
+     * @param len Number of samples
+     */
+    static inline void scaleInPlace(float32_t *RESTRICT pBuf, cfloat32_t gain, cint32_t len)
+    {
+        for (auto i = 0; i < len; i++)
+            pBuf[i] *= gain;
+    }
+
     void calculateDeltas(void) override;
 
+    bool_t prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg) override;
+
+    void applyParam(const tAtomParamMsg &msg) override;
+
+    void commitParams(void) override;
+
+    void endMorph(void) override;
+
+    void layoutMem(CAtomMemLayout &mem) override;
+
     float32_t *m_TargetGains = nullptr;
     float32_t *m_DeltaGains = nullptr;
     float32_t *m_Gains = nullptr;
@@ -0,0 +1,339 @@
+#include "AtomGraph.h"
+
+int32_t CAtomGraph::init(const CQuarkProps &props)
+{
+    setProps(props);
+    m_ParamQueueSize = 0; // parameters go to the nodes directly
+
+    m_Nodes.clear();
+    m_Sources.clear();
+    m_OutSources.assign(MAX(props.m_NumChOut, 0), {GRAPH_IO_NODE, -1});
+    m_Schedule.clear();
+    m_InPatches.clear();
+    m_NumPortsIn = 0;
+    m_NumPortsOut = 0;
+    m_NumBuffers = 0;
+    m_Compiled = false;
+
+    return 0;
+}
+
+int32_t CAtomGraph::addNode(CAudioQuark<float32_t> &atom)
+{
+    const CQuarkProps &props = atom.getProps();
+    if (props.m_BlockSize != m_Props.m_BlockSize)
+        return -1;
+
+    tGraphNode node = {&atom, MAX(props.m_NumChIn, 0), MAX(props.m_NumChOut, 0), m_NumPortsIn, m_NumPortsOut};
+    m_NumPortsIn += node.numIn;
+    m_NumPortsOut += node.numOut;
+    m_Sources.resize(m_NumPortsIn, {GRAPH_IO_NODE, -1});
+    m_Nodes.push_back(node);
+    m_Compiled = false;
+
+    return (int32_t)m_Nodes.size() - 1;
+}
+
+int32_t CAtomGraph::connect(cint32_t srcNode, cint32_t srcCh, cint32_t dstNode, cint32_t dstCh)
+{
+    cint32_t numNodes = (int32_t)m_Nodes.size();
+    if (srcNode < GRAPH_IO_NODE || srcNode >= numNodes || dstNode < GRAPH_IO_NODE || dstNode >= numNodes)
+        return -1;
+
+    cint32_t numSrcCh = (srcNode == GRAPH_IO_NODE) ? m_Props.m_NumChIn : m_Nodes[srcNode].numOut;
+    cint32_t numDstCh = (dstNode == GRAPH_IO_NODE) ? m_Props.m_NumChOut : m_Nodes[dstNode].numIn;
+    if (srcCh < 0 || srcCh >= numSrcCh || dstCh < 0 || dstCh >= numDstCh)
+        return -1;
+
+    if (dstNode == GRAPH_IO_NODE)
+        m_OutSources[dstCh] = {srcNode, srcCh};
+    else
+        m_Sources[m_Nodes[dstNode].firstIn + dstCh] = {srcNode, srcCh};
+    m_Compiled = false;
+
+    return 0;
+}
+
+int32_t CAtomGraph::compile(void)
+{
+    cint32_t numNodes = (int32_t)m_Nodes.size();
+    m_Compiled = false;
+
+    // Kahn's algorithm, one dependency per connected input
+    std::vector<std::vector<int32_t>> consumers(numNodes);
+    m_NumDeps.assign(numNodes, 0);
+    for (auto n = 0; n < numNodes; n++)
+    {
+        const tGraphNode &node = m_Nodes[n];
+        for (auto ch = 0; ch < node.numIn; ch++)
+        {
+            const tGraphPort &src = m_Sources[node.firstIn + ch];
+            if (src.node >= 0 && src.ch >= 0)
+            {
+                m_NumDeps[n]++;
+                consumers[src.node].push_back(n);
+            }
+        }
+    }
+
+    std::vector<int32_t> numDeps = m_NumDeps;
+    m_Schedule.clear();
+    m_Roots.clear();
+    for (auto n = 0; n < numNodes; n++)
+    {
+        if (numDeps[n] == 0)
+        {
+            m_Schedule.push_back(n);
+            m_Roots.push_back(n);
+        }
+    }
+    for (size_t s = 0; s < m_Schedule.size(); s++)
+    {
+        for (auto n : consumers[m_Schedule[s]])
+        {
+            if (--numDeps[n] == 0)
+                m_Schedule.push_back(n);
+        }
+    }
+    if ((int32_t)m_Schedule.size() != numNodes)
+        return -1; // cycle
+
+    m_SuccFirst.assign(numNodes + 1, 0);
+    m_Succ.clear();
+    for (auto n = 0; n < numNodes; n++)
+    {
+        m_SuccFirst[n] = (int32_t)m_Succ.size();
+        m_Succ.insert(m_Succ.end(), consumers[n].begin(), consumers[n].end());
+    }
+    m_SuccFirst[numNodes] = (int32_t)m_Succ.size();
+    m_Deps.reset(new std::atomic<int32_t>[MAX(numNodes, 1)]);
+
+    std::vector<int32_t> color;
+    m_NumBuffers = colorBuffers(color);
+    if (0 != initMem())
+        return -1;
+
+    // resolve the port pointers, graph inputs are patched in play()
+    m_InPatches.clear();
+    for (auto p = 0; p < m_NumPortsOut; p++)
+        m_PortOut[p] = m_Buffers[color[p]];
+    for (auto p = 0; p < m_NumPortsIn; p++)
+    {
+        const tGraphPort &src = m_Sources[p];
+        cint32_t ind = outIndex(src);
+        if (ind >= 0)
+        {
+            m_PortIn[p] = m_PortOut[ind];
+        }
+        else
+        {
+            m_PortIn[p] = m_Zeros;
+            if (src.node == GRAPH_IO_NODE && src.ch >= 0)
+                m_InPatches.push_back({p, src.ch});
+        }
+    }
+    m_Compiled = true;
+
+    return 0;
+}
+
+int32_t CAtomGraph::colorBuffers(std::vector<int32_t> &color)
+{
+    cint32_t numNodes = (int32_t)m_Nodes.size();
+    const bool_t parallel = isParallel();
+
+    // liveness: number of pending reads of each node output. Outputs feeding
+    // the graph outputs are pinned until the end of the block
+    std::vector<int32_t> numReads(m_NumPortsOut, 0);
+    std::vector<bool_t> pinned(m_NumPortsOut, false);
+    for (auto p = 0; p < m_NumPortsIn; p++)
+    {
+        cint32_t ind = outIndex(m_Sources[p]);
+        if (ind >= 0)
+            numReads[ind]++;
+    }
+    for (auto &src : m_OutSources)
+    {
+        cint32_t ind = outIndex(src);
+        if (ind >= 0)
+            pinned[ind] = true;
+    }
+
+    // in parallel, a buffer may only be reused by a node that all of its
+    // previous users (writer and readers) are ancestors of
+    std::vector<std::vector<bool_t>> ancestors;
+    std::vector<std::vector<int32_t>> users;
+    if (parallel)
+    {
+        ancestors.assign(numNodes, std::vector<bool_t>(numNodes, false));
+        for (auto n : m_Schedule)
+        {
+            for (auto s = m_SuccFirst[n]; s < m_SuccFirst[n + 1]; s++)
+            {
+                std::vector<bool_t> &anc = ancestors[m_Succ[s]];
+                anc[n] = true;
+                for (auto a = 0; a < numNodes; a++)
+                    anc[a] = anc[a] || ancestors[n][a];
+            }
+        }
+    }
+
+    // coloring in schedule order: outputs of a node are assigned before its
+    // inputs are released, so a node only runs in-place when it supports it
+    // and is the last reader of its input. The pool is a stack, the most
+    // recently released (and likely cached) buffer is reused first
+    color.assign(m_NumPortsOut, -1);
+    std::vector<int32_t> pool;
+    int32_t numBuffers = 0;
+    for (auto n : m_Schedule)
+    {
+        const tGraphNode &node = m_Nodes[n];
+        if (node.atom->isInPlace())
+        {
+            for (auto ch = 0; ch < MIN(node.numIn, node.numOut); ch++)
+            {
+                cint32_t ind = outIndex(m_Sources[node.firstIn + ch]);
+                if (ind < 0 || numReads[ind] != 1 || pinned[ind])
+                    continue;
+
+                bool_t ordered = true;
+                if (parallel)
+                {
+                    for (auto u : users[color[ind]])
+                        ordered = ordered && ancestors[n][u];
+                }
+                if (ordered)
+                {
+                    // the output takes over the buffer, the input is not released
+                    color[node.firstOut + ch] = color[ind];
+                    numReads[ind] = -1;
+                    if (parallel)
+                        users[color[ind]].assign(1, n);
+                }
+            }
+        }
+        for (auto ch = 0; ch < node.numOut; ch++)
+        {
+            if (color[node.firstOut + ch] >= 0)
+                continue; // in-place
+
+            int32_t pick = -1;
+            for (auto i = (int32_t)pool.size() - 1; i >= 0 && pick < 0; i--)
+            {
+                bool_t ordered = true;
+                if (parallel)
+                {
+                    for (auto u : users[pool[i]])
+                        ordered = ordered && ancestors[n][u];
+                }
+                if (ordered)
+                    pick = i;
+            }
+
+            if (pick < 0)
+            {
+                color[node.firstOut + ch] = numBuffers++;
+                users.emplace_back();
+            }
+            else
+            {
+                color[node.firstOut + ch] = pool[pick];
+                pool.erase(pool.begin() + pick);
+            }
+            if (parallel)
+                users[color[node.firstOut + ch]].assign(1, n);
+        }
+        for (auto ch = 0; ch < node.numIn; ch++)
+        {
+            cint32_t ind = outIndex(m_Sources[node.firstIn + ch]);
+            if (ind >= 0 && numReads[ind] > 0)
+            {
+                if (parallel)
+                    users[color[ind]].push_back(n);
+                if (--numReads[ind] == 0 && !pinned[ind])
+                    pool.push_back(color[ind]);
+            }
+        }
+        for (auto ch = 0; ch < node.numOut; ch++)
+        {
+            cint32_t ind = node.firstOut + ch;
+            if (numReads[ind] == 0 && !pinned[ind])
+                pool.push_back(color[ind]);
+        }
+    }
+
+    return numBuffers;
+}
+
+void CAtomGraph::layoutMem(CAtomMemLayout &mem)
+{
+    m_PortIn = mem.take<float32_t *>(m_NumPortsIn);
+    m_PortOut = mem.take<float32_t *>(m_NumPortsOut);
+    m_Buffers = mem.take<float32_t *>(m_NumBuffers);
+    m_Zeros = mem.take<float32_t>(m_Props.m_BlockSize);
+    for (auto b = 0; b < m_NumBuffers; b++)
+    {
+        float32_t *pBuf = mem.take<float32_t>(m_Props.m_BlockSize);
+        if (mem.isCarving())
+            m_Buffers[b] = pBuf;
+    }
+}
+
+void CAtomGraph::play(float32_t **const in, float32_t **const out)
+{
+    if (NULL != out && m_Compiled)
+    {
+        for (auto &patch : m_InPatches)
+            m_PortIn[patch.port] = (NULL != in) ? in[patch.ch] : m_Zeros;
+
+        bool_t done = false;
+        if (isParallel())
+        {
+            cint32_t numNodes = (int32_t)m_Nodes.size();
+            for (auto n = 0; n < numNodes; n++)
+                m_Deps[n].store(m_NumDeps[n], std::memory_order_relaxed);
+            // fails if the pool is busy, e.g. with a graph this one is part of
+            done = (0 == m_Pool->run(&CAtomGraph::playNode, this, m_Roots.data(), (int32_t)m_Roots.size(), numNodes));
+        }
+        if (!done)
+        {
+            for (auto n : m_Schedule)
+            {
+                const tGraphNode &node = m_Nodes[n];
+                node.atom->play(&m_PortIn[node.firstIn], &m_PortOut[node.firstOut], m_NumFrames);
+            }
+        }
+
+        for (auto ch = 0; ch < m_Props.m_NumChOut; ch++)
+        {
+            const tGraphPort &src = m_OutSources[ch];
+            cint32_t ind = outIndex(src);
+            const float32_t *pSrc = m_Zeros;
+            if (ind >= 0)
+                pSrc = m_PortOut[ind];
+            else if (src.node == GRAPH_IO_NODE && src.ch >= 0 && NULL != in)
+                pSrc = in[src.ch];
+
+            float32_t *pOut = out[ch];
+            if (pSrc != pOut)
+            {
+                for (auto i = 0; i < m_NumFrames; i++)
+                    pOut[i] = pSrc[i];
+            }
+        }
+    }
+}
+
+void CAtomGraph::playNode(void *ctx, cint32_t task, cint32_t worker)
+{
+    CAtomGraph *pGraph = static_cast<CAtomGraph *>(ctx);
+    const tGraphNode &node = pGraph->m_Nodes[task];
+    node.atom->play(&pGraph->m_PortIn[node.firstIn], &pGraph->m_PortOut[node.firstOut], pGraph->m_NumFrames);
+
+    for (auto s = pGraph->m_SuccFirst[task]; s < pGraph->m_SuccFirst[task + 1]; s++)
+    {
+        cint32_t succ = pGraph->m_Succ[s];
+        if (pGraph->m_Deps[succ].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            pGraph->m_Pool->push(worker, succ);
+    }
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "AudioAtom.h"
+#include "AtomThreadPool.h"
+
+#define GRAPH_IO_NODE (-1) // node id of the graph inputs (as source) and outputs (as destination)
+
+/**
+ * @brief Container connecting atoms into a processing graph. Atoms are owned
+ *        and initialized by the host, with the same block size as the graph,
+ *        and added as nodes. Channel ports are then connected and the graph
+ *        compiled into a topologically sorted schedule, so that play() runs
+ *        the whole graph with one call.
+ *
+ *        Intermediate buffers are assigned by liveness: a buffer is returned
+ *        to a pool right after its last consumer ran and picked up again by
+ *        the next node, so the number of buffers only depends on the width of
+ *        the graph, not on its length, and the working set stays small.
+ *        Atoms that are in-place (see CAudioQuark::isInPlace()) write into
+ *        the buffer of their input when they are its last reader, saving a
+ *        buffer and its cache footprint. Unconnected inputs read silence.
+ *
+ *        With a thread pool set, independent nodes of a block run in parallel:
+ *        each node has a dependency counter, reset at the start of the block,
+ *        and becomes ready when the last of its sources completed. Buffers are
+ *        then only reused between nodes ordered by the graph itself.
+ *
+ *        Setup (addNode(), connect(), compile()) allocates, play() does not.
+ */
+class CAtomGraph : public CAudioQuark<float32_t>
+{
+public:
+    using CAudioQuark<float32_t>::init;
+    using CAudioQuark<float32_t>::play;
+    using CAudioQuark<float32_t>::playInterleaved;
+
+    /**
+     * @brief See base class definition. m_NumChIn and m_NumChOut are the graph
+     *        inputs and outputs. Removes all nodes.
+     */
+    int32_t init(const CQuarkProps &props) override;
+
+    /**
+     * @brief See base class definition
+     */
+    void play(float32_t **const in, float32_t **const out) override;
+
+    /**
+     * @brief Add an initialized atom as node. The graph needs to be compiled
+     *        again afterwards.
+     *
+     * @param atom
+     * @return int32_t Node id, -1 on error (block size mismatch)
+     */
+    int32_t addNode(CAudioQuark<float32_t> &atom);
+
+    /**
+     * @brief Connect output channel srcCh of node srcNode to input channel
+     *        dstCh of node dstNode. GRAPH_IO_NODE as srcNode stands for the
+     *        graph inputs and as dstNode for the graph outputs. An output can
+     *        feed several inputs, an input has a single source: connecting it
+     *        again replaces the previous connection. The graph needs to be
+     *        compiled again afterwards.
+     *
+     * @param srcNode
+     * @param srcCh
+     * @param dstNode
+     * @param dstCh
+     * @return int32_t 0 on success, -1 on invalid node or channel
+     */
+    int32_t connect(cint32_t srcNode, cint32_t srcCh, cint32_t dstNode, cint32_t dstCh);
+
+    /**
+     * @brief Sort the nodes topologically and assign the buffers
+     *
+     * @return int32_t 0 on success, -1 if the graph has a cycle or the
+     *         allocation failed
+     */
+    int32_t compile(void);
+
+    /**
+     * @brief Run the nodes on pool, NULL to run them serially on the calling
+     *        thread. The pool is shared, not owned, and must hold at least as
+     *        many tasks as the graph has nodes. The graph needs to be compiled
+     *        again afterwards.
+     *
+     * @param pool
+     */
+    void setThreadPool(CAtomThreadPool *pool)
+    {
+        m_Pool = pool;
+        m_Compiled = false;
+    };
+
+    /**
+     * @brief Get the parallel efficiency of the last block, 1 when serial.
+     *        See CAtomThreadPool::getParallelEfficiency().
+     *
+     * @return float32_t
+     */
+    float32_t getParallelEfficiency(void) const
+    {
+        return isParallel() ? m_Pool->getParallelEfficiency() : 1.F;
+    };
+
+    /**
+     * @brief Get the number of intermediate buffers assigned by compile()
+     *
+     * @return int32_t
+     */
+    int32_t getNumBuffers(void) const { return m_NumBuffers; };
+
+    /**
+     * @brief Get the number of nodes
+     *
+     * @return int32_t
+     */
+    int32_t getNumNodes(void) const { return (int32_t)m_Nodes.size(); };
+
+protected:
+    typedef struct
+    {
+        int32_t node; // GRAPH_IO_NODE for graph inputs, -1 ch for unconnected
+        int32_t ch;
+    } tGraphPort;
+
+    typedef struct
+    {
+        CAudioQuark<float32_t> *atom;
+        int32_t numIn;
+        int32_t numOut;
+        int32_t firstIn;  // index of the first input in m_Sources / m_PortIn
+        int32_t firstOut; // index of the first output in m_PortOut
+    } tGraphNode;
+
+    typedef struct
+    {
+        int32_t port; // index in m_PortIn
+        int32_t ch;   // graph input channel
+    } tGraphInPatch;
+
+    void layoutMem(CAtomMemLayout &mem) override;
+
+    /**
+     * @brief Assign a buffer to each node output, see compile()
+     *
+     * @param color Buffer index of each node output
+     * @return int32_t Number of buffers
+     */
+    int32_t colorBuffers(std::vector<int32_t> &color);
+
+    /**
+     * @brief Task function of the thread pool: play node task, then make the
+     *        nodes it completes ready
+     */
+    static void playNode(void *ctx, cint32_t task, cint32_t worker);
+
+    inline bool_t isParallel(void) const
+    {
+        return NULL != m_Pool && m_Pool->getNumThreads() > 1;
+    }
+
+    /**
+     * @brief Index in m_PortOut of a node output, -1 for graph inputs and
+     *        unconnected ports
+     */
+    inline int32_t outIndex(const tGraphPort &src) const
+    {
+        return (src.node >= 0 && src.ch >= 0) ? m_Nodes[src.node].firstOut + src.ch : -1;
+    }
+
+    // topology, setup only
+    std::vector<tGraphNode> m_Nodes;
+    std::vector<tGraphPort> m_Sources;    // source of each node input
+    std::vector<tGraphPort> m_OutSources; // source of each graph output
+    std::vector<int32_t> m_Schedule;
+    std::vector<tGraphInPatch> m_InPatches;
+    int32_t m_NumPortsIn = 0;
+    int32_t m_NumPortsOut = 0;
+    int32_t m_NumBuffers = 0;
+    bool_t m_Compiled = false;
+
+    // parallel execution
+    CAtomThreadPool *m_Pool = nullptr;
+    std::vector<int32_t> m_NumDeps;   // connected inputs of each node
+    std::vector<int32_t> m_SuccFirst; // consumers of node n: m_Succ[m_SuccFirst[n] .. m_SuccFirst[n + 1]]
+    std::vector<int32_t> m_Succ;
+    std::vector<int32_t> m_Roots;
+    std::unique_ptr<std::atomic<int32_t>[]> m_Deps;
+
+    // carved from the memory block by compile()
+    float32_t **m_PortIn = nullptr;  // buffer read by each node input
+    float32_t **m_PortOut = nullptr; // buffer written by each node output
+    float32_t **m_Buffers = nullptr;
+    float32_t *m_Zeros = nullptr;
+};
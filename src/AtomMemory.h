@@ -0,0 +1,196 @@
+#pragma once
+
+#include <stddef.h>
+#include <new>
+#include "AudioTypes.h"
+
+#define ATOM_MEM_ALIGN (64) // cache line
+
+/**
+ * @brief Carves the arrays of an atom out of one contiguous memory block,
+ *        each of them aligned to ATOM_MEM_ALIGN. Constructed without a base
+ *        pointer it only measures: take() returns NULL and getSize() gives the
+ *        size of the block to be allocated. Running the same sequence of
+ *        take() calls on both keeps sizing and carving in sync.
+ */
+class CAtomMemLayout
+{
+public:
+    /**
+     * @brief Construct a new CAtomMemLayout object
+     *
+     * @param base Start of the block, or NULL to only measure
+     */
+    CAtomMemLayout(uint8_t *base = NULL) : m_Base(base), m_Offset(0) {};
+
+    /**
+     * @brief Take the next aligned array of num elements
+     *
+     * @tparam U Element type
+     * @param num Number of elements
+     * @return U* Pointer to the array, NULL when only measuring
+     */
+    template <class U>
+    U *take(cint32_t num)
+    {
+        m_Offset = alignUp(m_Offset);
+        U *ptr = (NULL != m_Base) ? reinterpret_cast<U *>(m_Base + m_Offset) : NULL;
+        m_Offset += sizeof(U) * (size_t)MAX(num, 0);
+        return ptr;
+    }
+
+    /**
+     * @brief Whether take() hands out actual memory
+     *
+     * @return bool_t
+     */
+    bool_t isCarving(void) const { return NULL != m_Base; };
+
+    /**
+     * @brief Get the size in bytes of the block, rounded up to ATOM_MEM_ALIGN
+     *
+     * @return size_t
+     */
+    size_t getSize(void) const { return alignUp(m_Offset); };
+
+    /**
+     * @brief Round size up to a multiple of ATOM_MEM_ALIGN
+     *
+     * @param size
+     * @return size_t
+     */
+    static size_t alignUp(const size_t size)
+    {
+        return (size + ATOM_MEM_ALIGN - 1) & ~((size_t)ATOM_MEM_ALIGN - 1);
+    }
+
+private:
+    uint8_t *m_Base;
+    size_t m_Offset;
+};
+
+/**
+ * @brief Linear (bump) allocator holding the memory of a whole chain of
+ *        atoms. Size it with the sum of the getMemRequirement() of each atom
+ *        and init the atoms with it in processing order: their blocks then
+ *        lie back to back in memory. Blocks are never freed individually,
+ *        the arena is released as a whole.
+ */
+class CAtomArena
+{
+public:
+    /**
+     * @brief Construct an empty CAtomArena object, see init()
+     *
+     */
+    CAtomArena() {};
+
+    /**
+     * @brief Construct a CAtomArena object on external memory (e.g. a static
+     *        buffer). If mem is not aligned to ATOM_MEM_ALIGN, up to
+     *        ATOM_MEM_ALIGN - 1 bytes are lost at its start.
+     *
+     * @param mem
+     * @param size Size in bytes
+     */
+    CAtomArena(uint8_t *mem, const size_t size)
+    {
+        if (NULL != mem)
+        {
+            size_t skip = CAtomMemLayout::alignUp((size_t)mem) - (size_t)mem;
+            if (skip <= size)
+            {
+                m_Base = mem + skip;
+                m_Size = size - skip;
+            }
+        }
+    };
+
+    /**
+     * @brief Destroy the CAtomArena object, releasing owned memory
+     *
+     */
+    ~CAtomArena() { deinit(); };
+
+    CAtomArena(const CAtomArena &) = delete;
+    CAtomArena &operator=(const CAtomArena &) = delete;
+
+    /**
+     * @brief Allocate the arena on the heap, in one single call
+     *
+     * @param size Size in bytes
+     * @return int32_t 0 on success, -1 if the allocation failed
+     */
+    int32_t init(const size_t size)
+    {
+        int32_t retval = 0;
+        deinit();
+        if (size > 0)
+        {
+            m_Base = static_cast<uint8_t *>(
+                ::operator new(CAtomMemLayout::alignUp(size), std::align_val_t(ATOM_MEM_ALIGN), std::nothrow));
+            if (NULL != m_Base)
+            {
+                m_Size = CAtomMemLayout::alignUp(size);
+                m_Owned = true;
+            }
+            else
+            {
+                retval = -1;
+            }
+        }
+        return retval;
+    };
+
+    /**
+     * @brief Release owned memory. Protected against multiple calls.
+     *
+     */
+    void deinit(void)
+    {
+        if (m_Owned && NULL != m_Base)
+            ::operator delete(m_Base, std::align_val_t(ATOM_MEM_ALIGN));
+        m_Base = NULL;
+        m_Size = 0;
+        m_Used = 0;
+        m_Owned = false;
+    };
+
+    /**
+     * @brief Take the next aligned block
+     *
+     * @param size Size in bytes
+     * @return uint8_t* The block, or NULL if the arena is exhausted
+     */
+    uint8_t *alloc(const size_t size)
+    {
+        uint8_t *mem = NULL;
+        const bool_t fits = (NULL != m_Base) && (CAtomMemLayout::alignUp(size) <= m_Size - m_Used);
+        if (fits)
+        {
+            mem = m_Base + m_Used;
+            m_Used += CAtomMemLayout::alignUp(size);
+        }
+        return mem;
+    };
+
+    /**
+     * @brief Get the number of bytes handed out so far
+     *
+     * @return size_t
+     */
+    size_t getUsed(void) const { return m_Used; };
+
+    /**
+     * @brief Get the total size in bytes
+     *
+     * @return size_t
+     */
+    size_t getSize(void) const { return m_Size; };
+
+private:
+    uint8_t *m_Base = NULL;
+    size_t m_Size = 0;
+    size_t m_Used = 0;
+    bool_t m_Owned = false;
+};
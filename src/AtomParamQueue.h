@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include "AudioTypes.h"
+
+#define ATOM_PARAM_QUEUE_SIZE (64) // default number of messages, power of 2
+#define ATOM_PARAM_MSG_VALS (8)    // payload of one message
+
+/**
+ * @brief Parameter change message, as prepared on the control thread by an
+ *        atom and applied by the same atom on the audio thread. The meaning
+ *        of val is up to the atom, typically precalculated target values.
+ */
+typedef struct
+{
+    int32_t ch;
+    int32_t el;
+    int32_t offset; // sample offset in the block it is applied in
+    float32_t val[ATOM_PARAM_MSG_VALS];
+} tAtomParamMsg;
+
+/**
+ * @brief Bounded lock-free multi producer, single consumer queue of parameter
+ *        messages (Vyukov's bounded queue). Each cell carries a sequence
+ *        number telling whether it is free for the producer of a given turn or
+ *        ready for the consumer, so producers only contend on the enqueue
+ *        position and the consumer never blocks. The cells live in memory
+ *        provided by the owner.
+ */
+class CAtomParamQueue
+{
+public:
+    typedef struct
+    {
+        std::atomic<size_t> seq;
+        tAtomParamMsg msg;
+    } tAtomParamCell;
+
+    /**
+     * @brief Set up the queue on cells, dropping all pending messages
+     *
+     * @param cells Memory for size cells
+     * @param size Number of cells, power of 2, 0 to disable the queue
+     */
+    void init(tAtomParamCell *cells, const size_t size)
+    {
+        m_Cells = (size > 0) ? cells : NULL;
+        m_Mask = (size > 0) ? size - 1 : 0;
+        for (size_t i = 0; i < size; i++)
+            new (&cells[i].seq) std::atomic<size_t>(i);
+        m_Enqueue.store(0, std::memory_order_relaxed);
+        m_Dequeue = 0;
+    };
+
+    /**
+     * @brief Enqueue a message, any thread
+     *
+     * @param msg
+     * @return bool_t false if the queue is full (or disabled)
+     */
+    bool_t push(const tAtomParamMsg &msg)
+    {
+        if (NULL == m_Cells)
+            return false;
+
+        size_t pos = m_Enqueue.load(std::memory_order_relaxed);
+        while (true)
+        {
+            tAtomParamCell *pCell = &m_Cells[pos & m_Mask];
+            const size_t seq = pCell->seq.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_Enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    pCell->msg = msg;
+                    pCell->seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = m_Enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief Dequeue a message, consumer (audio) thread only
+     *
+     * @param msg
+     * @return bool_t false if the queue is empty
+     */
+    bool_t pop(tAtomParamMsg &msg)
+    {
+        if (NULL == m_Cells)
+            return false;
+
+        tAtomParamCell *pCell = &m_Cells[m_Dequeue & m_Mask];
+        const size_t seq = pCell->seq.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(m_Dequeue + 1) < 0)
+            return false; // empty, or a producer is still writing this cell
+
+        msg = pCell->msg;
+        pCell->seq.store(m_Dequeue + m_Mask + 1, std::memory_order_release);
+        m_Dequeue++;
+        return true;
+    };
+
+    /**
+     * @brief Round size up to the next power of 2
+     *
+     * @param size
+     * @return size_t
+     */
+    static size_t roundSize(const size_t size)
+    {
+        size_t rounded = (size > 0) ? 1 : 0;
+        while (rounded < size)
+            rounded <<= 1;
+        return rounded;
+    };
+
+private:
+    tAtomParamCell *m_Cells = NULL;
+    size_t m_Mask = 0;
+    alignas(64) std::atomic<size_t> m_Enqueue{0};
+    alignas(64) size_t m_Dequeue = 0;
+};
@@ -0,0 +1,65 @@
+#include "AtomSlicer.h"
+
+int32_t CAtomSlicer::init(CAudioQuark<float32_t> &atom, CAtomThreadPool &pool, cint32_t numSlices)
+{
+    if (!atom.isSliceable() || numSlices < 1)
+        return -1;
+
+    setProps(atom.getProps());
+    m_Atom = &atom;
+    m_Pool = &pool;
+
+    cint32_t numCh = m_Props.m_NumChOut;
+    cint32_t num = MAX(MIN(numSlices, numCh), 1);
+    m_Slices.resize(num);
+    m_SliceBegin.resize(num + 1);
+    for (auto s = 0; s <= num; s++)
+    {
+        if (s < num)
+            m_Slices[s] = s;
+        m_SliceBegin[s] = (s * numCh) / num;
+    }
+
+    return 0;
+}
+
+void CAtomSlicer::play(float32_t **const in, float32_t **const out)
+{
+    if (NULL != out && NULL != in && NULL != m_Atom)
+    {
+        // a busy pool is not reentrant, e.g. within a graph running on it
+        if (m_Slices.size() > 1 && m_Pool->getNumThreads() > 1 && !m_Pool->isRunning())
+        {
+            m_In = in;
+            m_Out = out;
+            m_Atom->setNumFrames(m_NumFrames);
+            m_Atom->drainParams();
+            for (int32_t pos = 0; pos < m_NumFrames;)
+            {
+                cint32_t end = m_Atom->getSegmentEnd();
+                m_Start = pos;
+                m_Len = end - pos;
+                // the pool may have been taken meanwhile, do the segment here then
+                if (0 != m_Pool->run(&CAtomSlicer::runSlice, this, m_Slices.data(), (int32_t)m_Slices.size(),
+                                     (int32_t)m_Slices.size()))
+                    m_Atom->playSlice(in, out, 0, m_Props.m_NumChOut, m_Start, m_Len);
+                m_Atom->advance(m_Len);
+                pos = end;
+                m_Atom->applyParams(pos);
+            }
+            m_Atom->setNumFrames(m_Props.m_BlockSize);
+        }
+        else
+        {
+            m_Atom->play(in, out, m_NumFrames);
+        }
+    }
+}
+
+void CAtomSlicer::runSlice(void *ctx, cint32_t task, cint32_t worker)
+{
+    CAtomSlicer *pSlicer = static_cast<CAtomSlicer *>(ctx);
+    pSlicer->m_Atom->playSlice(pSlicer->m_In, pSlicer->m_Out,
+                               pSlicer->m_SliceBegin[task], pSlicer->m_SliceBegin[task + 1],
+                               pSlicer->m_Start, pSlicer->m_Len);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include "AudioAtom.h"
+#include "AtomThreadPool.h"
+
+/**
+ * @brief Runs one wide atom over several threads by splitting its output
+ *        channels into disjoint slices (see CAudioQuark::playSlice()), e.g.
+ *        a CAtomBiquad on a 128 channel bus. The block is split into segments
+ *        at the offsets of the posted events, like CAudioQuark::playSegments()
+ *        does. All slices of a segment are run on the thread pool, then the
+ *        atom's advance() is called once from the calling thread, so morph
+ *        counters advance exactly once per segment.
+ *
+ *        The slicer is an atom itself, with the properties of the sliced one,
+ *        so it can be added to a CAtomGraph in its place. The pool runs one
+ *        job at a time though: while it is busy, e.g. with the graph the
+ *        slicer is part of, the slices are played from the calling thread.
+ */
+class CAtomSlicer : public CAudioQuark<float32_t>
+{
+public:
+    using CAudioQuark<float32_t>::init;
+    using CAudioQuark<float32_t>::play;
+    using CAudioQuark<float32_t>::playInterleaved;
+
+    /**
+     * @brief Slice atom in numSlices channel ranges of (almost) equal size,
+     *        to run on pool. atom must be initialized and sliceable, and is
+     *        not owned.
+     *
+     * @param atom
+     * @param pool
+     * @param numSlices Clipped to the number of output channels
+     * @return int32_t 0 on success, -1 if atom is not sliceable
+     */
+    int32_t init(CAudioQuark<float32_t> &atom, CAtomThreadPool &pool, cint32_t numSlices);
+
+    /**
+     * @brief See base class definition
+     */
+    void play(float32_t **const in, float32_t **const out) override;
+
+    /**
+     * @brief See base class definition, same as the sliced atom
+     */
+    bool_t isInPlace(void) const override { return NULL != m_Atom && m_Atom->isInPlace(); };
+
+    /**
+     * @brief See base class definition, forwarded to the sliced atom
+     */
+    void set(cint32_t ch, cint32_t el, cint32_t value) override { m_Atom->set(ch, el, value); };
+
+    /**
+     * @brief See base class definition, forwarded to the sliced atom
+     */
+    void set(cint32_t ch, cint32_t el, cfloat32_t value) override { m_Atom->set(ch, el, value); };
+
+    /**
+     * @brief See base class definition, forwarded to the sliced atom
+     */
+    void set(void *params, cint32_t len) override { m_Atom->set(params, len); };
+
+    /**
+     * @brief See base class definition, forwarded to the sliced atom
+     */
+    int32_t post(cint32_t ch, cint32_t el, cfloat32_t value, cint32_t offset = 0) override
+    {
+        return m_Atom->post(ch, el, value, offset);
+    };
+
+    /**
+     * @brief See base class definition, forwarded to the sliced atom
+     */
+    int32_t post(void *params, cint32_t len, cint32_t offset = 0) override
+    {
+        return m_Atom->post(params, len, offset);
+    };
+
+    /**
+     * @brief Get the number of slices
+     *
+     * @return int32_t
+     */
+    int32_t getNumSlices(void) const { return (int32_t)m_Slices.size(); };
+
+protected:
+    /**
+     * @brief Task function of the thread pool, plays slice task of the atom
+     */
+    static void runSlice(void *ctx, cint32_t task, cint32_t worker);
+
+    CAudioQuark<float32_t> *m_Atom = nullptr;
+    CAtomThreadPool *m_Pool = nullptr;
+    std::vector<int32_t> m_Slices;     // task indices, the roots of the job
+    std::vector<int32_t> m_SliceBegin; // first channel of each slice, plus the end
+    float32_t **m_In = nullptr;
+    float32_t **m_Out = nullptr;
+    int32_t m_Start = 0; // current segment
+    int32_t m_Len = 0;
+};
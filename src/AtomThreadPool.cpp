@@ -0,0 +1,180 @@
+#include "AtomThreadPool.h"
+#include "DenormalGuard.h"
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define CPU_RELAX()
+#endif
+
+void CAtomThreadPool::relax(cuint32_t spin)
+{
+    // give the core away now and then, in case there are more threads than cores
+    if ((spin & (YIELD_PERIOD - 1)) == YIELD_PERIOD - 1)
+        std::this_thread::yield();
+    else
+        CPU_RELAX();
+}
+
+int32_t CAtomThreadPool::init(cint32_t numThreads, cint32_t maxTasks)
+{
+    if (numThreads < 1 || maxTasks < 1)
+        return -1;
+
+    deinit();
+
+    m_NumThreads = numThreads;
+    m_Workers.reset(new tAtomWorker[numThreads]);
+    for (auto w = 0; w < numThreads; w++)
+    {
+        m_Workers[w].deque.init(maxTasks);
+        m_Workers[w].busyNs.store(0);
+    }
+
+    m_Quit.store(false);
+    cuint32_t generation = m_Generation.load();
+    for (auto w = 1; w < numThreads; w++)
+        m_Threads.emplace_back(&CAtomThreadPool::workerLoop, this, w, generation);
+
+    return 0;
+}
+
+void CAtomThreadPool::deinit(void)
+{
+    if (!m_Threads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit.store(true);
+        }
+        m_Cond.notify_all();
+        for (auto &thread : m_Threads)
+            thread.join();
+        m_Threads.clear();
+    }
+    m_Workers.reset();
+    m_NumThreads = 0;
+}
+
+int32_t CAtomThreadPool::run(tAtomTaskFunc func, void *ctx, const int32_t *roots, cint32_t numRoots, cint32_t numTasks)
+{
+    if (NULL == func || numTasks <= 0 || m_NumThreads < 1)
+        return -1;
+    if (m_Running.exchange(true, std::memory_order_acq_rel))
+        return -1;
+
+    auto start = std::chrono::steady_clock::now();
+
+    m_Func = func;
+    m_Ctx = ctx;
+    m_Remaining.store(numTasks, std::memory_order_relaxed);
+    for (auto w = 0; w < m_NumThreads; w++)
+        m_Workers[w].busyNs.store(0, std::memory_order_relaxed);
+    for (auto r = 0; r < numRoots; r++)
+        push(0, roots[r]);
+
+    // publish the job, wake the parked workers (see workerLoop())
+    cuint32_t generation = m_Generation.fetch_add(1, std::memory_order_seq_cst) + 1;
+    if (m_NumParked.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+        }
+        m_Cond.notify_all();
+    }
+
+    // done once all tasks are, workers still waking up find a newer or no job
+    work(0, generation);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int64_t busyNs = 0;
+    for (auto w = 0; w < m_NumThreads; w++)
+        busyNs += m_Workers[w].busyNs.load(std::memory_order_relaxed);
+    m_Efficiency = (elapsed.count() > 0.0) ? (float32_t)(1.E-9 * busyNs / (elapsed.count() * m_NumThreads)) : 1.F;
+    m_Running.store(false, std::memory_order_release);
+    return 0;
+}
+
+void CAtomThreadPool::push(cint32_t worker, cint32_t task)
+{
+    if (!m_Workers[worker].deque.push(task))
+    {
+        // never happens with maxTasks respected, but do not lose the task
+        m_Func(m_Ctx, task, worker);
+        m_Remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void CAtomThreadPool::work(cint32_t worker, cuint32_t generation)
+{
+    CAtomTaskDeque &own = m_Workers[worker].deque;
+    uint32_t spin = 0;
+
+    /*
+     * A task in a deque belongs to the current job, which cannot complete
+     * before it does, so m_Func and m_Ctx read after taking it are the ones
+     * of its job, even for a worker of a previous generation
+     */
+    while (m_Generation.load(std::memory_order_acquire) == generation &&
+           m_Remaining.load(std::memory_order_acquire) > 0)
+    {
+        int32_t task;
+        bool_t found = own.pop(task);
+        for (auto v = 1; !found && v < m_NumThreads; v++)
+            found = m_Workers[(worker + v) % m_NumThreads].deque.steal(task);
+
+        if (found)
+        {
+            auto start = std::chrono::steady_clock::now();
+            m_Func(m_Ctx, task, worker);
+            // accounted before the task completes, i.e. within its job
+            m_Workers[worker].busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   std::chrono::steady_clock::now() - start)
+                                                   .count(),
+                                               std::memory_order_relaxed);
+            m_Remaining.fetch_sub(1, std::memory_order_acq_rel);
+            spin = 0;
+        }
+        else
+        {
+            relax(spin++);
+        }
+    }
+}
+
+void CAtomThreadPool::workerLoop(cint32_t worker, cuint32_t generation)
+{
+    CDenormalGuard guard;
+    uint32_t seen = generation;
+
+    while (true)
+    {
+        // spin, then park until a new job is published
+        uint32_t spin = 0;
+        while (m_Generation.load(std::memory_order_acquire) == seen && !m_Quit.load(std::memory_order_relaxed))
+        {
+            if (++spin < SPIN_ITERATIONS)
+            {
+                relax(spin);
+            }
+            else
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_NumParked.fetch_add(1, std::memory_order_seq_cst);
+                m_Cond.wait(lock, [&]
+                            { return m_Generation.load(std::memory_order_seq_cst) != seen || m_Quit.load(); });
+                m_NumParked.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        if (m_Quit.load())
+            break;
+
+        // a job completed in the meantime leaves this worker with nothing to do
+        seen = m_Generation.load(std::memory_order_acquire);
+        work(worker, seen);
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include "AudioTypes.h"
+
+/**
+ * @brief Fixed capacity work-stealing deque of task indices (Chase-Lev). The
+ *        owner thread pushes and pops at the bottom, other threads steal from
+ *        the top. Lock-free and allocation-free once initialized.
+ */
+class CAtomTaskDeque
+{
+public:
+    /**
+     * @brief Allocate the deque for at least capacity tasks
+     *
+     * @param capacity
+     */
+    void init(cint32_t capacity)
+    {
+        int32_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        m_Items = std::vector<std::atomic<int32_t>>(size);
+        m_Mask = size - 1;
+        m_Top.store(0);
+        m_Bottom.store(0);
+    };
+
+    /**
+     * @brief Push a task, owner only
+     *
+     * @param task
+     * @return bool_t false if the deque is full
+     */
+    bool_t push(cint32_t task)
+    {
+        const int64_t b = m_Bottom.load(std::memory_order_relaxed);
+        const int64_t t = m_Top.load(std::memory_order_acquire);
+        if (b - t > m_Mask)
+            return false;
+        m_Items[b & m_Mask].store(task, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    };
+
+    /**
+     * @brief Pop the most recently pushed task, owner only
+     *
+     * @param task
+     * @return bool_t false if the deque is empty
+     */
+    bool_t pop(int32_t &task)
+    {
+        const int64_t b = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_Top.load(std::memory_order_relaxed);
+        bool_t found = false;
+        if (t <= b)
+        {
+            task = m_Items[b & m_Mask].load(std::memory_order_relaxed);
+            found = true;
+            if (t == b)
+            {
+                // last item, race against thieves
+                found = m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed);
+                m_Bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            m_Bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return found;
+    };
+
+    /**
+     * @brief Steal the oldest task, any thread
+     *
+     * @param task
+     * @return bool_t false if the deque is empty or the race was lost
+     */
+    bool_t steal(int32_t &task)
+    {
+        int64_t t = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = m_Bottom.load(std::memory_order_acquire);
+        bool_t found = false;
+        if (t < b)
+        {
+            task = m_Items[t & m_Mask].load(std::memory_order_relaxed);
+            found = m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed);
+        }
+        return found;
+    };
+
+private:
+    alignas(64) std::atomic<int64_t> m_Top{0};
+    alignas(64) std::atomic<int64_t> m_Bottom{0};
+    std::vector<std::atomic<int32_t>> m_Items;
+    int64_t m_Mask = 0;
+};
+
+/**
+ * @brief Pool of pre-spawned worker threads executing the tasks of one job
+ *        at a time, e.g. the nodes of one CAtomGraph block. The calling
+ *        thread takes part as worker 0 and run() returns as soon as all tasks
+ *        of the job completed, without waiting for the workers: each job has
+ *        a generation, and workers leave as soon as it is not theirs anymore. Tasks become ready either as roots given to run()
+ *        or by being pushed from a running task (see push()), typically when
+ *        their last dependency completed. Idle workers steal from the others.
+ *
+ *        Between jobs the workers spin for a while and then park on a
+ *        condition variable. Waking them is the only blocking call on the
+ *        calling thread, and only happens if some of them are parked.
+ *        Worker threads process with denormals flushed to zero.
+ */
+class CAtomThreadPool
+{
+public:
+    /**
+     * @brief Task function, called with the job context, the task index and
+     *        the index of the calling worker (to be passed to push())
+     */
+    typedef void (*tAtomTaskFunc)(void *ctx, cint32_t task, cint32_t worker);
+
+    /**
+     * @brief Construct a new CAtomThreadPool object, see init()
+     *
+     */
+    CAtomThreadPool(){};
+
+    /**
+     * @brief Destroy the CAtomThreadPool object, joining the workers
+     *
+     */
+    ~CAtomThreadPool() { deinit(); };
+
+    CAtomThreadPool(const CAtomThreadPool &) = delete;
+    CAtomThreadPool &operator=(const CAtomThreadPool &) = delete;
+
+    /**
+     * @brief Spawn numThreads - 1 workers, the calling thread being worker 0
+     *
+     * @param numThreads Total number of threads, at least 1
+     * @param maxTasks Maximum number of tasks of a job
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t init(cint32_t numThreads, cint32_t maxTasks);
+
+    /**
+     * @brief Stop and join the workers. Protected against multiple calls.
+     *
+     */
+    void deinit(void);
+
+    /**
+     * @brief Run a job and wait for its completion. Not reentrant: fails
+     *        while a job runs, e.g. if called from a task, see isRunning().
+     *
+     * @param func Task function
+     * @param ctx Job context
+     * @param roots Tasks ready at start
+     * @param numRoots
+     * @param numTasks Total number of tasks to be executed, roots included
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t run(tAtomTaskFunc func, void *ctx, const int32_t *roots, cint32_t numRoots, cint32_t numTasks);
+
+    /**
+     * @brief Make a task ready, from within a task function
+     *
+     * @param worker Index of the calling worker
+     * @param task
+     */
+    void push(cint32_t worker, cint32_t task);
+
+    /**
+     * @brief Whether a job is running, i.e. run() would fail
+     *
+     * @return bool_t
+     */
+    bool_t isRunning(void) const { return m_Running.load(std::memory_order_acquire); };
+
+    /**
+     * @brief Get the number of threads, the calling thread included
+     *
+     * @return int32_t
+     */
+    int32_t getNumThreads(void) const { return m_NumThreads; };
+
+    /**
+     * @brief Get the parallel efficiency of the last job: the time spent in
+     *        tasks by all threads over the job duration times the number of
+     *        threads. 1 means all threads were busy all along.
+     *
+     * @return float32_t
+     */
+    float32_t getParallelEfficiency(void) const { return m_Efficiency; };
+
+protected:
+    static const uint32_t SPIN_ITERATIONS = 20000; // before parking, roughly 100us
+    static const uint32_t YIELD_PERIOD = 64;      // spins between yields, power of 2
+
+    typedef struct alignas(64)
+    {
+        CAtomTaskDeque deque;
+        std::atomic<int64_t> busyNs;
+    } tAtomWorker;
+
+    void workerLoop(cint32_t worker, cuint32_t generation);
+    void work(cint32_t worker, cuint32_t generation);
+    static void relax(cuint32_t spin);
+
+    std::vector<std::thread> m_Threads;
+    std::unique_ptr<tAtomWorker[]> m_Workers;
+    int32_t m_NumThreads = 0;
+
+    tAtomTaskFunc m_Func = nullptr;
+    void *m_Ctx = nullptr;
+    std::atomic<uint32_t> m_Generation{0};
+    std::atomic<int32_t> m_Remaining{0};
+    std::atomic<bool_t> m_Quit{false};
+    std::atomic<bool_t> m_Running{false};
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Cond;
+    std::atomic<int32_t> m_NumParked{0};
+
+    float32_t m_Efficiency = 0.F;
+};
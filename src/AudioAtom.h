@@ -2,10 +2,15 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <new>
 #include "AudioTypes.h"
+#include "AtomMemory.h"
+#include "AtomParamQueue.h"
+#include "DenormalGuard.h"
 
 #define SET_ALL_CH_IND (-1)
 #define SET_ALL_EL_IND (-1)
+#define DENORMAL_FLUSH_THRES (1.0E-15F) // approx -300dBFS
 
 class CQuarkProps
 {
@@ -39,6 +44,47 @@ public:
     ~CQuarkProps() {}
 };
 
+/**
+ * @brief Planar view of a block: one buffer per channel, see
+ *        CAtomInterleaved. Kernels templated on the view index samples as
+ *        ptr(ch, start)[i * step()], the step being 1 at compile time here.
+ */
+template <class T>
+class CAtomPlanar
+{
+public:
+    static constexpr bool_t PLANAR = true;
+
+    CAtomPlanar(T *const *buf) : m_Buf(buf){};
+
+    inline T *ptr(cint32_t ch, cint32_t start) const { return &m_Buf[ch][start]; }
+    inline int32_t step(void) const { return 1; }
+
+private:
+    T *const *m_Buf;
+};
+
+/**
+ * @brief Interleaved view of a block, frames of numCh samples, as handed
+ *        over by most audio backends and file codecs. Lets kernels work on
+ *        the frames directly, without a deinterleaving pass.
+ */
+template <class T>
+class CAtomInterleaved
+{
+public:
+    static constexpr bool_t PLANAR = false;
+
+    CAtomInterleaved(T *buf, cint32_t numCh) : m_Buf(buf), m_NumCh(numCh){};
+
+    inline T *ptr(cint32_t ch, cint32_t start) const { return &m_Buf[start * m_NumCh + ch]; }
+    inline int32_t step(void) const { return m_NumCh; }
+
+private:
+    T *m_Buf;
+    int32_t m_NumCh;
+};
+
 /**
  * @brief
  *
@@ -48,6 +94,285 @@ class CAudioQuark
 {
 protected:
     CQuarkProps m_Props;
+    int32_t m_NumFrames = 0; // frames of the current play(), up to m_Props.m_BlockSize
+    bool_t m_StateFlush = false;
+
+    uint8_t *m_Mem = NULL;
+    size_t m_MemSize = 0;
+    bool_t m_MemOwned = false;
+    CAtomArena *m_Arena = NULL;
+
+    CAtomParamQueue m_ParamQueue;
+    size_t m_ParamQueueSize = ATOM_PARAM_QUEUE_SIZE;
+    CAtomParamQueue::tAtomParamCell *m_ParamCells = NULL;
+    tAtomParamMsg *m_Events = NULL; // drained messages of the current block, by offset
+    int32_t m_NumEvents = 0;
+    int32_t m_NextEvent = 0;
+
+    bool_t m_InterleavedIo = false;
+    T **m_PlanarIn = NULL; // deinterleaving scratch of playInterleaved()
+    T **m_PlanarOut = NULL;
+
+    /**
+     * @brief Carve the atom arrays out of mem. Called twice by initMem(): once
+     *        to measure (mem.isCarving() is false) and once on the actual block.
+     *
+     * @param mem
+     */
+    virtual void layoutMem(CAtomMemLayout &mem){};
+
+    /**
+     * @brief Size the memory block from the current properties through
+     *        layoutMem(), allocate it (or reuse the current one if it fits),
+     *        zero it and carve it.
+     *
+     * @return int32_t 0 on success, -1 if the allocation failed
+     */
+    int32_t initMem(void)
+    {
+        CAtomMemLayout sizing;
+        layoutAll(sizing);
+        cint32_t retval = allocMem(sizing.getSize());
+        if (0 == retval)
+        {
+            if (m_MemSize > 0)
+                memset(m_Mem, 0, m_MemSize);
+            CAtomMemLayout mem(m_Mem);
+            layoutAll(mem);
+            m_ParamQueue.init(m_ParamCells, m_ParamQueueSize);
+        }
+        return retval;
+    };
+
+    /**
+     * @brief Same as initMem(), for new properties which are only kept if
+     *        the allocation succeeds. On failure the previous properties
+     *        are restored and re-carved on the untouched block, so the atom
+     *        keeps playing as before the call.
+     *
+     * @param props
+     * @return int32_t 0 on success, -1 if the allocation failed
+     */
+    int32_t initMem(const CQuarkProps &props)
+    {
+        const CQuarkProps prev = m_Props;
+        setProps(props);
+        if (0 != initMem())
+        {
+            setProps(prev);
+            CAtomMemLayout mem(m_Mem);
+            layoutAll(mem);
+            return -1;
+        }
+        return 0;
+    };
+
+    /**
+     * @brief Run the whole layout of the block: parameter queue, interleaving
+     *        scratch and atom arrays, in this order
+     *
+     * @param mem
+     */
+    void layoutAll(CAtomMemLayout &mem)
+    {
+        layoutParamQueue(mem);
+        layoutInterleaved(mem);
+        layoutMem(mem);
+    };
+
+    /**
+     * @brief Carve the cells of the parameter queue, ahead of the atom arrays
+     *
+     * @param mem
+     */
+    void layoutParamQueue(CAtomMemLayout &mem)
+    {
+        m_ParamCells = mem.take<CAtomParamQueue::tAtomParamCell>((int32_t)m_ParamQueueSize);
+        m_Events = mem.take<tAtomParamMsg>((int32_t)m_ParamQueueSize);
+        m_NumEvents = 0;
+        m_NextEvent = 0;
+    };
+
+    /**
+     * @brief Carve the deinterleaving scratch, if enabled, see
+     *        setInterleavedIo()
+     *
+     * @param mem
+     */
+    void layoutInterleaved(CAtomMemLayout &mem)
+    {
+        m_PlanarIn = NULL;
+        m_PlanarOut = NULL;
+        if (m_InterleavedIo)
+        {
+            cint32_t numIn = MAX(m_Props.m_NumChIn, 0);
+            cint32_t numOut = MAX(m_Props.m_NumChOut, 0);
+            m_PlanarIn = mem.take<T *>(numIn);
+            m_PlanarOut = mem.take<T *>(numOut);
+            T *buf = mem.take<T>((numIn + numOut) * m_Props.m_BlockSize);
+            if (mem.isCarving())
+            {
+                for (auto ch = 0; ch < numIn; ch++)
+                    m_PlanarIn[ch] = &buf[ch * m_Props.m_BlockSize];
+                for (auto ch = 0; ch < numOut; ch++)
+                    m_PlanarOut[ch] = &buf[(numIn + ch) * m_Props.m_BlockSize];
+            }
+        }
+    };
+
+    /**
+     * @brief Run frames(start, len) on each segment of the block, applying the
+     *        events in between, see playSegments()
+     *
+     * @param frames
+     */
+    template <class F>
+    void forEachSegment(F frames)
+    {
+        for (int32_t pos = 0; pos < m_NumFrames;)
+        {
+            cint32_t end = getSegmentEnd();
+            frames(pos, end - pos);
+            advance(end - pos);
+            pos = end;
+            applyParams(pos);
+        }
+    };
+
+    /**
+     * @brief Copy the frames [start, start + len) of in to the input scratch
+     *
+     * @param in
+     * @param start
+     * @param len
+     */
+    void deinterleave(const T *in, cint32_t start, cint32_t len)
+    {
+        cint32_t numCh = m_Props.m_NumChIn;
+        for (auto i = start; i < start + len; i++)
+        {
+            for (auto ch = 0; ch < numCh; ch++)
+                m_PlanarIn[ch][i] = in[i * numCh + ch];
+        }
+    };
+
+    /**
+     * @brief Copy the frames [start, start + len) of the output scratch to out
+     *
+     * @param out
+     * @param start
+     * @param len
+     */
+    void interleave(T *out, cint32_t start, cint32_t len)
+    {
+        cint32_t numCh = m_Props.m_NumChOut;
+        for (auto i = start; i < start + len; i++)
+        {
+            for (auto ch = 0; ch < numCh; ch++)
+                out[i * numCh + ch] = m_PlanarOut[ch][i];
+        }
+    };
+
+    /**
+     * @brief Enqueue a prepared message, see post()
+     *
+     * @param msg
+     * @return int32_t 0 on success, -1 if the queue is full
+     */
+    int32_t pushParam(const tAtomParamMsg &msg) { return m_ParamQueue.push(msg) ? 0 : -1; };
+
+    /**
+     * @brief Control thread side of a parameter change: validate it and do
+     *        the expensive math (coefficients, logarithms, ...) into msg
+     *
+     * @param ch
+     * @param el
+     * @param value
+     * @param msg
+     * @return bool_t false if the change is invalid
+     */
+    virtual bool_t prepareParam(cint32_t ch, cint32_t el, cfloat32_t value, tAtomParamMsg &msg) { return false; };
+
+    /**
+     * @brief Audio thread side of a parameter change: copy the prepared
+     *        values of msg into the targets
+     *
+     * @param msg
+     */
+    virtual void applyParam(const tAtomParamMsg &msg){};
+
+    /**
+     * @brief Called once after one or more messages were applied, e.g. to
+     *        start the morph towards the new targets
+     *
+     */
+    virtual void commitParams(void){};
+
+    /**
+     * @brief Make sure the memory block holds at least size bytes
+     *
+     * @param size
+     * @return int32_t 0 on success, -1 if the allocation failed
+     */
+    int32_t allocMem(const size_t size)
+    {
+        int32_t retval = 0;
+        if (size > m_MemSize)
+        {
+            uint8_t *mem;
+            if (NULL != m_Arena)
+                mem = m_Arena->alloc(size);
+            else
+                mem = static_cast<uint8_t *>(
+                    ::operator new(size, std::align_val_t(ATOM_MEM_ALIGN), std::nothrow));
+
+            if (NULL != mem)
+            {
+                freeMem();
+                m_Mem = mem;
+                m_MemSize = size;
+                m_MemOwned = (NULL == m_Arena);
+            }
+            else
+            {
+                retval = -1;
+            }
+        }
+        return retval;
+    };
+
+    /**
+     * @brief Release the memory block, if owned. Protected against multiple calls.
+     *
+     */
+    void freeMem(void)
+    {
+        if (NULL != m_Mem && m_MemOwned)
+            ::operator delete(m_Mem, std::align_val_t(ATOM_MEM_ALIGN));
+        m_Mem = NULL;
+        m_MemSize = 0;
+        m_MemOwned = false;
+    };
+
+    /**
+     * @brief Get the size of the memory block needed for given properties
+     *        and settings, without allocating. Backs the static
+     *        getMemRequirement() of each atom.
+     *
+     * @param props
+     * @param interleavedIo See setInterleavedIo()
+     * @param paramQueueSize See setParamQueueSize()
+     * @return size_t Size in bytes
+     */
+    size_t measureMem(const CQuarkProps &props, const bool_t interleavedIo, const size_t paramQueueSize)
+    {
+        setProps(props);
+        setInterleavedIo(interleavedIo);
+        setParamQueueSize(paramQueueSize);
+        CAtomMemLayout sizing;
+        layoutAll(sizing);
+        return sizing.getSize();
+    };
 
 public:
     /**
@@ -57,10 +382,13 @@ public:
     CAudioQuark(){};
 
     /**
-     * @brief Destroy the Audio Atom object
+     * @brief Destroy the Audio Atom object, releasing its memory block
      *
      */
-    ~CAudioQuark(){};
+    virtual ~CAudioQuark() { freeMem(); };
+
+    CAudioQuark(const CAudioQuark &) = delete;
+    CAudioQuark &operator=(const CAudioQuark &) = delete;
 
     /**
      * @brief
@@ -74,6 +402,38 @@ public:
         return 0;
     };
 
+    /**
+     * @brief Same as init(const CQuarkProps &), but taking the memory block
+     *        from arena instead of the heap. Once all atoms of a chain are
+     *        initialized this way, no heap calls happen while processing.
+     *        The arena must outlive the atom.
+     *
+     * @param props
+     * @param arena
+     * @return int32_t 0 on success, -1 on error (e.g. arena exhausted)
+     */
+    int32_t init(const CQuarkProps &props, CAtomArena &arena)
+    {
+        m_Arena = &arena;
+        cint32_t retval = init(props);
+        m_Arena = NULL;
+        return retval;
+    };
+
+    /**
+     * @brief Get the size of the memory block an atom needs for props. Each
+     *        atom with memory defines its own, to be summed up by the host
+     *        when sizing a CAtomArena. The settings must match the ones the
+     *        atom gets before its init().
+     *
+     * @param props
+     * @param interleavedIo See setInterleavedIo()
+     * @param paramQueueSize See setParamQueueSize()
+     * @return size_t Size in bytes
+     */
+    static size_t getMemRequirement(const CQuarkProps &props, const bool_t interleavedIo = false,
+                                    const size_t paramQueueSize = ATOM_PARAM_QUEUE_SIZE) { return 0; };
+
     /**
      * @brief
      *
@@ -82,6 +442,248 @@ public:
      */
     virtual void play(T **const in, T **const out) = 0;
 
+    /**
+     * @brief Process the output channels [chBegin, chEnd) of the samples
+     *        [start, start + len) of the current block only. Slices of one
+     *        segment may run concurrently on disjoint channel ranges; once all
+     *        of them completed, advance(len) is called once. Only atoms whose
+     *        channels are independent support it, see isSliceable().
+     *
+     * @param in
+     * @param out
+     * @param chBegin
+     * @param chEnd
+     * @param start First sample
+     * @param len Number of samples
+     */
+    virtual void playSlice(T **const in, T **const out, cint32_t chBegin, cint32_t chEnd,
+                           cint32_t start, cint32_t len){};
+
+    /**
+     * @brief Process the samples [start, start + len) of all channels, see
+     *        playSegments()
+     *
+     * @param in
+     * @param out
+     * @param start First sample
+     * @param len Number of samples
+     */
+    virtual void playFrames(T **const in, T **const out, cint32_t start, cint32_t len)
+    {
+        playSlice(in, out, 0, m_Props.m_NumChOut, start, len);
+    };
+
+    /**
+     * @brief Advance the time dependent state (e.g. morph counters) by len
+     *        samples, after all slices of a segment were played
+     *
+     * @param len Number of samples
+     */
+    virtual void advance(cint32_t len){};
+
+    /**
+     * @brief Whether the atom supports playSlice()
+     *
+     * @return bool_t
+     */
+    virtual bool_t isSliceable(void) const { return false; };
+
+    /**
+     * @brief Whether play() (and playSlice()) may be called in-place, i.e.
+     *        with in[ch] == out[ch] for the channels both sides have. Other
+     *        channels must never alias. Atoms that are in-place let hosts
+     *        reuse a buffer instead of allocating an output and copying,
+     *        see CAtomGraph. Without it, in and out must not overlap at all.
+     *
+     * @return bool_t
+     */
+    virtual bool_t isInPlace(void) const { return false; };
+
+    /**
+     * @brief Sample accurate play(): the block is split at the offsets of
+     *        the posted events (see post()), which are applied right before
+     *        their sample. Between events, playFrames() and advance() are
+     *        called on the segment.
+     *
+     * @param in
+     * @param out
+     */
+    void playSegments(T **const in, T **const out)
+    {
+        drainParams();
+        playDrained(in, out);
+    };
+
+    /**
+     * @brief Second half of playSegments(), for hosts that called
+     *        drainParams() themselves, e.g. to inspect the pending events
+     *
+     * @param in
+     * @param out
+     */
+    void playDrained(T **const in, T **const out)
+    {
+        forEachSegment([&](cint32_t start, cint32_t len)
+                       { playFrames(in, out, start, len); });
+    };
+
+    /**
+     * @brief Process interleaved frames, numChIn samples per input frame and
+     *        numChOut per output frame. in and out may be the same buffer if
+     *        the atom is in-place (and has as many inputs as outputs).
+     *
+     *        Atoms with interleaved kernels run them directly on the frames,
+     *        see playSegmentsInterleaved(). The others deinterleave into a
+     *        scratch that has to be reserved with setInterleavedIo() before
+     *        init(), and mute without it.
+     *
+     * @param in
+     * @param out
+     */
+    virtual void playInterleaved(const T *in, T *out)
+    {
+        if (NULL != out && NULL != in && NULL != m_PlanarIn)
+        {
+            deinterleave(in, 0, m_NumFrames);
+            play(m_PlanarIn, m_PlanarOut);
+            interleave(out, 0, m_NumFrames);
+        }
+        else if (NULL != out)
+        {
+            memset(out, 0, sizeof(T) * m_Props.m_NumChOut * m_NumFrames);
+        }
+    };
+
+    /**
+     * @brief Interleaved counterpart of playFrames(). Atoms with interleaved
+     *        kernels override it, the default goes through the scratch of
+     *        setInterleavedIo().
+     *
+     * @param in
+     * @param out
+     * @param start First frame
+     * @param len Number of frames
+     */
+    virtual void playFramesInterleaved(const T *in, T *out, cint32_t start, cint32_t len)
+    {
+        if (NULL != m_PlanarIn)
+        {
+            deinterleave(in, start, len);
+            playFrames(m_PlanarIn, m_PlanarOut, start, len);
+            interleave(out, start, len);
+        }
+    };
+
+    /**
+     * @brief Interleaved counterpart of playSegments()
+     *
+     * @param in
+     * @param out
+     */
+    void playSegmentsInterleaved(const T *in, T *out)
+    {
+        drainParams();
+        playDrainedInterleaved(in, out);
+    };
+
+    /**
+     * @brief Interleaved counterpart of playDrained()
+     *
+     * @param in
+     * @param out
+     */
+    void playDrainedInterleaved(const T *in, T *out)
+    {
+        forEachSegment([&](cint32_t start, cint32_t len)
+                       { playFramesInterleaved(in, out, start, len); });
+    };
+
+    /**
+     * @brief Reserve the deinterleaving scratch of playInterleaved(), for
+     *        atoms without interleaved kernels. To be called before init().
+     *
+     * @param enable
+     */
+    void setInterleavedIo(const bool_t enable) { m_InterleavedIo = enable; };
+
+    /**
+     * @brief Processing entry point for hosts. Runs play() with denormals
+     *        flushed to zero (see CDenormalGuard), so decaying tails do not
+     *        fall into the slow denormal range.
+     *
+     * @param in
+     * @param out
+     */
+    void process(T **const in, T **const out)
+    {
+        CDenormalGuard guard;
+        play(in, out);
+    };
+
+    /**
+     * @brief Process only the first nframes of the buffers, for hosts whose
+     *        callback size varies. m_BlockSize is then the maximum number of
+     *        frames, the atom is not reinitialized and morphs keep their
+     *        duration in samples. Events posted beyond nframes are applied at
+     *        its last frame.
+     *
+     * @param in
+     * @param out
+     * @param nframes Number of frames, up to m_BlockSize. Nothing is done
+     *        below 1.
+     */
+    void play(T **const in, T **const out, cint32_t nframes)
+    {
+        if (nframes > 0)
+        {
+            setNumFrames(nframes);
+            play(in, out);
+            setNumFrames(m_Props.m_BlockSize);
+        }
+    };
+
+    /**
+     * @brief Same as play(in, out, nframes), on interleaved frames
+     *
+     * @param in
+     * @param out
+     * @param nframes
+     */
+    void playInterleaved(const T *in, T *out, cint32_t nframes)
+    {
+        if (nframes > 0)
+        {
+            setNumFrames(nframes);
+            playInterleaved(in, out);
+            setNumFrames(m_Props.m_BlockSize);
+        }
+    };
+
+    /**
+     * @brief Same as process(), on the first nframes, see play(in, out, nframes)
+     *
+     * @param in
+     * @param out
+     * @param nframes
+     */
+    void process(T **const in, T **const out, cint32_t nframes)
+    {
+        CDenormalGuard guard;
+        play(in, out, nframes);
+    };
+
+    /**
+     * @brief Same as process(), on interleaved frames, see playInterleaved()
+     *
+     * @param in
+     * @param out
+     */
+    void processInterleaved(const T *in, T *out)
+    {
+        CDenormalGuard guard;
+        playInterleaved(in, out);
+    };
+
     /**
      * @brief
      *
@@ -93,7 +695,7 @@ public:
         {
             for (int32_t ch = 0; ch < m_Props.m_NumChOut; ch++)
             {
-                for (int32_t i = 0; i < m_Props.m_BlockSize; i++)
+                for (int32_t i = 0; i < m_NumFrames; i++)
                     out[ch][i] = static_cast<T>(0);
             }
         }
@@ -115,15 +717,18 @@ public:
             }
             else
             {
-                int32_t ind_max = MAX(m_Props.m_NumChOut, m_Props.m_NumChIn);
+                int32_t ind_max = MIN(m_Props.m_NumChOut, m_Props.m_NumChIn);
                 for (int32_t ch = 0; ch < ind_max; ch++)
                 {
-                    for (int32_t i = 0; i < m_Props.m_BlockSize; i++)
-                        out[ch][i] = in[ch][i];
+                    if (in[ch] != out[ch])
+                    {
+                        for (int32_t i = 0; i < m_NumFrames; i++)
+                            out[ch][i] = in[ch][i];
+                    }
                 }
                 for (int32_t ch = ind_max; ch < m_Props.m_NumChOut; ch++)
                 {
-                    for (int32_t i = 0; i < m_Props.m_BlockSize; i++)
+                    for (int32_t i = 0; i < m_NumFrames; i++)
                         out[ch][i] = static_cast<T>(0);
                 }
             }
@@ -156,6 +761,100 @@ public:
      */
     virtual void set(void *params, cint32_t len){};
 
+    /**
+     * @brief Post a parameter change from a control thread, to be applied in
+     *        the next play() at sample offset (see playSegments()). Unlike
+     *        set(), it is safe to call while the audio thread is processing.
+     *        Never blocks, neither the caller nor the audio thread.
+     *
+     * @param ch
+     * @param el
+     * @param value
+     * @param offset Sample offset in the next block, clipped to the block
+     * @return int32_t 0 on success, -1 if the change is invalid or the queue is full
+     */
+    virtual int32_t post(cint32_t ch, cint32_t el, cfloat32_t value, cint32_t offset = 0)
+    {
+        tAtomParamMsg msg;
+        if (!prepareParam(ch, el, value, msg))
+            return -1;
+        msg.offset = offset;
+        return pushParam(msg);
+    };
+
+    /**
+     * @brief Post a parameter structure, see post() and set(void *, cint32_t)
+     *
+     * @param params
+     * @param len
+     * @param offset Sample offset in the next block, clipped to the block
+     * @return int32_t 0 on success, -1 if a change is invalid or the queue is full
+     */
+    virtual int32_t post(void *params, cint32_t len, cint32_t offset = 0) { return -1; };
+
+    /**
+     * @brief Move the posted messages to the events of the current block,
+     *        sorted by offset, and apply the ones at offset 0. Start of a block
+     *        for hosts driving playSlice() themselves, see playSegments().
+     *        Audio thread only.
+     *
+     */
+    void drainParams(void)
+    {
+        tAtomParamMsg msg;
+        m_NumEvents = 0;
+        m_NextEvent = 0;
+        while ((size_t)m_NumEvents < m_ParamQueueSize && m_ParamQueue.pop(msg))
+        {
+            // insertion sort, stable for equal offsets
+            msg.offset = CLIP(msg.offset, 0, m_NumFrames - 1);
+            int32_t ind = m_NumEvents++;
+            while (ind > 0 && m_Events[ind - 1].offset > msg.offset)
+            {
+                m_Events[ind] = m_Events[ind - 1];
+                ind--;
+            }
+            m_Events[ind] = msg;
+        }
+        applyParams(0);
+    };
+
+    /**
+     * @brief Get the end of the current segment: the offset of the next
+     *        pending event, or the number of frames of the block
+     *
+     * @return int32_t
+     */
+    int32_t getSegmentEnd(void) const
+    {
+        return (m_NextEvent < m_NumEvents) ? m_Events[m_NextEvent].offset : m_NumFrames;
+    };
+
+    /**
+     * @brief Apply the pending events up to offset pos
+     *
+     * @param pos
+     */
+    void applyParams(cint32_t pos)
+    {
+        bool_t applied = false;
+        while (m_NextEvent < m_NumEvents && m_Events[m_NextEvent].offset <= pos)
+        {
+            applyParam(m_Events[m_NextEvent++]);
+            applied = true;
+        }
+        if (applied)
+            commitParams();
+    };
+
+    /**
+     * @brief Set the capacity of the parameter queue, taking effect at the
+     *        next init(). 0 disables post().
+     *
+     * @param size Number of messages, rounded up to a power of 2
+     */
+    void setParamQueueSize(const size_t size) { m_ParamQueueSize = CAtomParamQueue::roundSize(size); };
+
     /**
      * @brief Get the object properties
      *
@@ -168,43 +867,136 @@ public:
      *
      * @param props
      */
-    void setProps(const CQuarkProps &props) { m_Props = props; };
+    void setProps(const CQuarkProps &props)
+    {
+        m_Props = props;
+        m_NumFrames = props.m_BlockSize;
+    };
+
+    /**
+     * @brief Set the number of frames of the next play() calls, clipped to
+     *        [1, m_BlockSize]. Used by play(in, out, nframes) and by containers
+     *        forwarding it to their atoms.
+     *
+     * @param nframes
+     */
+    void setNumFrames(cint32_t nframes) { m_NumFrames = CLIP(nframes, 1, m_Props.m_BlockSize); };
+
+    /**
+     * @brief Get the number of frames of the current play()
+     *
+     * @return int32_t
+     */
+    int32_t getNumFrames(void) const { return m_NumFrames; };
+
+    /**
+     * @brief Opt-in flushing of recursive states below DENORMAL_FLUSH_THRES
+     *        at the end of each block. Only atoms with internal states act on it.
+     *
+     * @param enable
+     */
+    void setStateFlush(const bool_t enable) { m_StateFlush = enable; };
 };
 
 template <class T>
 class CAudioQuarkLinearMorph : public CAudioQuark<T>
 {
 public:
+    /**
+     * @brief Set the morph time, rounded down to whole blocks
+     *
+     * @param morphTimeMs
+     */
     void setMorphMs(const float32_t morphTimeMs)
     {
-        m_MorphBlocksizeTotal = 0;
-        m_MorphBlocksizeMs = 0.F;
+        int32_t numSamples = 0;
         if (morphTimeMs > 0.F)
         {
             float32_t blockMs = 1000.F * (m_Props.m_BlockSize / (float32_t)m_Props.m_Fs);
             int32_t numBlocks = (int32_t)(morphTimeMs / blockMs);
 
             if (numBlocks > 0)
-            {
-                m_MorphBlocksizeTotal = numBlocks;
-                m_MorphBlocksizeMs = numBlocks * blockMs;
-            }
+                numSamples = numBlocks * m_Props.m_BlockSize;
         }
 
-        m_MorphBlocksizeCnt = 0;
+        setMorphSamples(numSamples);
+    }
+
+    /**
+     * @brief Set the morph time in samples, to the exact sample. Morphs may
+     *        then start and end within a block, see playSegments().
+     *
+     * @param numSamples
+     */
+    void setMorphSamples(cint32_t numSamples)
+    {
+        m_MorphSamplesTotal = MAX(numSamples, 0);
+        m_MorphMs = 1000.F * m_MorphSamplesTotal / (float32_t)m_Props.m_Fs;
+        m_MorphSamplesCnt = 0;
 
         calculateDeltas();
     }
 
     void startMorph(void)
     {
-        m_MorphBlocksizeCnt = m_MorphBlocksizeTotal;
+        m_MorphSamplesCnt = m_MorphSamplesTotal;
+    }
+
+    /**
+     * @brief Whether a morph is in progress
+     *
+     * @return bool_t
+     */
+    bool_t isMorphing(void) const
+    {
+        return m_MorphSamplesCnt > 0;
+    }
+
+    /**
+     * @brief Count down the morph, see CAudioQuark::advance()
+     *
+     * @param len
+     */
+    void advance(cint32_t len) override
+    {
+        if (m_MorphSamplesCnt > 0)
+        {
+            m_MorphSamplesCnt -= len;
+            if (m_MorphSamplesCnt <= 0)
+            {
+                m_MorphSamplesCnt = 0;
+                endMorph();
+            }
+        }
     }
 
 protected:
+    using CAudioQuark<T>::m_Props;
+    using CAudioQuark<T>::m_StateFlush;
+
     virtual void calculateDeltas(void) = 0;
 
-    int32_t m_MorphBlocksizeCnt = 0;
-    int32_t m_MorphBlocksizeTotal = 0;
-    float32_t m_MorphBlocksizeMs = 0.F;
+    /**
+     * @brief Snap the morphed values to their targets, called by advance()
+     *        once the morph is over
+     *
+     */
+    virtual void endMorph(void){};
+
+    /**
+     * @brief Number of samples of a segment of len samples that still morph.
+     *        Kernels ramp over these and snap the channel to its targets for
+     *        the rest of the segment.
+     *
+     * @param len
+     * @return int32_t
+     */
+    inline int32_t getNumMorphSamples(cint32_t len) const
+    {
+        return MIN(len, m_MorphSamplesCnt);
+    }
+
+    int32_t m_MorphSamplesCnt = 0;
+    int32_t m_MorphSamplesTotal = 0;
+    float32_t m_MorphMs = 0.F;
 };
@@ -25,6 +25,7 @@
 #endif
 
 #define MUTE_DB_FS (-140.0F)
+#define SILENCE_ENERGY (1.0E-24F) // approx -240dBFS, well above the denormal range
 
 // Types
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "AudioTypes.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DENORMAL_GUARD_SSE
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define DENORMAL_GUARD_AARCH64
+#elif defined(__arm__) && defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))
+#define DENORMAL_GUARD_ARM
+#endif
+
+/**
+ * @brief RAII scope that makes the FPU flush denormals to zero. On x86 the
+ *        FTZ and DAZ bits of MXCSR are set, on ARM the FZ bit of FPCR/FPSCR.
+ *        The previous control word is restored on destruction, so the guard
+ *        can be nested and does not leak its mode into the host thread.
+ *        On other targets it is a no-op (see isSupported()).
+ */
+class CDenormalGuard
+{
+public:
+    /**
+     * @brief Construct a new CDenormalGuard object and enable flush to zero
+     *
+     */
+    CDenormalGuard()
+    {
+#if defined(DENORMAL_GUARD_SSE)
+        m_State = _mm_getcsr();
+        _mm_setcsr(m_State | CSR_FTZ | CSR_DAZ);
+#elif defined(DENORMAL_GUARD_AARCH64)
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        m_State = fpcr;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | CSR_FZ));
+#elif defined(DENORMAL_GUARD_ARM)
+        uint32_t fpscr;
+        __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+        m_State = fpscr;
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr | CSR_FZ));
+#endif
+    }
+
+    /**
+     * @brief Destroy the CDenormalGuard object, restoring the previous mode
+     *
+     */
+    ~CDenormalGuard()
+    {
+#if defined(DENORMAL_GUARD_SSE)
+        _mm_setcsr(m_State);
+#elif defined(DENORMAL_GUARD_AARCH64)
+        uint64_t fpcr = m_State;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#elif defined(DENORMAL_GUARD_ARM)
+        uint32_t fpscr = m_State;
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr));
+#endif
+    }
+
+    CDenormalGuard(const CDenormalGuard &) = delete;
+    CDenormalGuard &operator=(const CDenormalGuard &) = delete;
+
+    /**
+     * @brief Whether the guard actually changes the FPU mode on this target
+     *
+     * @return bool_t
+     */
+    static constexpr bool_t isSupported(void)
+    {
+#if defined(DENORMAL_GUARD_SSE) || defined(DENORMAL_GUARD_AARCH64) || defined(DENORMAL_GUARD_ARM)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+#if defined(DENORMAL_GUARD_SSE)
+    static constexpr uint32_t CSR_FTZ = 0x8000U;
+    static constexpr uint32_t CSR_DAZ = 0x0040U;
+    uint32_t m_State;
+#elif defined(DENORMAL_GUARD_AARCH64)
+    static constexpr uint64_t CSR_FZ = 1ULL << 24U;
+    uint64_t m_State;
+#elif defined(DENORMAL_GUARD_ARM)
+    static constexpr uint32_t CSR_FZ = 1U << 24U;
+    uint32_t m_State;
+#endif
+};
@@ -13,7 +13,7 @@ private:
      * 
      * @return bool_t 
      */
-    bool_t checkFactor(int32_t);
+    static bool_t checkFactor(int32_t);
 public:
     /**
      * @brief Construct a new CResampler object. It is empty, as the one from 
@@ -50,6 +50,18 @@ public:
      * @return int32_t number of samples per block
      */
     int32_t getBlocksize(void) { return m_Blocksize; };
+
+    /**
+     * @brief Whether init() with these factors resamples, rather than bypass
+     * 
+     * @param us_factor 
+     * @param ds_factor 
+     * @return bool_t 
+     */
+    static bool_t isSupported(int32_t us_factor, int32_t ds_factor)
+    {
+        return checkFactor(us_factor) && checkFactor(ds_factor) && (us_factor > 1 || ds_factor > 1);
+    };
 };
 
 
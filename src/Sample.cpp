@@ -3,68 +3,46 @@
 #include <iostream>
 #include <algorithm>
 #include <math.h>
-#include <sndfile.h>
+#include <string.h>
+
+namespace
+{
+    inline float32_t toFloat(cint16_t sample) { return int16ToFloat(sample); }
+    inline float32_t toFloat(cfloat32_t sample) { return sample; }
+}
 
 CSample::CSample(CSampleParams const& params, cint32_t us, cint32_t ds)
 {
     // initialize everyone to default first of all, in case things go weird
     setDefaultValues();
     
-    // proceed to WAV file...
-    SF_INFO info;
-    SNDFILE* const sndfile = sf_open(params.path.c_str(), SFM_READ, &info);
-    if (!sndfile || !info.frames || (info.channels != 1) || info.samplerate != params.fs) 
+    // proceed to cache or WAV file...
+    auto asset = std::make_shared<CSampleAsset>();
+    if (0 == asset->init(params))
     {
-        std::cerr << "Failed to open sample " << params.path << std::endl;
-        sf_close(sndfile);
-    }
-    else
-    {
-        // Read data
-        float32_t * const data = new float32_t[info.frames];
-        if (!data) 
-        {
-            std::cerr << "Failed to allocate memory for sample" << std::endl;
-            sf_close(sndfile);
-        }
-        else
-        {
-            sf_seek(sndfile, 0ul, SEEK_SET);
-            sf_read_float(sndfile, data, info.frames);
-            sf_close(sndfile);
-            //std::cout << "Adding sample from " << params.path << std::endl;
-            m_Buffer.resize(info.frames);
-            m_PBuffer = &m_Buffer;
-            for(int32_t i = 0; i < info.frames; i++)
-            {
-                float32_t sample = data[i];
-                if( sample > 0.0F )
-                    m_Buffer[i] = (int16_t)( ((float32_t)INT16_MAX * sample) + 0.5F );
-                else
-                    m_Buffer[i] = (int16_t)( ((float32_t)INT16_MIN * -sample) - 0.5F );
-            }
-
-            m_ShouldAppend = params.append;
-
-            // override some default values for class members
-            m_LoKey = params.lokey;
-            m_HiKey = params.hikey;
-            m_LoVel = params.lovel;
-            m_HiVel = params.hivel;
-            m_AmpVelTrack = params.ampveltrack;
-            m_Fs = params.fs;
-
-            CADSR adsr;
-            adsr.att_s = params.attack_s;
-            adsr.rel_s = params.release_s;
-            adsr.dec_s = params.decay_s;
-            adsr.sus_lvl = params.decay_gain;
-            setADSR(adsr);
-
-            m_Resampler.init(us, ds, 0);
-            //setBlocksize(m_ResamplerBlocksize, true);
-            delete data;
-        }
+        m_Asset = asset;
+        m_PAsset = asset.get();
+        m_ShouldAppend = params.append;
+
+        // override some default values for class members
+        m_LoKey = params.lokey;
+        m_HiKey = params.hikey;
+        m_LoVel = params.lovel;
+        m_HiVel = params.hivel;
+        m_AmpVelTrack = params.ampveltrack;
+        m_SeqLength = std::max(params.seq_length, 1);
+        m_SeqPosition = std::min(std::max(params.seq_position, 1), m_SeqLength);
+        m_Fs = params.fs;
+
+        CADSR adsr;
+        adsr.att_s = params.attack_s;
+        adsr.rel_s = params.release_s;
+        adsr.dec_s = params.decay_s;
+        adsr.sus_lvl = params.decay_gain;
+        setADSR(adsr);
+
+        setFactors(us, ds);
+        addResampler(us, ds);
     }
 }
 
@@ -81,14 +59,54 @@ CSample::CSample(CSample const& sample, cint32_t lokey, cint32_t hikey, cint32_t
     m_LoVel = sample.m_LoVel;
     m_HiVel = sample.m_HiVel;
     m_AmpVelTrack = sample.m_AmpVelTrack;
+    m_SeqLength = sample.m_SeqLength;
+    m_SeqPosition = sample.m_SeqPosition;
     m_Fs = sample.m_Fs;
 
     m_StatesADSRNew = sample.m_StatesADSRNew;
     m_StatesADSR = sample.m_StatesADSR;
 
-    m_Buffer.resize(0);
-    m_PBuffer = sample.m_PBuffer;
-    m_Resampler.init(us, ds, 0);
+    m_Asset = sample.m_Asset;
+    m_PAsset = sample.m_PAsset;
+    setFactors(us, ds);
+}
+
+void CSampleVoice::addResampler(cint32_t us, cint32_t ds)
+{
+    if (!CResampler::isSupported(us, ds) || NULL != getResampler(us, ds))
+        return;
+
+    std::unique_ptr<tResampler> resampler(new tResampler());
+    resampler->us = us;
+    resampler->ds = ds;
+    resampler->resampler.init(us, ds, 0);
+    resampler->lenInSeqCnt = 0;
+    m_Resamplers.push_back(std::move(resampler));
+}
+
+CSampleVoice::tResampler *CSampleVoice::getResampler(cint32_t us, cint32_t ds) const
+{
+    for (auto &resampler : m_Resamplers)
+    {
+        if (resampler->us == us && resampler->ds == ds)
+            return resampler.get();
+    }
+    return NULL;
+}
+
+void CSample::setFactors(cint32_t us, cint32_t ds)
+{
+    // unsupported factors play as is
+    const bool_t supported = CResampler::isSupported(us, ds);
+    m_UsFactor = supported ? us : 1;
+    m_DsFactor = supported ? ds : 1;
+    m_Resampler = m_Voice.getResampler(m_UsFactor, m_DsFactor);
+}
+
+void CSample::addResampler(cint32_t us, cint32_t ds)
+{
+    m_Voice.addResampler(us, ds);
+    m_Resampler = m_Voice.getResampler(m_UsFactor, m_DsFactor);
 }
 
 float32_t CSample::samplesToFactor(cint32_t samples, cfloat32_t delta, cfloat32_t fallback)
@@ -120,13 +138,15 @@ int32_t CSample::secondsToSamples(float32_t secs)
 
 void CSample::setDefaultValues(void) 
 {
-    m_LenInSeq = {0};
-    m_LenInSeqCnt = 0;
+    m_UsFactor = 1;
+    m_DsFactor = 1;
     m_LoKey = 0;
     m_HiKey = 0;
     m_LoVel = 0;
     m_HiVel = 0;
     m_AmpVelTrack = 0;
+    m_SeqLength = 1;
+    m_SeqPosition = 1;
     m_Fs = 48000;
     m_CurrInd = 0;
     m_SamplesCnt = 0;
@@ -148,12 +168,14 @@ void CSample::setDefaultValues(void)
     m_ShouldAppend = true;
 }
 
-int32_t CSample::getNumSamplesUntilFinished(void) 
+int32_t CSample::getNumSamplesUntilFinished(void) const
 {
     int32_t retval = m_StatesADSR.num_smp - m_CurrInd;
     // If the sample has finished earlier for some reason (for example: note turned off)
     if (m_State == FINISHED)
         retval = 0;
+    else if (m_Looping && !isReleasing())
+        retval = INT32_MAX;
 
     return retval;
 }
@@ -163,7 +185,7 @@ int32_t CSample::processBlockAttack(float32_t * const p_blkout, cint32_t blocksi
     int32_t bs = std::min(blocksize, m_StatesADSR.att_smp - m_SamplesCnt);
     processBlock(p_blkout, m_StatesADSR.att_fac, 1.0F, bs);
 
-    if( m_CurrInd >= (*m_PBuffer).size())
+    if( m_CurrInd >= m_PAsset->getNumFrames())
     {
         m_SamplesCnt = 0;
         m_Gain = 0.0F;
@@ -201,7 +223,7 @@ int32_t CSample::processBlockDecay(float32_t * const p_blkout, cint32_t blocksiz
 {
     int32_t bs = std::min(blocksize, m_StatesADSR.dec_smp - m_SamplesCnt);
     processBlock(p_blkout, m_StatesADSR.dec_fac, m_StatesADSR.sus_lvl, bs);
-    if( m_CurrInd >= (*m_PBuffer).size())
+    if( m_CurrInd >= m_PAsset->getNumFrames())
     {
         m_SamplesCnt = 0;
         m_Gain = 0.0F;
@@ -236,10 +258,13 @@ int32_t CSample::processBlockDecay(float32_t * const p_blkout, cint32_t blocksiz
 
 int32_t CSample::processBlockSustain(float32_t * const p_blkout, cint32_t blocksize) 
 {
+    // looped samples sustain until off()
+    if (m_Looping)
+        m_SamplesCnt = 0;
     int32_t bs = std::min(blocksize, m_StatesADSR.sus_smp - m_SamplesCnt);
     processBlock(p_blkout, 1.0F, 0.0F, bs);
 
-    if( m_CurrInd >= (*m_PBuffer).size())
+    if( m_CurrInd >= m_PAsset->getNumFrames())
     {
         m_SamplesCnt = 0;
         m_Gain = 0.0F;
@@ -272,7 +297,7 @@ int32_t CSample::processBlockRelease(float32_t * const p_blkout, cint32_t blocks
     int32_t bs = std::min(blocksize, m_StatesADSR.rel_smp - m_SamplesCnt);
     processBlock(p_blkout, m_StatesADSR.rel_fac, 0.0F, bs);
 
-    if( m_CurrInd >= (*m_PBuffer).size())
+    if( m_CurrInd >= m_PAsset->getNumFrames())
     {
         m_SamplesCnt = 0;
         m_Gain = 0.0F;
@@ -300,7 +325,7 @@ int32_t CSample::processBlockFadeout(float32_t * const p_blkout, cint32_t blocks
     int32_t bs = std::min(blocksize, m_FadeoutSmp - m_SamplesCnt);
     processBlock(p_blkout, m_FadeoutFac, 0.0F, bs);
 
-    if( m_CurrInd >= (*m_PBuffer).size() 
+    if( m_CurrInd >= m_PAsset->getNumFrames() 
         ||  m_SamplesCnt >= m_FadeoutSmp )
     {
         m_SamplesCnt = 0;
@@ -314,80 +339,204 @@ int32_t CSample::processBlockFadeout(float32_t * const p_blkout, cint32_t blocks
 void CSample::processBlock(float32_t * const p_blkout, cfloat32_t factor, cfloat32_t target, 
     cint32_t blocksize) 
 {
-    int16_t *p_blkin = &(*m_PBuffer)[m_CurrInd];
-    cfloat32_t factor_minus1 =  (1.0F - factor);
+    // split the block at the crossfade and the loop end, where the playhead wraps
+    cint32_t loopEnd = m_PAsset->getLoopEnd();
+    cint32_t xfadeStart = loopEnd - m_PAsset->getXfadeLen();
+    for (auto offset = 0; offset < blocksize;)
+    {
+        if (m_Looping && isReleasing() && m_CurrInd < xfadeStart)
+            m_Looping = false; // released, play on past the loop end
+
+        int32_t len = blocksize - offset;
+        if (m_Looping && m_CurrInd < xfadeStart)
+            len = std::min(len, xfadeStart - m_CurrInd);
+        else if (m_Looping)
+            len = std::min(len, loopEnd - m_CurrInd);
+
+        if (m_Looping && m_CurrInd >= xfadeStart)
+            processSamples(&m_PAsset->getXfade()[m_CurrInd - xfadeStart], &p_blkout[offset], factor, target, len);
+        else
+            processFrames(&p_blkout[offset], factor, target, len);
 
-    if(m_ShouldAppend)
+        m_CurrInd += len;
+        if (m_Looping && m_CurrInd == loopEnd)
+            m_CurrInd = m_PAsset->getLoopStart();
+        offset += len;
+    }
+    m_SamplesCnt += blocksize;
+}
+
+void CSample::processFrames(float32_t * const p_blkout, cfloat32_t factor, cfloat32_t target, 
+    cint32_t blocksize) 
+{
+    const int16_t *data = m_PAsset->getData();
+    if (NULL != m_PAsset->getStore())
     {
-        for(auto i = 0; i < blocksize; i++)
+        // other storage formats: decode, chunk by chunk
+        float32_t chunk[256];
+        for (auto offset = 0; offset < blocksize; offset += 256)
         {
-            cint16_t samplei16 = p_blkin[i];
-            // += since each sample is added to the polyphony
-            cfloat32_t neg = ((uint16_t)samplei16 & 0x8000U) >> 15U;
-            cfloat32_t pos = !neg;
-
-            float32_t sample = pos * (float32_t)p_blkin[i] / (float32_t)INT16_MAX + 
-                            neg * (float32_t)p_blkin[i] / ((float32_t)-INT16_MIN);
-            p_blkout[i] += sample * m_Gain;
-            m_Gain = factor * m_Gain + factor_minus1 * target;
+            cint32_t len = std::min(blocksize - offset, 256);
+            fetch(chunk, m_CurrInd + offset, len);
+            processSamples(chunk, &p_blkout[offset], factor, target, len);
         }
     }
+    else if (NULL != data && m_CurrInd + blocksize <= m_PAsset->getHeadLen())
+    {
+        processSamples(&data[m_CurrInd], p_blkout, factor, target, blocksize);
+    }
     else
     {
-        for(auto i = 0; i < blocksize; i++)
+        // compressed or past the head: gather the frames, chunk by chunk
+        int16_t chunk[256];
+        for (auto offset = 0; offset < blocksize; offset += 256)
         {
-            cint16_t samplei16 = p_blkin[i];
-            // += since each sample is added to the polyphony
-            cfloat32_t neg = ((uint16_t)samplei16 & 0x8000U) >> 15U;
-            cfloat32_t pos = !neg;
-
-            float32_t sample = pos * (float32_t)p_blkin[i] / (float32_t)INT16_MAX + 
-                            neg * (float32_t)p_blkin[i] / ((float32_t)-INT16_MIN);
-            p_blkout[i] = sample * m_Gain;
-            m_Gain = factor * m_Gain + factor_minus1 * target;
+            cint32_t len = std::min(blocksize - offset, 256);
+            fetch(chunk, m_CurrInd + offset, len);
+            processSamples(chunk, &p_blkout[offset], factor, target, len);
         }
     }
-    
-    m_SamplesCnt += blocksize;
-    m_CurrInd += blocksize;
+}
+
+void CSample::fetch(int16_t * const dst, cint32_t pos, cint32_t len)
+{
+    cint32_t head = CLIP(m_PAsset->getHeadLen() - pos, 0, len);
+    if (head > 0 && NULL != m_PAsset->getCodec())
+        decode(dst, pos, head);
+    else if (head > 0)
+        memcpy(dst, &m_PAsset->getData()[pos], head * sizeof(int16_t));
+    if (head < len)
+    {
+        if (NULL != m_Stream)
+            m_Stream->read(&dst[head], pos + head, len - head);
+        else
+            memset(&dst[head], 0, (len - head) * sizeof(int16_t));
+    }
+}
+
+void CSample::decode(int16_t * const dst, cint32_t pos, cint32_t len)
+{
+    for (auto offset = 0; offset < len;)
+    {
+        cint32_t block = (pos + offset) / CSampleCodec::BLOCK;
+        if (block != m_Voice.m_DecodedBlock)
+        {
+            m_PAsset->getCodec()->decode(block, m_Voice.m_Decoded);
+            m_Voice.m_DecodedBlock = block;
+        }
+        cint32_t start = (pos + offset) - block * CSampleCodec::BLOCK;
+        cint32_t n = std::min(len - offset, CSampleCodec::BLOCK - start);
+        memcpy(&dst[offset], &m_Voice.m_Decoded[start], n * sizeof(int16_t));
+        offset += n;
+    }
+}
+
+void CSample::fetch(float32_t * const dst, cint32_t pos, cint32_t len)
+{
+    cint32_t head = CLIP(m_PAsset->getHeadLen() - pos, 0, len);
+    if (head > 0)
+        m_PAsset->getStore()->decode(pos, head, dst);
+    if (head < len)
+    {
+        // streamed frames are int16_t
+        int16_t tail[256];
+        for (auto offset = head; offset < len; offset += 256)
+        {
+            cint32_t n = std::min(len - offset, 256);
+            fetch(tail, pos + offset, n);
+            for (auto i = 0; i < n; i++)
+                dst[offset + i] = int16ToFloat(tail[i]);
+        }
+    }
+}
+
+template <class T>
+void CSample::processSamples(const T * const p_blkin, float32_t * const p_blkout, cfloat32_t factor,
+    cfloat32_t target, cint32_t blocksize)
+{
+    /*
+     * The one-pole envelope m_Gain = factor * m_Gain + (1 - factor) * target 
+     * in closed form: gain[i] = target + (m_Gain - target) * factor^i, so that
+     * LANES samples are processed at once, without a dependency between them.
+     */
+    constexpr int32_t LANES = 8;
+    float32_t powers[LANES];
+    powers[0] = 1.0F;
+    for (auto j = 1; j < LANES; j++)
+        powers[j] = powers[j - 1] * factor;
+    cfloat32_t factorLanes = powers[LANES - 1] * factor;
+    float32_t delta = m_Gain - target;
+
+    int32_t i = 0;
+    for (; i + LANES <= blocksize; i += LANES)
+    {
+        float32_t y[LANES];
+        for (auto j = 0; j < LANES; j++)
+            y[j] = toFloat(p_blkin[i + j]) * (target + delta * powers[j]);
+        // += since each sample is added to the polyphony
+        if (m_ShouldAppend)
+        {
+            for (auto j = 0; j < LANES; j++)
+                p_blkout[i + j] += y[j];
+        }
+        else
+        {
+            for (auto j = 0; j < LANES; j++)
+                p_blkout[i + j] = y[j];
+        }
+        delta *= factorLanes;
+    }
+    for (; i < blocksize; i++)
+    {
+        cfloat32_t y = toFloat(p_blkin[i]) * (target + delta);
+        if (m_ShouldAppend)
+            p_blkout[i] += y;
+        else
+            p_blkout[i] = y;
+        delta *= factor;
+    }
+    m_Gain = target + delta;
 }
 
 void CSample::setBlocksize( int32_t blocksize, bool_t force )
 {
-    if ( force || blocksize != m_Resampler.getBlocksize() )
+    if ( m_Resampler && ( force || blocksize != m_Resampler->resampler.getBlocksize() ) )
     {
-        auto len_in = m_Resampler.getLenIn(blocksize);
+        auto len_in = m_Resampler->resampler.getLenIn(blocksize);
+        auto &len_in_seq = m_Resampler->lenInSeq;
 
         if (len_in.min != len_in.max)
         {
-            m_LenInSeq.resize(len_in.num_min + len_in.num_max);
+            len_in_seq.resize(len_in.num_min + len_in.num_max);
             for( auto i = 0; i < len_in.num_max; i++)
-                m_LenInSeq[i] = len_in.max;
+                len_in_seq[i] = len_in.max;
             for( auto i = 0; i < len_in.num_min; i++)
-                m_LenInSeq[len_in.num_max + i] = len_in.min;
+                len_in_seq[len_in.num_max + i] = len_in.min;
         }
         else
         {
-            m_LenInSeq = {len_in.min};
+            len_in_seq = {len_in.min};
         }
-        m_LenInSeqCnt = 0;
-        m_BufferResampler.resize(len_in.max);
-        m_Resampler.setBlocksize(blocksize, force);
+        m_Resampler->lenInSeqCnt = 0;
+        m_Resampler->buffer.resize(len_in.max);
+        m_Resampler->resampler.setBlocksize(blocksize, force);
     }
 }
 
 void CSample::play(float32_t * const p_out, cint32_t blocksize) 
 {
-    if( NULL != p_out && NULL != m_PBuffer)
+    // lazy samples play once load()ed, see isResident(), pitched ones with their resampler
+    if( NULL != p_out && isLoaded() && isResident() && (NULL != m_Resampler || !needsResampler()))
     {
         int32_t total_bs = 0;
         int32_t should_append = m_ShouldAppend;
         int32_t len_in;
         float32_t *p_out_int = p_out;
-        if (!m_Resampler.isBypass()){
+        if (m_Resampler){
             setBlocksize(blocksize);
-            len_in = m_LenInSeq[m_LenInSeqCnt++ % m_LenInSeq.size()];
-            p_out_int = m_BufferResampler.data();
+            auto &len_in_seq = m_Resampler->lenInSeq;
+            len_in = len_in_seq[m_Resampler->lenInSeqCnt++ % len_in_seq.size()];
+            p_out_int = m_Resampler->buffer.data();
             m_ShouldAppend = false; // this will be done at the end
         } else {
             len_in = blocksize;
@@ -473,9 +622,9 @@ void CSample::play(float32_t * const p_out, cint32_t blocksize)
                 break;
             }
         }
-        if (!m_Resampler.isBypass()){
+        if (m_Resampler){
             m_ShouldAppend = should_append; // recover flag
-            auto out_resample = m_Resampler.apply(p_out_int, len_in);
+            auto out_resample = m_Resampler->resampler.apply(p_out_int, len_in);
             if(m_ShouldAppend){
                 for(auto i = 0; i < blocksize; i++)
                     p_out[i] += out_resample[i];
@@ -491,6 +640,27 @@ void CSample::play(float32_t * const p_out, cint32_t blocksize)
     }
 }
 
+void CSample::setSource(CSample const& sample)
+{
+    m_PAsset = sample.m_PAsset;
+    m_Voice.m_DecodedBlock = -1;
+    m_LoKey = sample.m_LoKey;
+    m_HiKey = sample.m_HiKey;
+    m_LoVel = sample.m_LoVel;
+    m_HiVel = sample.m_HiVel;
+    m_AmpVelTrack = sample.m_AmpVelTrack;
+    m_SeqLength = sample.m_SeqLength;
+    m_SeqPosition = sample.m_SeqPosition;
+    m_Fs = sample.m_Fs;
+    m_StatesADSRNew = sample.m_StatesADSRNew;
+    m_FadeoutSmp = sample.m_FadeoutSmp;
+    m_FadeoutFac = sample.m_FadeoutFac;
+    m_UsFactor = sample.m_UsFactor;
+    m_DsFactor = sample.m_DsFactor;
+    m_Resampler = m_Voice.getResampler(m_UsFactor, m_DsFactor);
+    m_State = FINISHED;
+}
+
 void CSample::on(void) 
 {
     // assign new ADSR values
@@ -499,17 +669,44 @@ void CSample::on(void)
     m_CurrInd = 0;
     m_SamplesCnt = 0;
     m_State = READY;
+    m_Looping = isLooped();
+    if (NULL != m_Stream)
+    {
+        // a resident source leaves the stream of the previous one idle
+        if (isStreamed())
+            m_Stream->start(m_PAsset->getStreamPath(), m_PAsset->getHeadLen(), m_PAsset->getNumFrames());
+        else
+            m_Stream->stop();
+    }
 }
 
 void CSample::off(void) 
 {
     m_SamplesCnt = 0;
-    if (m_FadeoutSmp > 0)
+    if (m_Looping && m_StatesADSR.rel_smp > 0)
+        m_State = RELEASE;
+    else if (m_FadeoutSmp > 0)
         m_State = FADEOUT;
     else
         m_State = FINISHED;
 }
 
+void CSample::fadeOut(cfloat32_t fade_s)
+{
+    m_SamplesCnt = 0;
+    m_Looping = false;
+    setFadeout(fade_s);
+    if (m_State == READY || m_State == FINISHED || m_FadeoutSmp <= 0)
+    {
+        m_Gain = 0.0F;
+        m_State = FINISHED;
+    }
+    else
+    {
+        m_State = FADEOUT;
+    }
+}
+
 void CSample::setFadeout(cfloat32_t fade_s)
 {
     if (fade_s >= 0.0F)
@@ -523,6 +720,7 @@ void CSample::setADSR(const CADSR& adsr)
 {
     // init with curr values
     tStatesADSR next_st_adsr = m_StatesADSR;
+    cint32_t num_frames = isLoaded() ? m_PAsset->getNumFrames() : 0;
     
     if (adsr.att_s >= 0.0F)
         next_st_adsr.att_smp = secondsToSamples(adsr.att_s);
@@ -546,16 +744,22 @@ void CSample::setADSR(const CADSR& adsr)
      * and rel_smp are all multiple of m_Blocksize.
      */
 
-    if ( ( next_st_adsr.att_smp + next_st_adsr.dec_smp ) == 0 && (next_st_adsr.rel_smp > 0) )
+    if (isLooped())
+    {
+        // the sustain lasts until off(), the release follows it
+        next_st_adsr.sus_smp = INT32_MAX;
+        next_st_adsr.num_smp = num_frames;
+    }
+    else if ( ( next_st_adsr.att_smp + next_st_adsr.dec_smp ) == 0 && (next_st_adsr.rel_smp > 0) )
     {
         next_st_adsr.sus_smp = 0;
-        next_st_adsr.num_smp = std::min(next_st_adsr.rel_smp, (int32_t)(*m_PBuffer).size());
+        next_st_adsr.num_smp = std::min(next_st_adsr.rel_smp, num_frames);
     }
-    else if(NULL != m_PBuffer)
+    else if(num_frames > 0)
     {
-        next_st_adsr.sus_smp =  (*m_PBuffer).size() - next_st_adsr.att_smp - next_st_adsr.dec_smp - next_st_adsr.rel_smp;
+        next_st_adsr.sus_smp =  num_frames - next_st_adsr.att_smp - next_st_adsr.dec_smp - next_st_adsr.rel_smp;
         next_st_adsr.sus_smp = std::max(next_st_adsr.sus_smp, 0);
-        next_st_adsr.num_smp = (*m_PBuffer).size();
+        next_st_adsr.num_smp = num_frames;
     }
 
     // finally copy it to class member
@@ -13,47 +13,78 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <stdint.h>
 #include <math.h>
 #include "Resampler.h"
+#include "SampleAsset.h"
+#include "SampleStream.h"
 
 /**
- * @brief 
+ * @brief Scratch of a playhead: the last block decoded from a codec and one
+ * resampler per pitch it may play at. Allocated on the control thread, so 
+ * that a voice moves between zones of different pitches without allocating
+ * (see CSample::setSource()).
  * 
  */
-class CSampleParams
+class CSampleVoice
 {
 public:
-    std::string path;
-    int32_t   lokey;
-    int32_t   hikey;
-    int32_t   lovel;
-    int32_t   hivel;
-    int32_t   ampveltrack;
-    float32_t attack_s;
-    float32_t decay_s;
-    float32_t release_s;
-    float32_t decay_gain;
-    int32_t   fs;
-    bool_t    append;
-
-    /**
-     * @brief Construct a new CSampleParams object
-     * 
-     */
-    CSampleParams() : 
-        lokey(0), hikey(0), lovel(0), hivel(0), decay_gain(1.0F),
-        ampveltrack(0), attack_s(0.F), decay_s(0.0F), release_s(0.F), fs(48000),
-        append(true)
-        {};
-    
+    typedef struct
+    {
+        int32_t us;
+        int32_t ds;
+        CResampler resampler;
+        std::vector<float32_t> buffer;
+        std::vector<int32_t> lenInSeq;
+        int32_t lenInSeqCnt;
+    }tResampler;
+
     /**
-     * @brief Destroy the CSampleParams object
+     * @brief Construct a new CSampleVoice object, without resampler
      * 
      */
-    ~CSampleParams() {};
+    CSampleVoice() {};
+
+    CSampleVoice(const CSampleVoice &) = delete;
+    CSampleVoice &operator=(const CSampleVoice &) = delete;
+
+    /**
+     * @brief Allocate the resampler of us and ds, unless there is one already
+     * or they do not resample (see CResampler::isSupported())
+     * 
+     * @param us 
+     * @param ds 
+     */
+    void addResampler(cint32_t us, cint32_t ds);
+
+    /**
+     * @brief Get the resampler of us and ds
+     * 
+     * @param us 
+     * @param ds 
+     * @return tResampler* NULL if none was added
+     */
+    tResampler *getResampler(cint32_t us, cint32_t ds) const;
+
+private:
+    friend class CSample;
+
+    std::vector<std::unique_ptr<tResampler>> m_Resamplers;
+    int16_t m_Decoded[CSampleCodec::BLOCK]; // last block decoded from a codec
+    int32_t m_DecodedBlock = -1;
 };
 
+/**
+ * @brief Playhead of a CSampleAsset, with its key and velocity ranges, its
+ * pitch and its envelope. Clones of a sample and the voices playing it share
+ * its asset, their own state is the position, the envelope and their scratch
+ * (see CSampleVoice). A sample constructed from parameters allocates the 
+ * resampler of its pitch, clones only keep the pitch and resample once a
+ * resampler for it is added (see addResampler()), e.g. to the voices of 
+ * CSampler playing them.
+ * 
+ */
 class CSample
 {
 private:
@@ -81,8 +112,11 @@ private:
         int32_t num_smp;
     }tStatesADSR;
     
-    std::vector<int16_t> m_Buffer;
-    std::vector<int16_t> *m_PBuffer = NULL;
+    std::shared_ptr<CSampleAsset> m_Asset;
+    const CSampleAsset *m_PAsset = NULL; // m_Asset or the asset of another sample
+    CSampleVoice m_Voice;
+    bool_t m_Looping = false; // the playhead wraps at the loop end, until released
+    CSampleStream *m_Stream = NULL;
     int32_t m_CurrInd;
     float32_t m_Gain;
 
@@ -95,6 +129,8 @@ private:
     int32_t m_LoVel;
     int32_t m_HiVel;
     int32_t m_AmpVelTrack;
+    int32_t m_SeqLength;
+    int32_t m_SeqPosition;
     
     tStatesADSR m_StatesADSR;
     tStatesADSR m_StatesADSRNew;
@@ -105,11 +141,24 @@ private:
     eSampleState m_State;
     bool_t m_ShouldAppend;
 
-    std::vector<float32_t> m_BufferResampler;
-    CResampler m_Resampler;
+    int32_t m_UsFactor;
+    int32_t m_DsFactor;
+    CSampleVoice::tResampler *m_Resampler = NULL; // of m_Voice for the pitch, NULL if none
+
+    /**
+     * @brief Set the pitch, 1/1 if the factors are not supported
+     * 
+     * @param us 
+     * @param ds 
+     */
+    void setFactors(cint32_t us, cint32_t ds);
 
-    std::vector<int32_t> m_LenInSeq;
-    int32_t m_LenInSeqCnt;
+    /**
+     * @brief Whether the pitch needs a resampler
+     * 
+     * @return bool_t 
+     */
+    bool_t needsResampler(void) const { return m_UsFactor != 1 || m_DsFactor != 1; };
 
     /**
      * @brief Set the Default Values object
@@ -189,6 +238,62 @@ private:
      */
     int32_t processBlockFadeout(float32_t * const p_blkout, cint32_t blocksize);
     
+    /**
+     * @brief Get frames [pos, pos + len) from the head and the stream
+     * 
+     * @param dst 
+     * @param pos 
+     * @param len 
+     */
+    void fetch(int16_t * const dst, cint32_t pos, cint32_t len);
+
+    /**
+     * @brief Decode frames [pos, pos + len) of the head from the codec, one 
+     * block at a time
+     * 
+     * @param dst 
+     * @param pos 
+     * @param len 
+     */
+    void decode(int16_t * const dst, cint32_t pos, cint32_t len);
+
+    /**
+     * @brief Get frames [pos, pos + len) from the head in the store, if any, 
+     * and the stream
+     * 
+     * @param dst 
+     * @param pos 
+     * @param len 
+     */
+    void fetch(float32_t * const dst, cint32_t pos, cint32_t len);
+
+    /**
+     * @brief Apply the envelope to the frames of p_blkin
+     * 
+     * @tparam T int16_t or float32_t
+     * 
+     * @param p_blkin 
+     * @param p_blkout 
+     * @param factor 
+     * @param target 
+     * @param blocksize 
+     */
+    template <class T>
+    void processSamples(const T * const p_blkin, float32_t * const p_blkout, cfloat32_t factor,
+        cfloat32_t target, cint32_t blocksize);
+
+    /**
+     * @brief Apply the envelope to frames [m_CurrInd, m_CurrInd + blocksize),
+     * from the head, the codec, the store or the stream
+     * 
+     * @param p_blkout 
+     * @param factor 
+     * @param target 
+     * @param blocksize 
+     */
+    void processFrames(float32_t * const p_blkout, cfloat32_t factor, cfloat32_t target, 
+        cint32_t blocksize);
+
     /**
      * @brief 
      * 
@@ -240,14 +345,17 @@ public:
     CSample() { setDefaultValues();};
 
     /**
-     * @brief Construct a new CSample object
+     * @brief Construct a new CSample object, with the resampler of its pitch
      * 
      * @param params 
+     * @param us 
+     * @param ds 
      */
     CSample(CSampleParams const& params, cint32_t us = 1, cint32_t ds = 1);
 
     /**
-     * @brief Construct a new CSample object
+     * @brief Construct a clone of sample, sharing its asset, at another pitch
+     * whose resampler is not allocated (see addResampler())
      * 
      * @param sample 
      * @param lokey 
@@ -316,12 +424,177 @@ public:
      */
     int32_t getHighVel(void){ return m_HiVel;};
 
+    /**
+     * @brief Get the length of the round-robin group. 1 if the sample plays
+     * on every note on.
+     * 
+     * @return int32_t 
+     */
+    int32_t getSeqLength(void) const { return m_SeqLength; };
+
+    /**
+     * @brief Get the position within the round-robin group, from 1 to 
+     * getSeqLength()
+     * 
+     * @return int32_t 
+     */
+    int32_t getSeqPosition(void) const { return m_SeqPosition; };
+
     /**
      * @brief Get how many samples are still to play
      * 
+     * @return int32_t INT32_MAX while a looped sample is held, as it plays 
+     * until off()
+     */
+    int32_t getNumSamplesUntilFinished(void) const;
+
+    /**
+     * @brief Whether the sample has audio to play
+     * 
+     * @return bool_t 
+     */
+    bool_t isLoaded(void) const { return NULL != m_PAsset && m_PAsset->isLoaded(); };
+
+    /**
+     * @brief Whether the sample has finished playing
+     * 
+     * @return bool_t 
+     */
+    bool_t isFinished(void) const { return m_State == FINISHED; };
+
+    /**
+     * @brief Whether the sample is releasing, i.e. in its release or fade out
+     * 
+     * @return bool_t 
+     */
+    bool_t isReleasing(void) const { return (m_State == RELEASE) || (m_State == FADEOUT); };
+
+    /**
+     * @brief Get the current envelope level
+     * 
+     * @return float32_t 
+     */
+    float32_t getLevel(void) const { return (m_State == FINISHED) ? 0.0F : m_Gain; };
+
+    /**
+     * @brief Whether off() ends the sample smoothly, through its release or 
+     * its fade out, rather than cutting it
+     * 
+     * @return bool_t 
+     */
+    bool_t hasTail(void) const { return (m_Looping && m_StatesADSR.rel_smp > 0) || m_FadeoutSmp > 0; };
+
+    /**
+     * @brief Make this sample play the asset of another one, with its key and
+     * velocity ranges, pitch, ADSR and fade out, e.g. to reuse a preallocated
+     * voice. It resamples if a resampler of the pitch was added before (see 
+     * addResampler()), otherwise it finishes at once. The append flag is 
+     * kept, nothing is allocated. The other sample must outlive this one.
+     * 
+     * @param sample 
+     */
+    void setSource(CSample const& sample);
+
+    /**
+     * @brief Whether only the head of the sample is resident, the rest being
+     * streamed from disk (see CSampleParams::preload_s)
+     * 
+     * @return bool_t 
+     */
+    bool_t isStreamed(void) const { return NULL != m_PAsset && m_PAsset->isStreamed(); };
+
+    /**
+     * @brief Whether the sample has a sustain loop, played until off()
+     * 
+     * @return bool_t 
+     */
+    bool_t isLooped(void) const { return NULL != m_PAsset && m_PAsset->isLooped(); };
+
+    /**
+     * @brief Whether the audio is in memory, i.e. the sample is not lazy or was 
+     * loaded
+     * 
+     * @return bool_t 
+     */
+    bool_t isResident(void) const { return NULL == m_PAsset || m_PAsset->isResident(); };
+
+    /**
+     * @brief Decode the audio of a lazy or unloaded sample, which finishes at
+     * once when played before. Allocates, not to be called from the audio 
+     * thread.
+     * 
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t load(void) { return m_Asset ? m_Asset->load() : -1; };
+
+    /**
+     * @brief Free the decoded audio, until the next load(). Clones and voices
+     * of the sample must not be playing.
+     * 
+     */
+    void unload(void) { if (m_Asset) m_Asset->unload(); };
+
+    /**
+     * @brief Get the memory used by the decoded audio
+     * 
+     * @return size_t Bytes
+     */
+    size_t getMemorySize(void) const { return m_Asset ? m_Asset->getMemorySize() : 0; };
+
+    /**
+     * @brief Get the asset played, NULL if none
+     * 
+     * @return const CSampleAsset* 
+     */
+    const CSampleAsset *getAsset(void) const { return m_PAsset; };
+
+    /**
+     * @brief Get the asset owned by the sample, shared with its clones, e.g.
+     * to load it from another thread. NULL for voices (see setSource()).
+     * 
+     * @return CSampleAsset* 
+     */
+    CSampleAsset *getOwnedAsset(void) const { return m_Asset.get(); };
+
+    /**
+     * @brief Whether the sample resamples, i.e. it has a pitch and the 
+     * resampler for it
+     * 
+     * @return bool_t 
+     */
+    bool_t isResampling(void) const { return NULL != m_Resampler; };
+
+    /**
+     * @brief Allocate the resampler of a pitch, e.g. of each pitch of the zones
+     * a voice may play (see setSource()). Not to be called from the audio 
+     * thread.
+     * 
+     * @param us 
+     * @param ds 
+     */
+    void addResampler(cint32_t us, cint32_t ds);
+
+    /**
+     * @brief Get the upsampling factor of the pitch
+     * 
+     * @return int32_t 
+     */
+    int32_t getUsFactor(void) const { return m_UsFactor; };
+
+    /**
+     * @brief Get the downsampling factor of the pitch
+     * 
      * @return int32_t 
      */
-    int32_t getNumSamplesUntilFinished(void);
+    int32_t getDsFactor(void) const { return m_DsFactor; };
+
+    /**
+     * @brief Set the stream reading the frames after the head, if the sample
+     * is streamed. Without stream, they are played as silence.
+     * 
+     * @param stream 
+     */
+    void setStream(CSampleStream *stream) { m_Stream = stream; };
 
     /**
      * @brief Play the current block and get the pointer to it
@@ -332,10 +605,19 @@ public:
     void play(float32_t * const p_blk, cint32_t blocksize);
 
     /**
-     * @brief Turn off sample
+     * @brief Turn off sample. Looped samples leave their loop and release, if
+     * they have a release, otherwise they fade out.
      * 
      */
     void off(void);
+
+    /**
+     * @brief Fade out over fade_s, whatever the envelope, e.g. when the voice
+     * is stolen. Samples that did not start yet finish at once.
+     * 
+     * @param fade_s Fade out in seconds
+     */
+    void fadeOut(cfloat32_t fade_s);
     
     /**
      * @brief 
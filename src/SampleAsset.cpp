@@ -0,0 +1,257 @@
+#include "SampleAsset.h"
+#include <iostream>
+#include <algorithm>
+#include <math.h>
+#include <sndfile.h>
+#include <filesystem>
+
+int32_t CSampleAsset::init(CSampleParams const& params)
+{
+    return (loadCache(params) || loadWav(params)) ? 0 : -1;
+}
+
+bool_t CSampleAsset::loadCache(CSampleParams const& params)
+{
+    if (params.cache.empty())
+        return false;
+
+    // a WAV file newer than the cache invalidates it
+    std::error_code ec;
+    auto cacheTime = std::filesystem::last_write_time(params.cache, ec);
+    if (ec)
+        return false;
+    auto wavTime = std::filesystem::last_write_time(params.path, ec);
+    if (!ec && wavTime > cacheTime)
+        return false;
+
+    auto cache = std::make_shared<CSampleCache>();
+    if (0 != cache->open(params.cache) || cache->getFs() != params.fs)
+        return false;
+
+    m_Cache = cache;
+    m_PData = cache->getData();
+    m_NumFrames = cache->getNumFrames();
+    m_ResidentLen = m_NumFrames;
+    m_HeadLen = m_NumFrames;
+    initLoop(params, cache->getLoopStart(), cache->getLoopEnd());
+    initXfade();
+    m_Resident.store(true, std::memory_order_release);
+    return true;
+}
+
+bool_t CSampleAsset::loadWav(CSampleParams const& params)
+{
+    SF_INFO info;
+    SNDFILE* const sndfile = sf_open(params.path.c_str(), SFM_READ, &info);
+    if (!sndfile || !info.frames || (info.channels != 1) || info.samplerate != params.fs)
+    {
+        std::cerr << "Failed to open sample " << params.path << std::endl;
+        sf_close(sndfile);
+        return false;
+    }
+
+    // only the head of streamed samples is resident, up to the loop end at least
+    m_Path = params.path;
+    m_NumFrames = (int32_t)info.frames;
+    int32_t fileStart, fileEnd;
+    readLoop(sndfile, fileStart, fileEnd);
+    initLoop(params, fileStart, fileEnd);
+    sf_close(sndfile);
+    m_ResidentLen = m_NumFrames;
+    if (params.preload_s >= 0.0F && params.cache.empty())
+        m_ResidentLen = std::min(m_ResidentLen,
+            std::max((int32_t)round(params.preload_s * (float32_t)params.fs), m_LoopEnd));
+
+    // lazy samples are decoded by load(), on demand
+    m_Compress = params.compress && params.cache.empty();
+    m_Format = params.cache.empty() ? params.format : SFMT_INT16;
+    if (params.lazy && params.cache.empty())
+        return true;
+    if (0 != load())
+        return false;
+
+    // from now on, play from the cache, so that the samples live in the page cache
+    if (!params.cache.empty() &&
+        0 == CSampleCache::write(params.cache, m_Buffer.data(), m_NumFrames, params.fs, fileStart, fileEnd) &&
+        loadCache(params))
+    {
+        std::vector<int16_t>().swap(m_Buffer);
+    }
+    return true;
+}
+
+int32_t CSampleAsset::load(void)
+{
+    if (isResident())
+        return 0;
+
+    SF_INFO info;
+    SNDFILE* const sndfile = m_Path.empty() ? NULL : sf_open(m_Path.c_str(), SFM_READ, &info);
+    if (!sndfile)
+    {
+        std::cerr << "Failed to load sample " << m_Path << std::endl;
+        return -1;
+    }
+
+    // convert chunk by chunk, so that only the stored frames are allocated
+    float32_t data[1024];
+    std::unique_ptr<CSampleBuffer> store;
+    if (m_Format != SFMT_INT16)
+    {
+        store = CSampleBuffer::create(m_Format, m_ResidentLen);
+        if (!store)
+        {
+            std::cerr << "Unsupported format of sample " << m_Path << std::endl;
+            sf_close(sndfile);
+            return -1;
+        }
+    }
+    else
+    {
+        m_Buffer.assign(m_ResidentLen, 0);
+    }
+    sf_seek(sndfile, 0ul, SEEK_SET);
+    for (int32_t offset = 0; offset < m_ResidentLen;)
+    {
+        auto len = sf_read_float(sndfile, data, std::min(1024, m_ResidentLen - offset));
+        if (len <= 0)
+            break;
+        if (store)
+        {
+            store->encode(data, offset, (int32_t)len);
+        }
+        else
+        {
+            for (auto i = 0; i < len; i++)
+                m_Buffer[offset + i] = floatToInt16(data[i]);
+        }
+        offset += len;
+    }
+    sf_close(sndfile);
+    //std::cout << "Adding sample from " << m_Path << std::endl;
+    m_PData = m_Buffer.data();
+    if (store)
+    {
+        m_PData = NULL;
+        m_Store = std::move(store);
+    }
+    else if (m_Compress)
+    {
+        m_Codec.reset(new CSampleCodec());
+        m_Codec->encode(m_Buffer.data(), m_ResidentLen);
+        std::vector<int16_t>().swap(m_Buffer);
+        m_PData = NULL;
+    }
+    m_HeadLen = m_ResidentLen;
+    initXfade();
+    m_Resident.store(true, std::memory_order_release);
+    return 0;
+}
+
+void CSampleAsset::unload(void)
+{
+    // only decoded buffers can be decoded again
+    if (canUnload())
+    {
+        m_Resident.store(false, std::memory_order_relaxed);
+        std::vector<int16_t>().swap(m_Buffer);
+        m_PData = NULL;
+        m_Codec.reset();
+        m_Store.reset();
+        std::vector<float32_t>().swap(m_Xfade);
+        m_HeadLen = 0;
+    }
+}
+
+void CSampleAsset::read(float32_t * const dst, cint32_t pos, cint32_t len) const
+{
+    if (m_Store)
+    {
+        m_Store->decode(pos, len, dst);
+    }
+    else if (m_Codec)
+    {
+        int16_t block[CSampleCodec::BLOCK];
+        for (auto offset = 0; offset < len;)
+        {
+            cint32_t index = (pos + offset) / CSampleCodec::BLOCK;
+            cint32_t start = (pos + offset) - index * CSampleCodec::BLOCK;
+            cint32_t n = std::min(len - offset, CSampleCodec::BLOCK - start);
+            m_Codec->decode(index, block);
+            for (auto i = 0; i < n; i++)
+                dst[offset + i] = int16ToFloat(block[start + i]);
+            offset += n;
+        }
+    }
+    else
+    {
+        for (auto i = 0; i < len; i++)
+            dst[i] = int16ToFloat(m_PData[pos + i]);
+    }
+}
+
+void CSampleAsset::initLoop(CSampleParams const& params, cint32_t fileStart, cint32_t fileEnd)
+{
+    int32_t start = params.loop_start;
+    int32_t end = params.loop_end;
+    if (start < 0)
+    {
+        start = fileStart;
+        end = fileEnd;
+    }
+
+    m_LoopStart = 0;
+    m_LoopEnd = 0;
+    m_XfadeLen = 0;
+    end = std::min(end, m_NumFrames);
+    if (start >= 0 && end > start)
+    {
+        m_LoopStart = start;
+        m_LoopEnd = end;
+        m_XfadeLen = CLIP((int32_t)round(params.loop_xfade_s * (float32_t)params.fs), 0,
+            std::min(start, end - start));
+    }
+}
+
+void CSampleAsset::readLoop(void *sndfile, int32_t &start, int32_t &end)
+{
+    start = -1;
+    end = -1;
+    SF_INSTRUMENT instrument;
+    if (SF_TRUE == sf_command((SNDFILE *)sndfile, SFC_GET_INSTRUMENT, &instrument, sizeof(instrument)))
+    {
+        for (auto i = 0; i < std::min(instrument.loop_count, 16); i++)
+        {
+            if (instrument.loops[i].mode != SF_LOOP_NONE)
+            {
+                // libsndfile reports the end past the last frame
+                start = (int32_t)instrument.loops[i].start;
+                end = (int32_t)instrument.loops[i].end;
+                break;
+            }
+        }
+    }
+}
+
+void CSampleAsset::initXfade(void)
+{
+    std::vector<float32_t>().swap(m_Xfade);
+    if (m_XfadeLen <= 0)
+        return;
+
+    /*
+     * Equal power crossfade from the frames before the loop end to the ones
+     * before the loop start, so that the loop end leads into the loop start
+     */
+    cint32_t len = m_XfadeLen;
+    std::vector<float32_t> out(len);
+    std::vector<float32_t> in(len);
+    read(out.data(), m_LoopEnd - len, len);
+    read(in.data(), m_LoopStart - len, len);
+    m_Xfade.resize(len);
+    for (auto i = 0; i < len; i++)
+    {
+        cfloat32_t phase = (float32_t)M_PI_2 * ((float32_t)i + 0.5F) / (float32_t)len;
+        m_Xfade[i] = out[i] * cosf(phase) + in[i] * sinf(phase);
+    }
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <stdint.h>
+#include "AudioTypes.h"
+#include "SampleCache.h"
+#include "SampleCodec.h"
+#include "SampleFormat.h"
+
+/**
+ * @brief 
+ * 
+ */
+class CSampleParams
+{
+public:
+    std::string path;
+    std::string cache; // path of the cache file of path, none if empty (see CSampleCache)
+    float32_t preload_s; // stream all but the first preload_s seconds, if >= 0 and without cache
+    bool_t    lazy; // decode on the first on() or load(), if without cache
+    bool_t    compress; // keep the resident frames compressed, if int16 and without cache (see CSampleCodec)
+    eSampleFormat format; // storage of the resident frames, if without cache; streamed ones stay int16
+    int32_t   loop_start; // first frame of the sustain loop, from the smpl chunk of the WAV file if < 0
+    int32_t   loop_end; // frame after the last one of the loop, no loop if <= loop_start
+    float32_t loop_xfade_s; // crossfade into the loop, at most loop_start and the loop length
+    int32_t   lokey;
+    int32_t   hikey;
+    int32_t   lovel;
+    int32_t   hivel;
+    int32_t   ampveltrack;
+    int32_t   seq_length;
+    int32_t   seq_position;
+    float32_t attack_s;
+    float32_t decay_s;
+    float32_t release_s;
+    float32_t decay_gain;
+    int32_t   fs;
+    bool_t    append;
+
+    /**
+     * @brief Construct a new CSampleParams object
+     * 
+     */
+    CSampleParams() :
+        lokey(0), hikey(0), lovel(0), hivel(0), decay_gain(1.0F),
+        ampveltrack(0), seq_length(1), seq_position(1), attack_s(0.F), decay_s(0.0F), release_s(0.F), fs(48000),
+        preload_s(-1.0F), lazy(false), compress(false), format(SFMT_INT16),
+        loop_start(-1), loop_end(-1), loop_xfade_s(0.0F), append(true)
+        {};
+
+    /**
+     * @brief Destroy the CSampleParams object
+     * 
+     */
+    ~CSampleParams() {};
+};
+
+/**
+ * @brief Audio of a sample, shared by all the CSample playing it: the frames,
+ * as int16_t (owned or mapped from the cache file), compressed or in another
+ * storage format, the loop and its crossfade. It does not change while
+ * played, only load() and unload() replace the frames, when no CSample plays
+ * them.
+ */
+class CSampleAsset
+{
+public:
+    /**
+     * @brief Construct a new CSampleAsset object
+     * 
+     */
+    CSampleAsset() {};
+
+    /**
+     * @brief Destroy the CSampleAsset object
+     * 
+     */
+    ~CSampleAsset() {};
+
+    /**
+     * @brief Map the cache file of params or open its WAV file, decode it
+     * unless lazy and write its cache file, if any
+     * 
+     * @param params 
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t init(CSampleParams const& params);
+
+    /**
+     * @brief Decode the audio of a lazy or unloaded asset, then publish it to
+     * the threads checking isResident(). Allocates, not to be called from the
+     * audio thread.
+     * 
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t load(void);
+
+    /**
+     * @brief Free the decoded audio, until the next load(). Nothing may play
+     * the asset.
+     * 
+     */
+    void unload(void);
+
+    /**
+     * @brief Whether unload() frees anything, i.e. the audio was decoded from
+     * the WAV file rather than mapped from the cache
+     * 
+     * @return bool_t 
+     */
+    bool_t canUnload(void) const { return !m_Path.empty() && !m_Cache; };
+
+    /**
+     * @brief Read resident frames [pos, pos + len), whatever their storage
+     * 
+     * @param dst 
+     * @param pos 
+     * @param len 
+     */
+    void read(float32_t * const dst, cint32_t pos, cint32_t len) const;
+
+    /**
+     * @brief Whether the asset has audio to play
+     * 
+     * @return bool_t 
+     */
+    bool_t isLoaded(void) const { return m_NumFrames > 0; };
+
+    /**
+     * @brief Whether only the head is resident, the rest being streamed from
+     * disk (see CSampleParams::preload_s)
+     * 
+     * @return bool_t 
+     */
+    bool_t isStreamed(void) const { return m_ResidentLen < m_NumFrames; };
+
+    /**
+     * @brief Whether the audio is in memory, i.e. the asset is not lazy or was
+     * loaded. The frames loaded by another thread are visible once true.
+     * 
+     * @return bool_t 
+     */
+    bool_t isResident(void) const { return m_Resident.load(std::memory_order_acquire); };
+
+    /**
+     * @brief Whether the asset has a sustain loop
+     * 
+     * @return bool_t 
+     */
+    bool_t isLooped(void) const { return m_LoopEnd > m_LoopStart; };
+
+    /**
+     * @brief Get the memory used by the decoded audio
+     * 
+     * @return size_t Bytes 
+     */
+    size_t getMemorySize(void) const
+    {
+        return m_Buffer.capacity() * sizeof(int16_t) + (m_Codec ? m_Codec->getMemorySize() : 0) +
+            (m_Store ? m_Store->getMemorySize() : 0) + m_Xfade.capacity() * sizeof(float32_t);
+    };
+
+    /**
+     * @brief Get the int16_t frames of the head, NULL if compressed or in
+     * another storage format
+     * 
+     * @return const int16_t* 
+     */
+    const int16_t *getData(void) const { return m_PData; };
+
+    /**
+     * @brief Get the compressed frames of the head, if any
+     * 
+     * @return const CSampleCodec* 
+     */
+    const CSampleCodec *getCodec(void) const { return m_Codec.get(); };
+
+    /**
+     * @brief Get the frames of the head in another storage format, if any
+     * 
+     * @return const CSampleBuffer* 
+     */
+    const CSampleBuffer *getStore(void) const { return m_Store.get(); };
+
+    /**
+     * @brief Get the crossfade played instead of the frames before the loop
+     * end, if any
+     * 
+     * @return const float32_t* 
+     */
+    const float32_t *getXfade(void) const { return m_Xfade.empty() ? NULL : m_Xfade.data(); };
+
+    /**
+     * @brief Get the WAV file streamed after the head, NULL if not streamed
+     * 
+     * @return const std::string* 
+     */
+    const std::string *getStreamPath(void) const { return isStreamed() ? &m_Path : NULL; };
+
+    int32_t getNumFrames(void) const { return m_NumFrames; };
+    int32_t getHeadLen(void) const { return m_HeadLen; };
+    int32_t getLoopStart(void) const { return m_LoopStart; };
+    int32_t getLoopEnd(void) const { return m_LoopEnd; };
+    int32_t getXfadeLen(void) const { return m_XfadeLen; };
+
+protected:
+    /**
+     * @brief Map the cache file of params, if it is valid and not older than
+     * the WAV file
+     * 
+     * @param params 
+     * @return bool_t true on success 
+     */
+    bool_t loadCache(CSampleParams const& params);
+
+    /**
+     * @brief Open the WAV file of params, decode it unless lazy and write its
+     * cache file, if any
+     * 
+     * @param params 
+     * @return bool_t true on success 
+     */
+    bool_t loadWav(CSampleParams const& params);
+
+    /**
+     * @brief Set the loop of params or, if none is given, the one of the WAV
+     * file (see readLoop()).
+     * 
+     * @param params 
+     * @param fileStart Loop of the WAV file, -1 if none
+     * @param fileEnd 
+     */
+    void initLoop(CSampleParams const& params, cint32_t fileStart, cint32_t fileEnd);
+
+    /**
+     * @brief Read the first loop of the smpl chunk of a WAV file. Backward and
+     * alternating loops play forward.
+     * 
+     * @param sndfile SNDFILE of the WAV file
+     * @param start -1 if the file has no loop
+     * @param end 
+     */
+    static void readLoop(void *sndfile, int32_t &start, int32_t &end);
+
+    /**
+     * @brief Precompute the crossfade of the loop from the resident frames
+     * 
+     */
+    void initXfade(void);
+
+    std::vector<int16_t> m_Buffer;
+    std::shared_ptr<CSampleCache> m_Cache;
+    const int16_t *m_PData = NULL; // m_Buffer or the cache mapping
+    int32_t m_NumFrames = 0;
+    int32_t m_HeadLen = 0; // resident frames, m_ResidentLen once loaded
+    std::atomic<bool_t> m_Resident{false}; // set once the frames are written
+    int32_t m_ResidentLen = 0; // frames kept in memory, m_NumFrames unless streamed
+    std::string m_Path; // WAV file, decoded by load()
+    bool_t m_Compress = false;
+    std::unique_ptr<CSampleCodec> m_Codec; // replaces m_PData
+    eSampleFormat m_Format = SFMT_INT16;
+    std::unique_ptr<CSampleBuffer> m_Store; // replaces m_PData
+    int32_t m_LoopStart = 0;
+    int32_t m_LoopEnd = 0; // no loop if m_LoopStart
+    int32_t m_XfadeLen = 0; // frames before m_LoopEnd crossfaded into the ones before m_LoopStart
+    std::vector<float32_t> m_Xfade;
+};
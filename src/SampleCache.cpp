@@ -0,0 +1,128 @@
+#include "SampleCache.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+int32_t CSampleCache::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == hFile)
+        return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size) || size.QuadPart < (LONGLONG)sizeof(tHeader))
+    {
+        CloseHandle(hFile);
+        return -1;
+    }
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *pMap = (NULL != hMapping) ? MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (NULL == pMap)
+    {
+        if (NULL != hMapping)
+            CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return -1;
+    }
+    m_HFile = hFile;
+    m_HMapping = hMapping;
+    m_MapSize = (size_t)size.QuadPart;
+#else
+    cint32_t fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size < (off_t)sizeof(tHeader))
+    {
+        ::close(fd);
+        return -1;
+    }
+    void *pMap = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (MAP_FAILED == pMap)
+        return -1;
+    m_MapSize = (size_t)st.st_size;
+#endif
+    m_PMap = pMap;
+
+    tHeader header;
+    memcpy(&header, m_PMap, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION || header.num_frames <= 0 ||
+        m_MapSize < sizeof(tHeader) + (size_t)header.num_frames * sizeof(int16_t))
+    {
+        close();
+        return -1;
+    }
+
+    m_PData = (const int16_t *)((const uint8_t *)m_PMap + sizeof(tHeader));
+    m_NumFrames = header.num_frames;
+    m_Fs = header.fs;
+    m_LoopStart = header.loop_start;
+    m_LoopEnd = header.loop_end;
+    return 0;
+}
+
+void CSampleCache::close(void)
+{
+    if (NULL != m_PMap)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_PMap);
+        CloseHandle((HANDLE)m_HMapping);
+        CloseHandle((HANDLE)m_HFile);
+        m_HMapping = NULL;
+        m_HFile = NULL;
+#else
+        munmap(m_PMap, m_MapSize);
+#endif
+    }
+    m_PMap = NULL;
+    m_MapSize = 0;
+    m_PData = NULL;
+    m_NumFrames = 0;
+    m_Fs = 0;
+    m_LoopStart = -1;
+    m_LoopEnd = -1;
+}
+
+int32_t CSampleCache::write(const std::string &path, const int16_t *data, cint32_t numFrames, cint32_t fs,
+                           cint32_t loopStart, cint32_t loopEnd)
+{
+    if (NULL == data || numFrames <= 0)
+        return -1;
+
+    // write to a temporary file first, so that no reader maps a partial file
+    const std::string tmp = path + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (NULL == fp)
+        return -1;
+
+    tHeader header = {MAGIC, VERSION, fs, numFrames, loopStart, loopEnd};
+    bool_t ok = (1 == fwrite(&header, sizeof(header), 1, fp)) &&
+                ((size_t)numFrames == fwrite(data, sizeof(int16_t), (size_t)numFrames, fp));
+    ok = (0 == fclose(fp)) && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && (0 == rename(tmp.c_str(), path.c_str()));
+#endif
+    if (!ok)
+        remove(tmp.c_str());
+    return ok ? 0 : -1;
+}
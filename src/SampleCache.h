@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include "AudioTypes.h"
+
+/**
+ * @brief Read-only memory mapping of a sample cache file: the samples of a
+ * WAV file, already converted to int16_t, after a small header which also
+ * holds the loop of its smpl chunk. The mapping
+ * is backed by the page cache, so it is shared by all instances and processes
+ * mapping the same file, and opening it costs no decoding nor copy. Pages are
+ * read from disk as they are first played.
+ * 
+ * Cache files are written by write(), e.g. when a WAV file is loaded for the
+ * first time, see CSampleParams::cache.
+ */
+class CSampleCache
+{
+public:
+    static constexpr uint32_t MAGIC = 0x53505344U; // "DSPS"
+    static constexpr uint32_t VERSION = 2U;
+
+    typedef struct
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t fs;
+        int32_t num_frames;
+        int32_t loop_start; // loop of the smpl chunk of the WAV file, -1 if none
+        int32_t loop_end;
+    } tHeader;
+
+    /**
+     * @brief Construct a new CSampleCache object
+     * 
+     */
+    CSampleCache() {};
+
+    /**
+     * @brief Destroy the CSampleCache object, unmapping the file
+     * 
+     */
+    ~CSampleCache() { close(); };
+
+    CSampleCache(const CSampleCache &) = delete;
+    CSampleCache &operator=(const CSampleCache &) = delete;
+
+    /**
+     * @brief Map a cache file
+     * 
+     * @param path 
+     * @return int32_t 0 on success, -1 if the file is missing or invalid
+     */
+    int32_t open(const std::string &path);
+
+    /**
+     * @brief Unmap the file
+     * 
+     */
+    void close(void);
+
+    /**
+     * @brief Get the samples, NULL if nothing is mapped
+     * 
+     * @return const int16_t* 
+     */
+    const int16_t *getData(void) const { return m_PData; };
+
+    /**
+     * @brief Get the number of samples
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumFrames(void) const { return m_NumFrames; };
+
+    /**
+     * @brief Get the sampling rate
+     * 
+     * @return int32_t 
+     */
+    int32_t getFs(void) const { return m_Fs; };
+
+    /**
+     * @brief Get the first frame of the loop of the WAV file
+     * 
+     * @return int32_t -1 if the file has no loop
+     */
+    int32_t getLoopStart(void) const { return m_LoopStart; };
+
+    /**
+     * @brief Get the frame after the last one of the loop of the WAV file
+     * 
+     * @return int32_t -1 if the file has no loop
+     */
+    int32_t getLoopEnd(void) const { return m_LoopEnd; };
+
+    /**
+     * @brief Write a cache file
+     * 
+     * @param path 
+     * @param data 
+     * @param numFrames 
+     * @param fs 
+     * @param loopStart Loop of the smpl chunk, -1 if none
+     * @param loopEnd 
+     * @return int32_t 0 on success, -1 on error
+     */
+    static int32_t write(const std::string &path, const int16_t *data, cint32_t numFrames, cint32_t fs,
+                         cint32_t loopStart = -1, cint32_t loopEnd = -1);
+
+private:
+    void *m_PMap = NULL;
+    size_t m_MapSize = 0;
+#ifdef _WIN32
+    void *m_HFile = NULL;
+    void *m_HMapping = NULL;
+#endif
+    const int16_t *m_PData = NULL;
+    int32_t m_NumFrames = 0;
+    int32_t m_Fs = 0;
+    int32_t m_LoopStart = -1;
+    int32_t m_LoopEnd = -1;
+};
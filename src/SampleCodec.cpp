@@ -0,0 +1,118 @@
+#include "SampleCodec.h"
+
+namespace
+{
+    // block header: x[0], x[1], then the predictor order and the bit width of
+    // the residuals in one byte
+    constexpr int32_t HEADER_LEN = 5;
+    constexpr int32_t NUM_ORDERS = 3;
+    // the decoder reads whole bytes, possibly past the last residual
+    constexpr int32_t PADDING = 8;
+
+    inline uint32_t zigzag(cint32_t r) { return ((uint32_t)r << 1) ^ (uint32_t)(r >> 31); }
+    // fixed polynomial predictors of order 0 to 2
+    inline int32_t predict(cint32_t order, cint32_t x1, cint32_t x2)
+    {
+        return (order == 0) ? 0 : ((order == 1) ? x1 : 2 * x1 - x2);
+    }
+    inline int32_t unzigzag(cuint32_t z) { return (int32_t)(z >> 1) ^ -(int32_t)(z & 1U); }
+}
+
+void CSampleCodec::encode(const int16_t *data, cint32_t len)
+{
+    m_NumFrames = MAX(len, 0);
+    m_Offsets.clear();
+    m_Data.clear();
+
+    std::vector<uint32_t> res[NUM_ORDERS];
+    for (auto &r : res)
+        r.resize(BLOCK);
+    for (auto start = 0; start < m_NumFrames; start += BLOCK)
+    {
+        cint16_t *x = &data[start];
+        cint32_t n = getBlockLen(start / BLOCK);
+
+        // the order with the narrowest residuals wins
+        int32_t order = 0;
+        uint8_t bits = 32;
+        for (auto o = 0; o < NUM_ORDERS; o++)
+        {
+            uint32_t all = 0;
+            for (auto i = 2; i < n; i++)
+            {
+                res[o][i] = zigzag((int32_t)x[i] - predict(o, x[i - 1], x[i - 2]));
+                all |= res[o][i];
+            }
+            uint8_t b = 0;
+            while (b < 32 && (all >> b) != 0U)
+                b++;
+            if (b < bits)
+            {
+                bits = b;
+                order = o;
+            }
+        }
+
+        m_Offsets.push_back((uint32_t)m_Data.size());
+        cuint16_t x0 = (uint16_t)x[0];
+        cuint16_t x1 = (n > 1) ? (uint16_t)x[1] : 0U;
+        m_Data.push_back((uint8_t)(x0 & 0xFFU));
+        m_Data.push_back((uint8_t)(x0 >> 8));
+        m_Data.push_back((uint8_t)(x1 & 0xFFU));
+        m_Data.push_back((uint8_t)(x1 >> 8));
+        m_Data.push_back((uint8_t)((order << 6) | bits));
+
+        uint64_t acc = 0;
+        int32_t accBits = 0;
+        for (auto i = 2; i < n; i++)
+        {
+            acc |= (uint64_t)res[order][i] << accBits;
+            accBits += bits;
+            while (accBits >= 8)
+            {
+                m_Data.push_back((uint8_t)(acc & 0xFFU));
+                acc >>= 8;
+                accBits -= 8;
+            }
+        }
+        if (accBits > 0)
+            m_Data.push_back((uint8_t)(acc & 0xFFU));
+    }
+    m_Data.resize(m_Data.size() + PADDING, 0);
+    m_Data.shrink_to_fit();
+    m_Offsets.shrink_to_fit();
+}
+
+void CSampleCodec::decode(cint32_t block, int16_t *dst) const
+{
+    const uint8_t *p = &m_Data[m_Offsets[block]];
+    cint32_t n = getBlockLen(block);
+
+    int32_t x2 = (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+    int32_t x1 = (int16_t)(uint16_t)(p[2] | (p[3] << 8));
+    cint32_t order = p[4] >> 6;
+    cint32_t bits = p[4] & 0x3F;
+    const uint64_t mask = (1ULL << bits) - 1ULL;
+    p += HEADER_LEN;
+
+    dst[0] = (int16_t)x2;
+    if (n > 1)
+        dst[1] = (int16_t)x1;
+
+    uint64_t acc = 0;
+    int32_t accBits = 0;
+    for (auto i = 2; i < n; i++)
+    {
+        while (accBits < bits)
+        {
+            acc |= (uint64_t)(*p++) << accBits;
+            accBits += 8;
+        }
+        cint32_t x = predict(order, x1, x2) + unzigzag((uint32_t)(acc & mask));
+        acc >>= bits;
+        accBits -= bits;
+        dst[i] = (int16_t)x;
+        x2 = x1;
+        x1 = x;
+    }
+}
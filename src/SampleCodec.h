@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "AudioTypes.h"
+
+/**
+ * @brief Lossless block codec for int16_t samples, so that samples can stay
+ * compressed in memory and be decoded block by block while playing. Each
+ * block of BLOCK samples stores its first two samples, then the residuals of 
+ * a fixed predictor (0, x[n - 1] or 2 * x[n - 1] - x[n - 2], whichever gives
+ * the narrowest residuals), zigzag coded and packed with the bit width of the
+ * largest one. Blocks are decoded independently, at a constant cost per 
+ * sample.
+ */
+class CSampleCodec
+{
+public:
+    static constexpr int32_t BLOCK = 256;
+
+    /**
+     * @brief Construct a new CSampleCodec object
+     * 
+     */
+    CSampleCodec() {};
+
+    /**
+     * @brief Destroy the CSampleCodec object
+     * 
+     */
+    ~CSampleCodec() {};
+
+    /**
+     * @brief Compress samples, replacing the previous ones
+     * 
+     * @param data 
+     * @param len 
+     */
+    void encode(const int16_t *data, cint32_t len);
+
+    /**
+     * @brief Decode block into dst, which holds BLOCK samples. The last block
+     * may be shorter, see getBlockLen().
+     * 
+     * @param block 
+     * @param dst 
+     */
+    void decode(cint32_t block, int16_t *dst) const;
+
+    /**
+     * @brief Get the number of samples
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumFrames(void) const { return m_NumFrames; };
+
+    /**
+     * @brief Get the number of blocks
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumBlocks(void) const { return (int32_t)m_Offsets.size(); };
+
+    /**
+     * @brief Get the number of samples of block
+     * 
+     * @param block 
+     * @return int32_t 
+     */
+    int32_t getBlockLen(cint32_t block) const { return MIN(BLOCK, m_NumFrames - block * BLOCK); };
+
+    /**
+     * @brief Get the memory used by the compressed samples
+     * 
+     * @return size_t Bytes
+     */
+    size_t getMemorySize(void) const
+    {
+        return m_Data.capacity() * sizeof(uint8_t) + m_Offsets.capacity() * sizeof(uint32_t);
+    };
+
+private:
+    std::vector<uint8_t> m_Data;
+    std::vector<uint32_t> m_Offsets; // of each block in m_Data
+    int32_t m_NumFrames = 0;
+};
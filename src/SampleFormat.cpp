@@ -0,0 +1,156 @@
+#include "SampleFormat.h"
+#include <string.h>
+#include <math.h>
+
+namespace
+{
+    inline int32_t quantize(cfloat32_t x, cint32_t full)
+    {
+        return (int32_t)lrintf(CLIP(x, -1.0F, 1.0F) * (float32_t)full);
+    }
+
+    // G.711 mu-law, on the 14 bit magnitude
+    constexpr int32_t MULAW_BIAS = 0x84;
+    constexpr int32_t MULAW_CLIP = 32635;
+
+    uint8_t muLawEncode(int32_t x)
+    {
+        cint32_t sign = (x < 0) ? 0x80 : 0x00;
+        x = MIN(sign ? -x : x, MULAW_CLIP) + MULAW_BIAS;
+        int32_t exponent = 7;
+        for (int32_t mask = 0x4000; (x & mask) == 0 && exponent > 0; mask >>= 1)
+            exponent--;
+        cint32_t mantissa = (x >> (exponent + 3)) & 0x0F;
+        return (uint8_t)~(sign | (exponent << 4) | mantissa);
+    }
+
+    struct CMuLawTable
+    {
+        float32_t values[256];
+        CMuLawTable()
+        {
+            for (auto i = 0; i < 256; i++)
+            {
+                cint32_t u = ~i & 0xFF;
+                cint32_t exponent = (u >> 4) & 0x07;
+                cint32_t magnitude = ((((u & 0x0F) << 3) + MULAW_BIAS) << exponent) - MULAW_BIAS;
+                values[i] = (float32_t)((u & 0x80) ? -magnitude : magnitude) / 32768.0F;
+            }
+        }
+    };
+    const CMuLawTable MULAW_TABLE;
+}
+
+void CSampleFormatInt16::encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len)
+{
+    int16_t *p = (int16_t *)dst + pos;
+    for (auto i = 0; i < len; i++)
+        p[i] = floatToInt16(CLIP(src[i], -1.0F, 1.0F));
+}
+
+void CSampleFormatInt16::decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst)
+{
+    const int16_t *p = (const int16_t *)src + pos;
+    for (auto i = 0; i < len; i++)
+        dst[i] = int16ToFloat(p[i]);
+}
+
+void CSampleFormatInt24::encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len)
+{
+    uint8_t *p = dst + 3 * pos;
+    for (auto i = 0; i < len; i++)
+    {
+        cint32_t v = MIN(quantize(src[i], 8388608), 8388607);
+        p[3 * i] = (uint8_t)(v & 0xFF);
+        p[3 * i + 1] = (uint8_t)((v >> 8) & 0xFF);
+        p[3 * i + 2] = (uint8_t)((v >> 16) & 0xFF);
+    }
+}
+
+void CSampleFormatInt24::decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst)
+{
+    const uint8_t *p = src + 3 * pos;
+    for (auto i = 0; i < len; i++)
+    {
+        // sign extension through the top byte
+        cint32_t v = (int32_t)(((uint32_t)p[3 * i] << 8) | ((uint32_t)p[3 * i + 1] << 16) |
+                               ((uint32_t)p[3 * i + 2] << 24)) >> 8;
+        dst[i] = (float32_t)v * (1.0F / 8388608.0F);
+    }
+}
+
+void CSampleFormatFloat32::encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len)
+{
+    memcpy(dst + 4 * (size_t)pos, src, len * sizeof(float32_t));
+}
+
+void CSampleFormatFloat32::decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst)
+{
+    memcpy(dst, src + 4 * (size_t)pos, len * sizeof(float32_t));
+}
+
+void CSampleFormatMuLaw8::encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len)
+{
+    for (auto i = 0; i < len; i++)
+        dst[pos + i] = muLawEncode(quantize(src[i], 32768));
+}
+
+void CSampleFormatMuLaw8::decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst)
+{
+    for (auto i = 0; i < len; i++)
+        dst[i] = MULAW_TABLE.values[src[pos + i]];
+}
+
+void CSampleFormatInt12::encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len)
+{
+    // frame 2k in byte 3k and the low nibble of 3k + 1, frame 2k + 1 in the
+    // high nibble of 3k + 1 and byte 3k + 2
+    for (auto i = 0; i < len; i++)
+    {
+        cint32_t n = pos + i;
+        cuint32_t v = (uint32_t)MIN(quantize(src[i], 2048), 2047) & 0x0FFFU;
+        uint8_t *p = dst + 3 * (n >> 1);
+        if (0 == (n & 1))
+        {
+            p[0] = (uint8_t)(v & 0xFFU);
+            p[1] = (uint8_t)((p[1] & 0xF0U) | (v >> 8));
+        }
+        else
+        {
+            p[1] = (uint8_t)((p[1] & 0x0FU) | ((v & 0x0FU) << 4));
+            p[2] = (uint8_t)(v >> 4);
+        }
+    }
+}
+
+void CSampleFormatInt12::decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst)
+{
+    for (auto i = 0; i < len; i++)
+    {
+        cint32_t n = pos + i;
+        const uint8_t *p = src + 3 * (n >> 1);
+        cuint32_t v = (0 == (n & 1)) ? (p[0] | ((uint32_t)(p[1] & 0x0FU) << 8))
+                                     : ((p[1] >> 4) | ((uint32_t)p[2] << 4));
+        // sign extension through the top bits
+        dst[i] = (float32_t)((int32_t)(v << 20) >> 20) * (1.0F / 2048.0F);
+    }
+}
+
+std::unique_ptr<CSampleBuffer> CSampleBuffer::create(const eSampleFormat format, cint32_t numFrames)
+{
+    switch (format)
+    {
+    case SFMT_INT16:
+        return std::unique_ptr<CSampleBuffer>(new CSampleBufferT<CSampleFormatInt16>(numFrames));
+    case SFMT_INT24:
+        return std::unique_ptr<CSampleBuffer>(new CSampleBufferT<CSampleFormatInt24>(numFrames));
+    case SFMT_FLOAT32:
+        return std::unique_ptr<CSampleBuffer>(new CSampleBufferT<CSampleFormatFloat32>(numFrames));
+    case SFMT_MULAW8:
+        return std::unique_ptr<CSampleBuffer>(new CSampleBufferT<CSampleFormatMuLaw8>(numFrames));
+    case SFMT_INT12:
+        return std::unique_ptr<CSampleBuffer>(new CSampleBufferT<CSampleFormatInt12>(numFrames));
+    default:
+        return nullptr;
+    }
+}
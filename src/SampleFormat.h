@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include "AudioTypes.h"
+
+/**
+ * @brief Converts a sample in [-1, 1] to int16_t, as stored by CSampleAsset and
+ * CSampleStream
+ * 
+ * @param sample 
+ * @return int16_t 
+ */
+static inline int16_t floatToInt16(cfloat32_t sample)
+{
+    if (sample > 0.0F)
+        return (int16_t)(((float32_t)INT16_MAX * sample) + 0.5F);
+    else
+        return (int16_t)(((float32_t)INT16_MIN * -sample) - 0.5F);
+}
+
+/**
+ * @brief Converts a sample stored as int16_t back to [-1, 1]. Same as dividing
+ * by INT16_MAX or -INT16_MIN depending on the sign, as one multiplication.
+ * 
+ * @param sample 
+ * @return float32_t 
+ */
+static inline float32_t int16ToFloat(cint16_t sample)
+{
+    return (float32_t)sample * ((sample < 0) ? (1.0F / -(float32_t)INT16_MIN) : (1.0F / (float32_t)INT16_MAX));
+}
+
+/**
+ * @brief Storage formats of the samples of a CSampleBuffer
+ */
+typedef enum
+{
+    SFMT_INT16 = 0, // 16 bit PCM
+    SFMT_INT24,     // 24 bit PCM, packed in 3 bytes
+    SFMT_FLOAT32,   // 32 bit float
+    SFMT_MULAW8,    // 8 bit G.711 mu-law, 14 bit dynamic range
+    SFMT_INT12,     // 12 bit PCM, 2 samples packed in 3 bytes
+} eSampleFormat;
+
+/**
+ * @brief Storage format policies of CSampleBufferT. Each one converts frames
+ * [pos, pos + len) of a buffer from and to float32_t in [-1, 1]. Int16 uses
+ * floatToInt16() and int16ToFloat(), as the frames kept as int16_t by 
+ * CSampleAsset.
+ */
+struct CSampleFormatInt16
+{
+    static constexpr eSampleFormat FORMAT = SFMT_INT16;
+    static size_t getSize(cint32_t numFrames) { return (size_t)numFrames * 2; };
+    static void encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len);
+    static void decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst);
+};
+
+struct CSampleFormatInt24
+{
+    static constexpr eSampleFormat FORMAT = SFMT_INT24;
+    static size_t getSize(cint32_t numFrames) { return (size_t)numFrames * 3; };
+    static void encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len);
+    static void decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst);
+};
+
+struct CSampleFormatFloat32
+{
+    static constexpr eSampleFormat FORMAT = SFMT_FLOAT32;
+    static size_t getSize(cint32_t numFrames) { return (size_t)numFrames * 4; };
+    static void encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len);
+    static void decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst);
+};
+
+struct CSampleFormatMuLaw8
+{
+    static constexpr eSampleFormat FORMAT = SFMT_MULAW8;
+    static size_t getSize(cint32_t numFrames) { return (size_t)numFrames; };
+    static void encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len);
+    static void decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst);
+};
+
+struct CSampleFormatInt12
+{
+    static constexpr eSampleFormat FORMAT = SFMT_INT12;
+    static size_t getSize(cint32_t numFrames) { return ((size_t)numFrames * 3 + 1) / 2; };
+    static void encode(const float32_t *src, uint8_t *dst, cint32_t pos, cint32_t len);
+    static void decode(const uint8_t *src, cint32_t pos, cint32_t len, float32_t *dst);
+};
+
+/**
+ * @brief Sample storage in one of the eSampleFormat formats, see create().
+ * Frames are encoded once when loading and decoded chunk by chunk while 
+ * playing. Only the resident head of a sample is stored this way: the frames
+ * streamed past it (see CSampleParams::preload_s) stay int16_t.
+ */
+class CSampleBuffer
+{
+public:
+    virtual ~CSampleBuffer() {};
+
+    /**
+     * @brief Create a buffer of numFrames frames, all 0
+     * 
+     * @param format 
+     * @param numFrames 
+     * @return std::unique_ptr<CSampleBuffer> nullptr on invalid format
+     */
+    static std::unique_ptr<CSampleBuffer> create(const eSampleFormat format, cint32_t numFrames);
+
+    /**
+     * @brief Store frames [pos, pos + len)
+     * 
+     * @param src 
+     * @param pos 
+     * @param len 
+     */
+    virtual void encode(const float32_t *src, cint32_t pos, cint32_t len) = 0;
+
+    /**
+     * @brief Get frames [pos, pos + len)
+     * 
+     * @param pos 
+     * @param len 
+     * @param dst 
+     */
+    virtual void decode(cint32_t pos, cint32_t len, float32_t *dst) const = 0;
+
+    /**
+     * @brief Get the storage format
+     * 
+     * @return eSampleFormat 
+     */
+    virtual eSampleFormat getFormat(void) const = 0;
+
+    /**
+     * @brief Get the number of frames
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumFrames(void) const { return m_NumFrames; };
+
+    /**
+     * @brief Get the memory used by the frames
+     * 
+     * @return size_t Bytes
+     */
+    size_t getMemorySize(void) const { return m_Data.capacity(); };
+
+protected:
+    std::vector<uint8_t> m_Data;
+    int32_t m_NumFrames = 0;
+};
+
+/**
+ * @brief CSampleBuffer storing its frames with the format policy F
+ * 
+ * @tparam F One of the CSampleFormat policies
+ */
+template <class F>
+class CSampleBufferT : public CSampleBuffer
+{
+public:
+    /**
+     * @brief Construct a new CSampleBufferT object of numFrames frames, all 0
+     * 
+     * @param numFrames 
+     */
+    explicit CSampleBufferT(cint32_t numFrames)
+    {
+        m_NumFrames = MAX(numFrames, 0);
+        m_Data.assign(F::getSize(m_NumFrames), 0);
+        if (F::FORMAT == SFMT_MULAW8)
+            encode(std::vector<float32_t>(m_NumFrames, 0.0F).data(), 0, m_NumFrames);
+    };
+
+    void encode(const float32_t *src, cint32_t pos, cint32_t len) override
+    {
+        F::encode(src, m_Data.data(), pos, len);
+    };
+
+    void decode(cint32_t pos, cint32_t len, float32_t *dst) const override
+    {
+        F::decode(m_Data.data(), pos, len, dst);
+    };
+
+    eSampleFormat getFormat(void) const override { return F::FORMAT; };
+};
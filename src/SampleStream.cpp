@@ -0,0 +1,200 @@
+#include "SampleStream.h"
+#include "SampleAsset.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <sndfile.h>
+
+void CSampleStream::init(cint32_t horizon)
+{
+    int32_t size = 1;
+    while (size < horizon)
+        size <<= 1;
+    m_Ring.assign(size, 0);
+    m_Mask = size - 1;
+    m_Scratch.resize(1024);
+}
+
+void CSampleStream::start(const std::string *path, cint32_t from, cint32_t end)
+{
+    m_ReqPath.store(path, std::memory_order_relaxed);
+    m_ReqFrom.store(from, std::memory_order_relaxed);
+    m_ReqEnd.store(end, std::memory_order_relaxed);
+    m_ReadPos.store(from, std::memory_order_relaxed);
+    m_Gen.fetch_add(1, std::memory_order_release);
+}
+
+int32_t CSampleStream::read(int16_t *dst, cint32_t pos, cint32_t len)
+{
+    int32_t avail = 0;
+    if (m_FillGen.load(std::memory_order_acquire) == m_Gen.load(std::memory_order_relaxed))
+        avail = CLIP(m_WritePos.load(std::memory_order_acquire) - pos, 0, len);
+
+    for (auto i = 0; i < avail; i++)
+        dst[i] = m_Ring[(pos + i) & m_Mask];
+    if (avail < len)
+    {
+        memset(&dst[avail], 0, (len - avail) * sizeof(int16_t));
+        m_Underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // frees the slots for the I/O thread
+    m_ReadPos.store(pos + len, std::memory_order_release);
+    return avail;
+}
+
+int32_t CSampleStream::fill(void)
+{
+    cuint32_t gen = m_Gen.load(std::memory_order_acquire);
+    if (gen != m_FillGen.load(std::memory_order_relaxed))
+    {
+        // new request: (re)open the file at the requested position
+        const std::string *path = m_ReqPath.load(std::memory_order_relaxed);
+        cint32_t from = m_ReqFrom.load(std::memory_order_relaxed);
+        cint32_t end = m_ReqEnd.load(std::memory_order_relaxed);
+        if (gen != m_Gen.load(std::memory_order_acquire))
+            return 0; // torn request, retry
+
+        closeFile();
+        if (NULL != path && from < end)
+        {
+            SF_INFO info;
+            SNDFILE *sndfile = sf_open(path->c_str(), SFM_READ, &info);
+            if (NULL != sndfile && info.channels == 1)
+            {
+                sf_seek(sndfile, from, SEEK_SET);
+                m_File = sndfile;
+            }
+            else if (NULL != sndfile)
+            {
+                sf_close(sndfile);
+            }
+        }
+        m_FilePos = from;
+        m_FileEnd = end;
+        m_WritePos.store(from, std::memory_order_relaxed);
+        m_FillGen.store(gen, std::memory_order_release);
+    }
+
+    if (NULL == m_File)
+        return 0;
+
+    int32_t total = 0;
+    cint32_t horizon = (int32_t)m_Ring.size();
+    while (m_FilePos < m_FileEnd)
+    {
+        cint32_t space = m_ReadPos.load(std::memory_order_acquire) + horizon - m_FilePos;
+        cint32_t len = std::min(std::min(space, m_FileEnd - m_FilePos), (int32_t)m_Scratch.size());
+        if (len <= 0 || gen != m_Gen.load(std::memory_order_relaxed))
+            break;
+
+        cint32_t got = (int32_t)sf_read_float((SNDFILE *)m_File, m_Scratch.data(), len);
+        for (auto i = 0; i < got; i++)
+            m_Ring[(m_FilePos + i) & m_Mask] = floatToInt16(m_Scratch[i]);
+        m_FilePos += got;
+        total += got;
+        m_WritePos.store(m_FilePos, std::memory_order_release);
+        if (got < len)
+            m_FileEnd = m_FilePos; // truncated file
+    }
+
+    if (m_FilePos >= m_FileEnd)
+        closeFile();
+    return total;
+}
+
+void CSampleStream::closeFile(void)
+{
+    if (NULL != m_File)
+        sf_close((SNDFILE *)m_File);
+    m_File = NULL;
+}
+
+int32_t CSampleStreamer::init(cint32_t numStreams, cint32_t horizon, cint32_t numRequests,
+    const bool_t ioThread)
+{
+    deinit();
+    if (numStreams < 0 || (numStreams > 0 && horizon <= 0) || numRequests < 0)
+        return -1;
+
+    m_Streams.reset(new CSampleStream[numStreams]);
+    m_NumStreams = numStreams;
+    for (auto i = 0; i < numStreams; i++)
+        m_Streams[i].init(horizon);
+
+    uint32_t size = (numRequests > 0) ? 1 : 0;
+    while (size < (uint32_t)numRequests)
+        size <<= 1;
+    m_Requests.assign(size, {NULL, false});
+    m_RequestMask = (size > 0) ? size - 1 : 0;
+
+    if (ioThread)
+    {
+        m_Running.store(true);
+        m_Thread = std::thread(&CSampleStreamer::run, this);
+    }
+    return 0;
+}
+
+void CSampleStreamer::deinit(void)
+{
+    if (m_Thread.joinable())
+    {
+        m_Running.store(false);
+        m_Thread.join();
+    }
+    m_Streams.reset();
+    m_NumStreams = 0;
+    std::vector<tRequest>().swap(m_Requests);
+    m_RequestMask = 0;
+    m_Posted.store(0);
+    m_Served.store(0);
+}
+
+int32_t CSampleStreamer::post(CSampleAsset *asset, const bool_t load)
+{
+    cuint32_t posted = m_Posted.load(std::memory_order_relaxed);
+    if (m_Requests.empty() || posted - m_Served.load(std::memory_order_acquire) > m_RequestMask)
+        return -1;
+
+    m_Requests[posted & m_RequestMask] = {asset, load};
+    m_Posted.store(posted + 1, std::memory_order_release);
+    return 0;
+}
+
+int32_t CSampleStreamer::getNumUnderruns(void) const
+{
+    int32_t underruns = 0;
+    for (auto i = 0; i < m_NumStreams; i++)
+        underruns += m_Streams[i].getNumUnderruns();
+    return underruns;
+}
+
+int32_t CSampleStreamer::fill(void)
+{
+    int32_t total = 0;
+    cuint32_t posted = m_Posted.load(std::memory_order_acquire);
+    for (uint32_t served = m_Served.load(std::memory_order_relaxed); served != posted; served++)
+    {
+        const tRequest &request = m_Requests[served & m_RequestMask];
+        if (request.load)
+            request.asset->load();
+        else
+            request.asset->unload();
+        m_Served.store(served + 1, std::memory_order_release);
+        total++;
+    }
+
+    for (auto i = 0; i < m_NumStreams; i++)
+        total += m_Streams[i].fill();
+    return total;
+}
+
+void CSampleStreamer::run(void)
+{
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        if (0 == fill())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <memory>
+#include "AudioTypes.h"
+#include "SampleFormat.h"
+
+class CSampleAsset;
+
+/**
+ * @brief Ring buffer streaming the frames of a WAV file ahead of a play 
+ * cursor, from one I/O thread (see fill()) to one audio thread (see start(),
+ * read()). Lock-free and allocation-free once initialized: the file is opened,
+ * read and closed by the I/O thread only.
+ * 
+ * The capacity of the ring is the prefetch horizon: the I/O thread reads up to
+ * that many frames ahead of the last read() position. Frames not streamed yet
+ * when read are played as silence and counted as underruns.
+ */
+class CSampleStream
+{
+public:
+    /**
+     * @brief Construct a new CSampleStream object
+     * 
+     */
+    CSampleStream() {};
+
+    /**
+     * @brief Destroy the CSampleStream object
+     * 
+     */
+    ~CSampleStream() { closeFile(); };
+
+    CSampleStream(const CSampleStream &) = delete;
+    CSampleStream &operator=(const CSampleStream &) = delete;
+
+    /**
+     * @brief Allocate the ring
+     * 
+     * @param horizon Prefetch horizon in frames, rounded up to a power of 2
+     */
+    void init(cint32_t horizon);
+
+    /**
+     * @brief Start streaming frames [from, end) of the file at path. Audio
+     * thread. path must stay valid until the next start() or stop().
+     * 
+     * @param path 
+     * @param from 
+     * @param end 
+     */
+    void start(const std::string *path, cint32_t from, cint32_t end);
+
+    /**
+     * @brief Stop streaming. Audio thread.
+     * 
+     */
+    void stop(void) { start(NULL, 0, 0); };
+
+    /**
+     * @brief Read frames [pos, pos + len), which must follow the previous read.
+     * Frames not yet streamed are zeroed. Audio thread.
+     * 
+     * @param dst 
+     * @param pos 
+     * @param len 
+     * @return int32_t Number of frames actually streamed
+     */
+    int32_t read(int16_t *dst, cint32_t pos, cint32_t len);
+
+    /**
+     * @brief Top up the ring from the file. I/O thread.
+     * 
+     * @return int32_t Number of frames read from the file
+     */
+    int32_t fill(void);
+
+    /**
+     * @brief Get the number of read() calls that were missing frames
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumUnderruns(void) const { return m_Underruns.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief Get the prefetch horizon in frames
+     * 
+     * @return int32_t 
+     */
+    int32_t getHorizon(void) const { return (int32_t)m_Ring.size(); };
+
+private:
+    void closeFile(void);
+
+    // request, written by the audio thread before m_Gen is incremented
+    std::atomic<const std::string *> m_ReqPath{NULL};
+    std::atomic<int32_t> m_ReqFrom{0};
+    std::atomic<int32_t> m_ReqEnd{0};
+    std::atomic<uint32_t> m_Gen{0};
+
+    // progress, written by the I/O thread
+    std::atomic<uint32_t> m_FillGen{0};
+    std::atomic<int32_t> m_WritePos{0};
+    std::atomic<int32_t> m_ReadPos{0};
+    std::atomic<int32_t> m_Underruns{0};
+
+    std::vector<int16_t> m_Ring;
+    int32_t m_Mask = 0;
+
+    // I/O thread only
+    void *m_File = NULL; // SNDFILE
+    int32_t m_FilePos = 0;
+    int32_t m_FileEnd = 0;
+    std::vector<float32_t> m_Scratch;
+};
+
+/**
+ * @brief Background I/O thread filling a fixed set of CSampleStream, e.g. one
+ * per voice of a CSampler, and loading or unloading the CSampleAsset posted 
+ * by the audio thread (see post()). The thread serves the requests in order,
+ * then polls the streams, and sleeps for a millisecond whenever there was 
+ * nothing to do.
+ */
+class CSampleStreamer
+{
+public:
+    /**
+     * @brief Construct a new CSampleStreamer object
+     * 
+     */
+    CSampleStreamer() {};
+
+    /**
+     * @brief Destroy the CSampleStreamer object, joining the I/O thread
+     * 
+     */
+    ~CSampleStreamer() { deinit(); };
+
+    CSampleStreamer(const CSampleStreamer &) = delete;
+    CSampleStreamer &operator=(const CSampleStreamer &) = delete;
+
+    /**
+     * @brief Allocate the streams and the request queue and start the I/O
+     * thread
+     * 
+     * @param numStreams 
+     * @param horizon Prefetch horizon of each stream in frames
+     * @param numRequests Capacity of the request queue, rounded up to a power
+     * of 2
+     * @param ioThread Whether to start the I/O thread, otherwise the streams
+     * are filled and the requests served by fill() only
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t init(cint32_t numStreams, cint32_t horizon, cint32_t numRequests = 0,
+        const bool_t ioThread = true);
+
+    /**
+     * @brief Serve the pending requests and top up all streams once, from the
+     * calling thread. Only without I/O thread, e.g. to stream 
+     * deterministically in tests.
+     * 
+     * @return int32_t Number of requests served and frames read from the files
+     */
+    int32_t fill(void);
+
+    /**
+     * @brief Stop the I/O thread and free the streams. Pending requests are
+     * dropped.
+     * 
+     */
+    void deinit(void);
+
+    /**
+     * @brief Ask the I/O thread to load() or unload() asset. Audio thread,
+     * wait-free. The request is served once isDone(getNumPosted()).
+     * 
+     * @param asset Must not be played until then, if unloaded
+     * @param load 
+     * @return int32_t 0 on success, -1 if the queue is full
+     */
+    int32_t post(CSampleAsset *asset, const bool_t load);
+
+    /**
+     * @brief Get the number of requests posted since init(), i.e. the ticket
+     * of the last one
+     * 
+     * @return uint32_t 
+     */
+    uint32_t getNumPosted(void) const { return m_Posted.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief Whether the request of ticket, and all the ones before, were
+     * served. Their effect on the assets is visible to the caller once true.
+     * 
+     * @param ticket 
+     * @return bool_t 
+     */
+    bool_t isDone(cuint32_t ticket) const
+    {
+        return (int32_t)(m_Served.load(std::memory_order_acquire) - ticket) >= 0;
+    };
+
+    /**
+     * @brief Get stream i
+     * 
+     * @param i 
+     * @return CSampleStream& 
+     */
+    CSampleStream &getStream(cint32_t i) { return m_Streams[i]; };
+
+    /**
+     * @brief Get the number of streams
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumStreams(void) const { return m_NumStreams; };
+
+    /**
+     * @brief Get the number of read() calls of all streams that were missing
+     * frames
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumUnderruns(void) const;
+
+private:
+    void run(void);
+
+    typedef struct
+    {
+        CSampleAsset *asset;
+        bool_t load;
+    }tRequest;
+
+    std::unique_ptr<CSampleStream[]> m_Streams;
+    int32_t m_NumStreams = 0;
+    std::vector<tRequest> m_Requests; // ring, written by the audio thread up to m_Posted
+    uint32_t m_RequestMask = 0;
+    std::atomic<uint32_t> m_Posted{0};
+    std::atomic<uint32_t> m_Served{0};
+    std::thread m_Thread;
+    std::atomic<bool_t> m_Running{false};
+};
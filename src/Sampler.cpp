@@ -0,0 +1,453 @@
+#include "Sampler.h"
+#include <string.h>
+
+int32_t CSampler::addSample(CSampleParams const& params, cint32_t us, cint32_t ds)
+{
+    std::unique_ptr<CSample> sample(new CSample(params));
+    if (!sample->isLoaded())
+        return -1;
+    // the zone only keeps its pitch, the voices hold the resamplers
+    if (us != 1 || ds != 1)
+        sample.reset(new CSample(*sample, 0, 0, us, ds));
+
+    m_MemorySize += sample->getMemorySize();
+    m_Samples.push_back(std::move(sample));
+    return (int32_t)m_Samples.size() - 1;
+}
+
+int32_t CSampler::init(cint32_t numVoices, cint32_t horizon, const bool_t ioThread)
+{
+    if (numVoices <= 0)
+        return -1;
+
+    // voices are default constructed in place, in append mode
+    m_Streamer.deinit();
+    std::vector<CSample>(numVoices).swap(m_Voices);
+    for (auto &voice : m_Voices)
+    {
+        for (auto &sample : m_Samples)
+            voice.addResampler(sample->getUsFactor(), sample->getDsFactor());
+    }
+    bool_t streamed = false;
+    for (auto &sample : m_Samples)
+        streamed = streamed || sample->isStreamed();
+    // a zone has at most an unload and a load request pending
+    cint32_t numZones = (int32_t)m_Samples.size();
+    if (0 != m_Streamer.init(streamed ? numVoices : 0, horizon, 2 * numZones, ioThread))
+        return -1;
+    for (auto i = 0; i < m_Streamer.getNumStreams(); i++)
+        m_Voices[i].setStream(&m_Streamer.getStream(i));
+    m_VoiceKey.assign(numVoices, -1);
+    m_VoiceZone.assign(numVoices, -1);
+    m_VoiceStart.assign(numVoices, 0);
+    m_Pending.resize(numVoices);
+    m_NumPending = 0;
+    initZones();
+    m_Active.assign(numVoices, -1);
+    m_Free.resize(numVoices);
+    // pop voice 0 first
+    for (auto i = 0; i < numVoices; i++)
+        m_Free[i] = numVoices - 1 - i;
+    m_NumActive = 0;
+    m_NumFree = numVoices;
+    m_NumStolen = 0;
+    m_NumUnderruns = 0;
+    buildIndex();
+    return 0;
+}
+
+void CSampler::initZones(void)
+{
+    // the resident zones are ready, and listed in zone order
+    cint32_t numZones = (int32_t)m_Samples.size();
+    m_ZoneVoices.assign(numZones, 0);
+    m_ZoneLastUse.assign(numZones, 0);
+    m_ZoneWanted.assign(numZones, false);
+    m_ZoneLoading.assign(numZones, false);
+    m_ZoneTicket.assign(numZones, 0);
+    m_ZoneSize.assign(numZones, 0);
+    m_Loading.resize(numZones);
+    m_NumLoading = 0;
+    m_LruPrev.assign(numZones, UNLISTED);
+    m_LruNext.assign(numZones, -1);
+    m_LruHead = -1;
+    m_LruTail = -1;
+    m_UseClock = 1; // zones never used are older than any note on
+    size_t memorySize = 0;
+    for (auto z = 0; z < numZones; z++)
+    {
+        if (m_Samples[z]->isResident())
+        {
+            m_ZoneWanted[z] = true;
+            m_ZoneSize[z] = m_Samples[z]->getMemorySize();
+            memorySize += m_ZoneSize[z];
+            lruPush(z);
+        }
+    }
+    m_MemorySize.store(memorySize, std::memory_order_relaxed);
+}
+
+int32_t CSampler::noteOn(cint32_t key, cint32_t vel)
+{
+    if (key < 0 || key >= NUM_KEYS || vel < 0 || vel >= NUM_VELS)
+        return -1;
+
+    int32_t started = 0;
+    if (m_IndexBegin.empty())
+        return started;
+
+    cint32_t c = cell(key, vel);
+    cuint32_t rr = m_RoundRobin[key]++;
+    m_UseClock++;
+    for (auto i = m_IndexBegin[c]; i < m_IndexBegin[c + 1]; i++)
+    {
+        cint32_t zone = m_IndexZones[i];
+        const CSample &sample = *m_Samples[zone];
+        cint32_t seqLength = sample.getSeqLength();
+        if (seqLength > 1 && (int32_t)(rr % seqLength) != sample.getSeqPosition() - 1)
+            continue;
+        if (0 != useZone(zone))
+            continue;
+
+        if (m_NumFree > 0 && isReady(zone))
+        {
+            startVoice(m_Free[--m_NumFree], zone, key, m_UseClock);
+        }
+        else if (m_NumPending < (int32_t)m_Pending.size())
+        {
+            // the note starts once its zone is loaded and a voice is free
+            if (m_NumFree == 0)
+                stealVoice();
+            m_Pending[m_NumPending++] = {zone, key, m_UseClock};
+            holdZone(zone);
+        }
+        else
+        {
+            break;
+        }
+        started++;
+    }
+
+    // prefetch the neighbours, room is made by the next play()
+    for (auto k : {key - 1, key + 1})
+    {
+        if (k < 0 || k >= NUM_KEYS)
+            continue;
+        cint32_t n = cell(k, vel);
+        for (auto i = m_IndexBegin[n]; i < m_IndexBegin[n + 1]; i++)
+            useZone(m_IndexZones[i]);
+    }
+    return started;
+}
+
+void CSampler::noteOff(cint32_t key)
+{
+    // queued notes of key never start
+    int32_t n = 0;
+    for (auto i = 0; i < m_NumPending; i++)
+    {
+        if (m_Pending[i].key == key)
+            releaseZone(m_Pending[i].zone);
+        else
+            m_Pending[n++] = m_Pending[i];
+    }
+    m_NumPending = n;
+
+    for (auto i = 0; i < m_NumActive; i++)
+    {
+        cint32_t voice = m_Active[i];
+        if (m_VoiceKey[voice] == key && !m_Voices[voice].isReleasing())
+            offVoice(voice);
+    }
+}
+
+void CSampler::allNotesOff(void)
+{
+    for (auto i = 0; i < m_NumPending; i++)
+        releaseZone(m_Pending[i].zone);
+    m_NumPending = 0;
+
+    for (auto i = 0; i < m_NumActive; i++)
+    {
+        cint32_t voice = m_Active[i];
+        if (!m_Voices[voice].isReleasing())
+            offVoice(voice);
+    }
+}
+
+void CSampler::offVoice(cint32_t voice)
+{
+    CSample &sample = m_Voices[voice];
+    // no release nor fade out: a short fade instead of a click
+    if (sample.hasTail())
+        sample.off();
+    else
+        sample.fadeOut(STEAL_FADE_S);
+}
+
+void CSampler::play(float32_t * const p_out, cint32_t blocksize)
+{
+    if (NULL != p_out)
+    {
+        memset(p_out, 0, blocksize * sizeof(float32_t));
+        pollLoads();
+        evictZones();
+        startPending();
+        // the streams count their read() calls that missed frames, possibly several per block
+        cint32_t underruns = (m_Streamer.getNumStreams() > 0) ? m_Streamer.getNumUnderruns() : 0;
+        int32_t i = 0;
+        while (i < m_NumActive)
+        {
+            CSample &voice = m_Voices[m_Active[i]];
+            voice.play(p_out, blocksize);
+            if (voice.isFinished())
+                freeVoice(i); // the last active voice moves to i
+            else
+                i++;
+        }
+        if (m_Streamer.getNumStreams() > 0 && m_Streamer.getNumUnderruns() != underruns)
+            m_NumUnderruns++;
+    }
+}
+
+void CSampler::startVoice(cint32_t voice, cint32_t zone, cint32_t key, cuint32_t clock)
+{
+    m_Voices[voice].setSource(*m_Samples[zone]);
+    m_Voices[voice].on();
+    m_VoiceKey[voice] = key;
+    m_VoiceZone[voice] = zone;
+    m_VoiceStart[voice] = clock;
+    holdZone(zone);
+    m_Active[m_NumActive++] = voice;
+}
+
+void CSampler::startPending(void)
+{
+    // in order, but notes of zones still loading let the next ones start
+    int32_t n = 0;
+    for (auto i = 0; i < m_NumPending; i++)
+    {
+        const tPending note = m_Pending[i];
+        if (!m_ZoneWanted[note.zone])
+        {
+            releaseZone(note.zone); // the zone could not be loaded
+        }
+        else if (m_NumFree > 0 && isReady(note.zone))
+        {
+            m_ZoneVoices[note.zone]--; // held again by startVoice()
+            startVoice(m_Free[--m_NumFree], note.zone, note.key, note.clock);
+        }
+        else
+        {
+            m_Pending[n++] = note;
+        }
+    }
+    m_NumPending = n;
+}
+
+void CSampler::stealVoice(void)
+{
+    cint32_t pos = findVictim();
+    if (pos < 0)
+        return; // all voices are being stolen already
+
+    // the voice leaves its key, so that it is neither turned off nor stolen again
+    cint32_t voice = m_Active[pos];
+    m_Voices[voice].fadeOut(STEAL_FADE_S);
+    m_VoiceKey[voice] = -1;
+    m_NumStolen++;
+}
+
+int32_t CSampler::findVictim(void)
+{
+    int32_t victim = -1;
+    bool_t victimReleasing = false;
+    float32_t victimLevel = 0.0F;
+    int32_t victimLeft = 0;
+    uint32_t victimStart = 0;
+    for (auto i = 0; i < m_NumActive; i++)
+    {
+        cint32_t voice = m_Active[i];
+        if (m_VoiceKey[voice] < 0)
+            continue;
+        const CSample &sample = m_Voices[voice];
+        const bool_t releasing = sample.isReleasing();
+        cfloat32_t level = sample.getLevel();
+        cint32_t left = sample.getNumSamplesUntilFinished();
+        cuint32_t start = m_VoiceStart[voice];
+
+        bool_t better;
+        if (victim < 0)
+            better = true;
+        else if (releasing != victimReleasing)
+            better = releasing;
+        else if (releasing && level != victimLevel)
+            better = level < victimLevel;
+        else if (!releasing && left != victimLeft)
+            better = left < victimLeft;
+        else
+            better = (m_UseClock - start) > (m_UseClock - victimStart);
+
+        if (better)
+        {
+            victim = i;
+            victimReleasing = releasing;
+            victimLevel = level;
+            victimLeft = left;
+            victimStart = start;
+        }
+    }
+    return victim;
+}
+
+void CSampler::freeVoice(cint32_t pos)
+{
+    cint32_t voice = m_Active[pos];
+    m_Active[pos] = m_Active[--m_NumActive];
+    m_VoiceKey[voice] = -1;
+    releaseZone(m_VoiceZone[voice]);
+    m_VoiceZone[voice] = -1;
+    m_Free[m_NumFree++] = voice;
+}
+
+void CSampler::buildIndex(void)
+{
+    cint32_t numCells = NUM_KEYS * NUM_VELS;
+    m_IndexBegin.assign(numCells + 1, 0);
+    m_RoundRobin.assign(NUM_KEYS, 0);
+
+    // count the zones per cell, then fill the cells in zone order
+    auto forEachCell = [&](auto fn)
+    {
+        for (auto z = 0; z < (int32_t)m_Samples.size(); z++)
+        {
+            CSample &sample = *m_Samples[z];
+            for (auto key = MAX(sample.getLowKey(), 0); key <= MIN(sample.getHighKey(), NUM_KEYS - 1); key++)
+                for (auto vel = MAX(sample.getLowVel(), 0); vel <= MIN(sample.getHighVel(), NUM_VELS - 1); vel++)
+                    fn(cell(key, vel), z);
+        }
+    };
+
+    forEachCell([&](cint32_t c, cint32_t)
+                { m_IndexBegin[c + 1]++; });
+    for (auto c = 0; c < numCells; c++)
+        m_IndexBegin[c + 1] += m_IndexBegin[c];
+
+    m_IndexZones.resize(m_IndexBegin[numCells]);
+    std::vector<int32_t> fill(m_IndexBegin.begin(), m_IndexBegin.end() - 1);
+    forEachCell([&](cint32_t c, cint32_t z)
+                { m_IndexZones[fill[c]++] = z; });
+}
+
+int32_t CSampler::useZone(cint32_t zone)
+{
+    m_ZoneLastUse[zone] = m_UseClock;
+    if (m_ZoneWanted[zone])
+    {
+        // most recently used, if listed
+        if (UNLISTED != m_LruPrev[zone])
+        {
+            lruRemove(zone);
+            lruPush(zone);
+        }
+        return 0;
+    }
+
+    if (0 != m_Streamer.post(m_Samples[zone]->getOwnedAsset(), true))
+        return -1;
+    m_ZoneWanted[zone] = true;
+    m_ZoneLoading[zone] = true;
+    m_ZoneTicket[zone] = m_Streamer.getNumPosted();
+    m_Loading[m_NumLoading++] = zone;
+    return 0;
+}
+
+void CSampler::pollLoads(void)
+{
+    int32_t n = 0;
+    for (auto i = 0; i < m_NumLoading; i++)
+    {
+        cint32_t zone = m_Loading[i];
+        if (!m_Streamer.isDone(m_ZoneTicket[zone]))
+        {
+            m_Loading[n++] = zone;
+            continue;
+        }
+
+        m_ZoneLoading[zone] = false;
+        if (m_Samples[zone]->isResident())
+        {
+            m_ZoneSize[zone] = m_Samples[zone]->getMemorySize();
+            m_MemorySize += m_ZoneSize[zone];
+            if (0 == m_ZoneVoices[zone])
+                lruPush(zone);
+        }
+        else
+        {
+            m_ZoneWanted[zone] = false; // its queued notes are dropped
+        }
+    }
+    m_NumLoading = n;
+}
+
+void CSampler::evictZones(void)
+{
+    // the zones of the current note on stay
+    const size_t budget = m_MemoryBudget.load(std::memory_order_relaxed);
+    while (budget > 0 && m_MemorySize.load(std::memory_order_relaxed) > budget &&
+           m_LruHead >= 0 && m_ZoneLastUse[m_LruHead] != m_UseClock)
+    {
+        cint32_t zone = m_LruHead;
+        if (0 != m_Streamer.post(m_Samples[zone]->getOwnedAsset(), false))
+            break;
+        lruRemove(zone);
+        m_ZoneWanted[zone] = false;
+        // the asset belongs to the I/O thread once posted, not to be read here
+        m_MemorySize -= m_ZoneSize[zone];
+        m_ZoneSize[zone] = 0;
+    }
+}
+
+void CSampler::holdZone(cint32_t zone)
+{
+    if (0 == m_ZoneVoices[zone]++)
+        lruRemove(zone);
+}
+
+void CSampler::releaseZone(cint32_t zone)
+{
+    if (0 == --m_ZoneVoices[zone] && isReady(zone))
+        lruPush(zone);
+}
+
+void CSampler::lruPush(cint32_t zone)
+{
+    if (UNLISTED != m_LruPrev[zone] || !m_Samples[zone]->getAsset()->canUnload())
+        return;
+
+    m_LruPrev[zone] = m_LruTail;
+    m_LruNext[zone] = -1;
+    if (m_LruTail >= 0)
+        m_LruNext[m_LruTail] = zone;
+    else
+        m_LruHead = zone;
+    m_LruTail = zone;
+}
+
+void CSampler::lruRemove(cint32_t zone)
+{
+    if (UNLISTED == m_LruPrev[zone])
+        return;
+
+    cint32_t prev = m_LruPrev[zone];
+    cint32_t next = m_LruNext[zone];
+    if (prev >= 0)
+        m_LruNext[prev] = next;
+    else
+        m_LruHead = next;
+    if (next >= 0)
+        m_LruPrev[next] = prev;
+    else
+        m_LruTail = prev;
+    m_LruPrev[zone] = UNLISTED;
+}
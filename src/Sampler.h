@@ -0,0 +1,365 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "AudioTypes.h"
+#include "Sample.h"
+#include "SampleStream.h"
+
+/**
+ * @brief Polyphonic sampler: a set of zones, each a CSample loaded from
+ * CSampleParams, played by a fixed pool of voices preallocated in init().
+ * A note on starts one voice per zone whose key and velocity ranges contain
+ * the note, a note off turns off the voices of its key. The zones of each 
+ * key and velocity are indexed by init(), so a note on resolves with one 
+ * lookup, whatever the size of the library. Zones of a round-robin group 
+ * (CSampleParams::seq_length > 1) take turns: the n-th note on a key, 
+ * whatever its velocity, plays the zones whose seq_position is n modulo
+ * seq_length, the zones without group play every time. play() mixes all
+ * active voices into the block, at a cost linear in the number of active
+ * voices, whatever the number of zones or voices in the pool.
+ * 
+ * When no voice is free, one is stolen: the releasing voice with the lowest
+ * envelope level or, if none is releasing, the one closest to its end, then 
+ * the oldest one. The stolen voice fades out over STEAL_FADE_S rather than 
+ * being cut, as do the voices turned off without release nor fade out, and
+ * the note waits in a queue until the voice is back in the pool, at the 
+ * start of a later block.
+ * 
+ * Lazy zones (see CSampleParams::lazy) are decoded by the I/O thread of the
+ * sampler (see CSampleStreamer::post()), at the request of the first note on
+ * that plays them, which also prefetches the zones of the neighbouring keys
+ * at the same velocity. The note waits in the queue until its zone is 
+ * resident. With a memory budget, the least recently used zones that are not
+ * playing are unloaded by the I/O thread until the decoded audio fits the 
+ * budget; they are decoded again when played. These zones are kept in an 
+ * intrusive LRU list, so that eviction does not depend on the number of zones.
+ * 
+ * Voices of streamed zones (see CSampleParams::preload_s) each get a 
+ * CSampleStream, filled by the same I/O thread.
+ * 
+ * Zones are added and the pool is sized from the control thread, before
+ * playing. noteOn(), noteOff(), allNotesOff() and play() then belong to the
+ * audio thread, e.g. with the note events dispatched between blocks: they
+ * neither allocate nor wait.
+ */
+class CSampler
+{
+public:
+    static constexpr int32_t NUM_KEYS = 128;
+    static constexpr int32_t NUM_VELS = 128;
+    static constexpr int32_t DEFAULT_HORIZON = 16384;
+    static constexpr float32_t STEAL_FADE_S = 0.005F; // fade out of the stolen voices
+
+    /**
+     * @brief Construct a new CSampler object
+     * 
+     */
+    CSampler() {};
+
+    /**
+     * @brief Destroy the CSampler object
+     * 
+     */
+    ~CSampler() {};
+
+    /**
+     * @brief Load a zone
+     * 
+     * @param params 
+     * @param us Upsampling factor of the pitch of the zone
+     * @param ds Downsampling factor
+     * @return int32_t Index of the zone, -1 if it could not be loaded
+     */
+    int32_t addSample(CSampleParams const& params, cint32_t us = 1, cint32_t ds = 1);
+
+    /**
+     * @brief Allocate the voice pool and index the zones added so far. All
+     * voices are stopped. Each voice gets a resampler per pitch of the zones.
+     * 
+     * @param numVoices Maximum polyphony
+     * @param horizon Prefetch horizon of the streamed zones, in frames
+     * @param ioThread Whether the zones are loaded and streamed by an I/O 
+     * thread, otherwise by runIO()
+     * @return int32_t 0 on success, -1 on error
+     */
+    int32_t init(cint32_t numVoices, cint32_t horizon = DEFAULT_HORIZON, const bool_t ioThread = true);
+
+    /**
+     * @brief Start a voice for each zone matching key and vel, stealing 
+     * voices if the pool is exhausted. Wait-free.
+     * 
+     * @param key 
+     * @param vel 
+     * @return int32_t Number of voices started or queued until a stolen voice
+     * is free, -1 on invalid key or velocity
+     */
+    int32_t noteOn(cint32_t key, cint32_t vel);
+
+    /**
+     * @brief Turn off the voices playing key. Its notes still queued are
+     * dropped.
+     * 
+     * @param key 
+     */
+    void noteOff(cint32_t key);
+
+    /**
+     * @brief Turn off all voices
+     * 
+     */
+    void allNotesOff(void);
+
+    /**
+     * @brief Mix the active voices into the block. Finished voices go back to
+     * the pool.
+     * 
+     * @param p_out 
+     * @param blocksize 
+     */
+    void play(float32_t * const p_out, cint32_t blocksize);
+
+    /**
+     * @brief Set the memory budget of the decoded audio of the zones, met from
+     * the next block on. Any thread.
+     * 
+     * @param bytes 0 for no budget
+     */
+    void setMemoryBudget(const size_t bytes) { m_MemoryBudget.store(bytes, std::memory_order_relaxed); };
+
+    /**
+     * @brief Get the memory used by the decoded audio of the zones, as of the
+     * last block: zones being loaded are not counted yet, the ones being 
+     * unloaded not anymore
+     * 
+     * @return size_t Bytes
+     */
+    size_t getMemorySize(void) const { return m_MemorySize.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief Whether the audio of a zone is in memory, as published by the I/O
+     * thread
+     * 
+     * @param zone 
+     * @return bool_t 
+     */
+    bool_t isResident(cint32_t zone) const { return m_Samples[zone]->isResident(); };
+
+    /**
+     * @brief Get the number of zones
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumSamples(void) const { return (int32_t)m_Samples.size(); };
+
+    /**
+     * @brief Get the size of the voice pool
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumVoices(void) const { return (int32_t)m_Voices.size(); };
+
+    /**
+     * @brief Get the number of voices currently playing
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumActiveVoices(void) const { return m_NumActive; };
+
+    /**
+     * @brief Get the number of voices stolen since init()
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumStolen(void) const { return m_NumStolen; };
+
+    /**
+     * @brief Get the number of blocks that missed streamed frames, since init()
+     * 
+     * @return int32_t 
+     */
+    int32_t getNumUnderruns(void) const { return m_NumUnderruns; };
+
+    /**
+     * @brief Do the work of the I/O thread once from the calling thread, if
+     * init() started none: load and unload the requested zones and top up the
+     * streams of the voices
+     * 
+     * @return int32_t Number of zones loaded or unloaded and frames streamed
+     */
+    int32_t runIO(void) { return m_Streamer.fill(); };
+
+protected:
+    /**
+     * @brief Start the voice taken from the pool on zone
+     * 
+     * @param voice 
+     * @param zone 
+     * @param key 
+     * @param clock Note on count of the note
+     */
+    void startVoice(cint32_t voice, cint32_t zone, cint32_t key, cuint32_t clock);
+
+    /**
+     * @brief Start the queued notes, in order, as long as the pool has voices
+     * 
+     */
+    void startPending(void);
+
+    /**
+     * @brief Fade out the victim, if any, which goes back to the pool when
+     * finished
+     * 
+     */
+    void stealVoice(void);
+
+    /**
+     * @brief Find the active voice to steal, among the ones not stolen yet
+     * 
+     * @return int32_t Position of the voice in m_Active, -1 if none
+     */
+    int32_t findVictim(void);
+
+    /**
+     * @brief Turn off a voice, fading it out shortly if it has neither a
+     * release nor a fade out
+     * 
+     * @param voice 
+     */
+    void offVoice(cint32_t voice);
+
+    /**
+     * @brief Remove the voice at position pos of m_Active and give it back to
+     * the pool
+     * 
+     * @param pos 
+     */
+    void freeVoice(cint32_t pos);
+
+    /**
+     * @brief Mark a zone as used by the current note on and ask the I/O thread
+     * to load it if needed
+     * 
+     * @param zone 
+     * @return int32_t 0 on success, -1 if the request queue is full
+     */
+    int32_t useZone(cint32_t zone);
+
+    /**
+     * @brief Whether a zone can be played, i.e. it was requested and its load
+     * was seen by pollLoads()
+     * 
+     * @param zone 
+     * @return bool_t 
+     */
+    bool_t isReady(cint32_t zone) const { return m_ZoneWanted[zone] && !m_ZoneLoading[zone]; };
+
+    /**
+     * @brief Account for the zones the I/O thread has loaded since the last 
+     * block
+     * 
+     */
+    void pollLoads(void);
+
+    /**
+     * @brief Ask the I/O thread to unload the least recently used zones that 
+     * are not playing until the memory budget is met
+     * 
+     */
+    void evictZones(void);
+
+    /**
+     * @brief Count a voice or queued note playing zone, which leaves the LRU 
+     * list
+     * 
+     * @param zone 
+     */
+    void holdZone(cint32_t zone);
+
+    /**
+     * @brief Uncount a voice or queued note of zone, which goes to the end of
+     * the LRU list with the last one
+     * 
+     * @param zone 
+     */
+    void releaseZone(cint32_t zone);
+
+    /**
+     * @brief Append zone to the LRU list, if not listed and it can be unloaded
+     * 
+     * @param zone 
+     */
+    void lruPush(cint32_t zone);
+
+    /**
+     * @brief Remove zone from the LRU list, if listed
+     * 
+     * @param zone 
+     */
+    void lruRemove(cint32_t zone);
+
+    /**
+     * @brief Reset the state of the zones to what is resident
+     * 
+     */
+    void initZones(void);
+
+    /**
+     * @brief Build the key and velocity index of the zones
+     * 
+     */
+    void buildIndex(void);
+
+    /**
+     * @brief Get the index cell of key and vel
+     * 
+     * @param key 
+     * @param vel 
+     * @return int32_t 
+     */
+    static inline int32_t cell(cint32_t key, cint32_t vel) { return key * NUM_VELS + vel; };
+
+    std::vector<std::unique_ptr<CSample>> m_Samples;
+    std::vector<CSample> m_Voices;
+    std::vector<int32_t> m_VoiceKey;
+    std::vector<int32_t> m_VoiceZone;
+    std::vector<uint32_t> m_VoiceStart; // note on count when each voice started
+    std::vector<int32_t> m_ZoneVoices;   // number of voices playing each zone, and queued notes
+    std::vector<uint32_t> m_ZoneLastUse; // note on count when each zone was last used
+    std::vector<bool_t> m_ZoneWanted;    // resident or requested, audio thread view
+    std::vector<bool_t> m_ZoneLoading;   // load requested, not seen done yet
+    std::vector<uint32_t> m_ZoneTicket;  // last request to the I/O thread
+    std::vector<size_t> m_ZoneSize;      // memory of each ready zone, counted in m_MemorySize
+    std::vector<int32_t> m_Loading;      // zones loading, the first m_NumLoading are valid
+    int32_t m_NumLoading = 0;
+    // LRU list of the ready zones that are not playing, least recent first
+    static constexpr int32_t UNLISTED = -2;
+    std::vector<int32_t> m_LruPrev;      // UNLISTED if not in the list
+    std::vector<int32_t> m_LruNext;
+    int32_t m_LruHead = -1;
+    int32_t m_LruTail = -1;
+    uint32_t m_UseClock = 0;
+    std::atomic<size_t> m_MemoryBudget{0};
+    std::atomic<size_t> m_MemorySize{0};
+    // zones of cell c are m_IndexZones[m_IndexBegin[c]] to m_IndexZones[m_IndexBegin[c + 1] - 1]
+    std::vector<int32_t> m_IndexBegin;
+    std::vector<int32_t> m_IndexZones;
+    std::vector<uint32_t> m_RoundRobin; // note on count per key
+    std::vector<int32_t> m_Active; // voices playing, the first m_NumActive are valid
+    std::vector<int32_t> m_Free;   // voices in the pool, the first m_NumFree are valid
+    int32_t m_NumActive = 0;
+    int32_t m_NumFree = 0;
+    int32_t m_NumStolen = 0;
+    int32_t m_NumUnderruns = 0;
+
+    typedef struct
+    {
+        int32_t zone;
+        int32_t key;
+        uint32_t clock;
+    }tPending;
+    std::vector<tPending> m_Pending; // notes waiting for a voice or their zone, the first m_NumPending are valid
+    int32_t m_NumPending = 0;
+    CSampleStreamer m_Streamer; // destroyed first, stopping the I/O thread
+};
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "AtomBiquadFixed.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+/**
+ * @brief Play ref and fixed on the same input, with parameter changes,
+ *        morphs and silent stretches, and compare their outputs
+ */
+static void compareFixed(CAtomBiquad &ref, CAtomBiquad &fixed, const CQuarkProps &props)
+{
+    cint32_t nch = props.m_NumChOut;
+    cint32_t bs = props.m_BlockSize;
+    std::vector<float32_t> bufRef(nch * bs), bufFixed(nch * bs);
+    std::vector<float32_t *> pRef, pFixed;
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        pRef.push_back(&bufRef[ch * bs]);
+        pFixed.push_back(&bufFixed[ch * bs]);
+    }
+
+    for (auto n = 0; n < 300; n++)
+    {
+        if (n % 100 == 0)
+        {
+            for (auto atom : {&ref, &fixed})
+            {
+                atom->setMorphMs((n == 100) ? 20.0F : 0.0F);
+                for (auto ch = 0; ch < nch; ch++)
+                {
+                    // last section stays bypassed
+                    for (auto el = 0; el < props.m_NumEl - 1; el++)
+                    {
+                        CAtomBiquad::tAtomBiquadParams params = {
+                            ch, el, CAtomBiquad::eBiquadType::BIQT_PEAK, 200.0F * (el + 1) + n, 1.5F, 6.0F - el};
+                        atom->set(&params, sizeof(params));
+                    }
+                }
+            }
+        }
+        // silent from block 250 on
+        for (auto i = 0; i < nch * bs; i++)
+            bufRef[i] = bufFixed[i] = (n < 250) ? 0.5F * sinf(0.01F * (n * nch * bs + i)) : 0.0F;
+
+        ref.process(pRef.data(), pRef.data());
+        fixed.process(pFixed.data(), pFixed.data());
+        for (auto i = 0; i < nch * bs; i++)
+            ASSERT_NEAR(bufRef[i], bufFixed[i], 1.E-6F) << "block " << n << " sample " << i;
+    }
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(AtomBiquadFixed, Matches_Generic)
+{
+    CQuarkProps props2 = {48000, 64, 2, 2, 0, 0, 4};
+    CAtomBiquad ref2;
+    CAtomBiquadFixed<2, 4, 64> fixed2;
+    ASSERT_EQ(0, ref2.init(props2));
+    ASSERT_EQ(0, fixed2.init(props2));
+    compareFixed(ref2, fixed2, props2);
+
+    CQuarkProps props1 = {48000, 32, 1, 1, 0, 0, 1};
+    CAtomBiquad ref1;
+    CAtomBiquadFixed<1, 1, 32> fixed1;
+    ASSERT_EQ(0, ref1.init(props1));
+    ASSERT_EQ(0, fixed1.init(props1));
+    compareFixed(ref1, fixed1, props1);
+}
+
+TEST(AtomBiquadFixed, Props_Mismatch)
+{
+    CAtomBiquadFixed<2, 4, 64> fixed;
+    ASSERT_EQ(-1, fixed.init({48000, 128, 2, 2, 0, 0, 4}));
+    ASSERT_EQ(-1, fixed.init({48000, 64, 1, 1, 0, 0, 4}));
+    ASSERT_EQ(-1, fixed.init({48000, 64, 2, 2, 0, 0, 2}));
+    ASSERT_EQ(0, fixed.init({48000, 64, 2, 2, 0, 0, 4}));
+}
+
+TEST(AtomBiquadFixed, Factory)
+{
+    CQuarkProps props = {48000, 128, 2, 2, 0, 0, 8};
+    ASSERT_TRUE(CAtomBiquadFactory::isSpecialized(props));
+    std::unique_ptr<CAtomBiquad> fixed = CAtomBiquadFactory::create(props);
+    ASSERT_NE(nullptr, fixed);
+    using tFixed = CAtomBiquadFixed<2, 8, 128>;
+    ASSERT_NE(nullptr, dynamic_cast<tFixed *>(fixed.get()));
+
+    // not precompiled: generic atom
+    props.m_NumEl = 3;
+    ASSERT_FALSE(CAtomBiquadFactory::isSpecialized(props));
+    std::unique_ptr<CAtomBiquad> generic = CAtomBiquadFactory::create(props);
+    ASSERT_NE(nullptr, generic);
+    CAtomBiquad ref;
+    ASSERT_EQ(0, ref.init(props));
+    compareFixed(ref, *generic, props);
+}
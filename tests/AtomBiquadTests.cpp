@@ -376,6 +376,67 @@ TEST_F(AtomBiquad, APF_500Hz_0707q_0dB_IR)
         1);
 }
 
+TEST_F(AtomBiquad, Bypass_Sections_Skipped)
+{
+    MySetUp(1, 3);
+
+    CAtomBiquad biquadRef;
+    biquadRef.init({m_Fs, m_Blocksize, 1, 1, 0, 0, 1});
+
+    CAtomBiquad::tAtomBiquadParams params[] = {
+        {0, 0, CAtomBiquad::eBiquadType::BIQT_BYPASS, 1000.0F, 0.707F, 0.0F},
+        {0, 1, CAtomBiquad::eBiquadType::BIQT_LPF, 500.0F, 0.707F, 0.0F},
+        {0, 2, CAtomBiquad::eBiquadType::BIQT_BYPASS, 1000.0F, 0.707F, 0.0F},
+    };
+    CAtomBiquad::tAtomBiquadParams paramsRef = {0, 0, CAtomBiquad::eBiquadType::BIQT_LPF, 500.0F, 0.707F, 0.0F};
+    m_Biquad.set(params, sizeof(params));
+    biquadRef.set(&paramsRef, sizeof(paramsRef));
+
+    std::vector<float32_t> outRef(m_Blocksize);
+    float32_t *pOutRef[] = {outRef.data()};
+
+    for (auto n = 0; n < 16; n++)
+    {
+        for (auto i = 0; i < m_Blocksize; i++)
+            m_In[0][i] = sinf(0.05F * (float32_t)(n * m_Blocksize + i));
+        m_Biquad.play(m_In, m_Out);
+        biquadRef.play(m_In, pOutRef);
+        for (auto i = 0; i < m_Blocksize; i++)
+            ASSERT_EQ(outRef[i], m_Out[0][i]);
+    }
+}
+
+TEST_F(AtomBiquad, Silence_Flush_Restart)
+{
+    MySetUp(1, 1);
+
+    CAtomBiquad::tAtomBiquadParams params = {0, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 100.0F, 5.0F, 10.0F};
+    m_Biquad.set(&params, sizeof(params));
+
+    // first impulse response block
+    m_In[0][0] = 1.0F;
+    m_Biquad.play(m_In, m_Out);
+    std::vector<float32_t> firstBlock(m_Out[0], m_Out[0] + m_Blocksize);
+
+    // let the tail decay until the channel is flushed
+    m_In[0][0] = 0.0F;
+    bool_t flushed = false;
+    for (auto n = 0; n < 65536 && !flushed; n++)
+    {
+        m_Biquad.play(m_In, m_Out);
+        flushed = true;
+        for (auto i = 0; i < m_Blocksize; i++)
+            flushed &= (m_Out[0][i] == 0.0F);
+    }
+    ASSERT_TRUE(flushed);
+
+    // states are cleared, so a new impulse gives the very same response
+    m_In[0][0] = 1.0F;
+    m_Biquad.play(m_In, m_Out);
+    for (auto i = 0; i < m_Blocksize; i++)
+        ASSERT_EQ(firstBlock[i], m_Out[0][i]);
+}
+
 #if 0
 TEST_F(AtomBiquad, APF180_500Hz_0707q_0dB_IR)
 {
@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "AtomChain.h"
+#include "AtomGain.h"
+#include "AtomDiode.h"
+#include "AtomBiquad.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class AtomChain : public ::testing::Test
+{
+protected:
+    int32_t m_Blocksize = 64;
+    int32_t m_Fs = 48000;
+    int32_t m_NumCh = 2;
+    int32_t m_NumEl = 3;
+
+    CAtomChain<CAtomGain, CAtomDiode, CAtomBiquad> m_Chain;
+    CAtomGain m_Gain;
+    CAtomDiode m_Diode;
+    CAtomBiquad m_Biquad;
+
+    std::vector<float32_t> m_BufIn, m_BufRef, m_BufOut;
+    std::vector<float32_t *> m_In, m_Ref, m_Out;
+
+    void SetUp() override
+    {
+        ASSERT_EQ(0, m_Chain.init({m_Fs, m_Blocksize, m_NumCh, m_NumCh}, {1, 1, m_NumEl}));
+        ASSERT_EQ(0, m_Gain.init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 1}));
+        ASSERT_EQ(0, m_Diode.init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 1}));
+        ASSERT_EQ(0, m_Biquad.init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, m_NumEl}));
+
+        m_BufIn.resize(m_NumCh * m_Blocksize);
+        m_BufRef.resize(m_NumCh * m_Blocksize);
+        m_BufOut.resize(m_NumCh * m_Blocksize);
+        for (auto ch = 0; ch < m_NumCh; ch++)
+        {
+            m_In.push_back(&m_BufIn[ch * m_Blocksize]);
+            m_Ref.push_back(&m_BufRef[ch * m_Blocksize]);
+            m_Out.push_back(&m_BufOut[ch * m_Blocksize]);
+        }
+    }
+
+    /**
+     * @brief Apply f to the atoms of the chain and to the reference atoms
+     */
+    template <class F>
+    void setBoth(F f)
+    {
+        f(m_Chain.getAtom<0>(), m_Chain.getAtom<1>(), m_Chain.getAtom<2>());
+        f(m_Gain, m_Diode, m_Biquad);
+    }
+
+    /**
+     * @brief Play one block through the chain and the reference atoms, and
+     *        compare
+     */
+    void playBlock(cint32_t n)
+    {
+        for (size_t i = 0; i < m_BufIn.size(); i++)
+            m_BufIn[i] = 0.8F * sinf(0.02F * (n * m_BufIn.size() + i));
+
+        m_Chain.process(m_In.data(), m_Out.data());
+        m_Gain.process(m_In.data(), m_Ref.data());
+        m_Diode.process(m_Ref.data(), m_Ref.data());
+        m_Biquad.process(m_Ref.data(), m_Ref.data());
+        for (size_t i = 0; i < m_BufIn.size(); i++)
+            ASSERT_NEAR(m_BufRef[i], m_BufOut[i], 1.E-6F) << "block " << n << " sample " << i;
+    }
+
+    static void setParams(CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad, cint32_t n)
+    {
+        gain.set(SET_ALL_CH_IND, 0, 6.0F - 0.1F * n);
+        diode.set(SET_ALL_CH_IND, 0, 500.0F + 10.0F * n);
+        for (auto el = 0; el < 2; el++)
+        {
+            CAtomBiquad::tAtomBiquadParams params = {
+                0, el, CAtomBiquad::eBiquadType::BIQT_PEAK, 300.0F * (el + 1) + n, 1.0F, -3.0F};
+            biquad.set(&params, sizeof(params));
+            params.ch = 1;
+            biquad.set(&params, sizeof(params));
+        }
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(AtomChain, Fused_Matches_Serial)
+{
+    setBoth([](CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad)
+            { setParams(gain, diode, biquad, 0); });
+    for (auto n = 0; n < 100; n++)
+    {
+        playBlock(n);
+        ASSERT_TRUE(m_Chain.isFused());
+    }
+}
+
+TEST_F(AtomChain, Morph_And_Events)
+{
+    setBoth([](CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad)
+            {
+                gain.setMorphMs(10.0F);
+                diode.setMorphMs(5.0F);
+                biquad.setMorphMs(20.0F); });
+    for (auto n = 0; n < 200; n++)
+    {
+        if (n % 50 == 0)
+        {
+            setBoth([n](CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad)
+                    { setParams(gain, diode, biquad, n); });
+        }
+        if (n % 50 == 30)
+        {
+            // mid-block event
+            setBoth([n](CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad)
+                    { ASSERT_EQ(0, gain.post(SET_ALL_CH_IND, 0, -0.05F * n, 17)); });
+        }
+        playBlock(n);
+        if (n % 50 == 0 || n % 50 == 30)
+        {
+            ASSERT_FALSE(m_Chain.isFused());
+        }
+        if (n % 50 == 49)
+        {
+            ASSERT_TRUE(m_Chain.isFused());
+        }
+    }
+}
+
+TEST_F(AtomChain, Channel_Mismatch)
+{
+    CAtomChain<CAtomGain, CAtomBiquad> chain;
+    ASSERT_EQ(-1, chain.init({m_Fs, m_Blocksize, 1, 2, 0, 0, 1}));
+}
@@ -0,0 +1,155 @@
+#include "gtest/gtest.h"
+#include "AtomCrossover.h"
+#include <iostream>
+#include <vector>
+#include <complex>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+struct AtomCrossoverTestParams
+{
+    int32_t type;
+    int32_t nch;
+    int32_t nbands;
+};
+
+class AtomCrossover : public ::testing::TestWithParam<AtomCrossoverTestParams>
+{
+protected:
+    int32_t m_Blocksize = 64;
+    int32_t m_Fs = 48000;
+    int32_t m_NumCh = 0;
+    int32_t m_NumBands = 0;
+    CAtomCrossover m_Crossover;
+    std::vector<std::vector<float32_t>> m_BufIn;
+    std::vector<std::vector<float32_t>> m_BufOut;
+    std::vector<float32_t *> m_In;
+    std::vector<float32_t *> m_Out;
+
+    void MySetUp(cint32_t nch, cint32_t nbands, cint32_t type)
+    {
+        m_NumCh = nch;
+        m_NumBands = nbands;
+        m_BufIn.assign(nch, std::vector<float32_t>(m_Blocksize));
+        m_BufOut.assign(nch * nbands, std::vector<float32_t>(m_Blocksize));
+        for (auto &b : m_BufIn)
+            m_In.push_back(b.data());
+        for (auto &b : m_BufOut)
+            m_Out.push_back(b.data());
+
+        ASSERT_EQ(0, m_Crossover.init({m_Fs, m_Blocksize, nch, nch * nbands, 0, 0, nbands}));
+
+        cfloat32_t freqs[] = {200.F, 1000.F, 5000.F};
+        for (auto xo = 0; xo < nbands - 1; xo++)
+        {
+            CAtomCrossover::tAtomCrossoverParams params = {xo, type, freqs[xo]};
+            m_Crossover.set(&params, sizeof(params));
+        }
+    }
+
+    /**
+     * @brief Process a signal and return, per channel, the sum of all bands
+     *        and the per band signals
+     */
+    void run(const std::vector<float32_t> &sig, std::vector<std::vector<float32_t>> &sum,
+             std::vector<std::vector<float32_t>> &bands)
+    {
+        cint32_t niter = (cint32_t)sig.size() / m_Blocksize;
+        sum.assign(m_NumCh, std::vector<float32_t>(sig.size()));
+        bands.assign(m_NumCh * m_NumBands, std::vector<float32_t>(sig.size()));
+        for (auto n = 0; n < niter; n++)
+        {
+            for (auto ch = 0; ch < m_NumCh; ch++)
+                for (auto i = 0; i < m_Blocksize; i++)
+                    m_In[ch][i] = sig[n * m_Blocksize + i];
+            m_Crossover.play(m_In.data(), m_Out.data());
+            for (auto b = 0; b < m_NumBands; b++)
+                for (auto ch = 0; ch < m_NumCh; ch++)
+                    for (auto i = 0; i < m_Blocksize; i++)
+                    {
+                        cfloat32_t y = m_Out[b * m_NumCh + ch][i];
+                        bands[b * m_NumCh + ch][n * m_Blocksize + i] = y;
+                        sum[ch][n * m_Blocksize + i] += y;
+                    }
+        }
+    }
+};
+
+static float32_t magnitude(const std::vector<float32_t> &ir, cfloat32_t freq, cint32_t fs)
+{
+    std::complex<double> acc = 0.0;
+    for (size_t i = 0; i < ir.size(); i++)
+        acc += (double)ir[i] * std::polar(1.0, -2.0 * M_PI * freq * (double)i / fs);
+    return (float32_t)std::abs(acc);
+}
+
+static float32_t rms(const std::vector<float32_t> &sig, size_t start)
+{
+    double acc = 0.0;
+    for (size_t i = start; i < sig.size(); i++)
+        acc += sig[i] * sig[i];
+    return (float32_t)sqrt(acc / (sig.size() - start));
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_P(AtomCrossover, Allpass_Sum)
+{
+    auto params = GetParam();
+    MySetUp(params.nch, params.nbands, params.type);
+
+    std::vector<float32_t> dirac(16384);
+    dirac[0] = 1.0F;
+    std::vector<std::vector<float32_t>> sum, bands;
+    run(dirac, sum, bands);
+
+    for (auto ch = 0; ch < m_NumCh; ch++)
+    {
+        for (auto freq : {50.F, 200.F, 700.F, 1000.F, 3000.F, 5000.F, 12000.F})
+            ASSERT_NEAR(1.0F, magnitude(sum[ch], freq, m_Fs), 1.E-3F) << "ch " << ch << " freq " << freq;
+    }
+}
+
+TEST_P(AtomCrossover, Band_Separation)
+{
+    auto params = GetParam();
+    MySetUp(params.nch, params.nbands, params.type);
+
+    // one tone in the middle of each band, in octaves
+    cfloat32_t tones[] = {50.F, 450.F, 2200.F, 16000.F};
+    for (auto b = 0; b < m_NumBands; b++)
+    {
+        cfloat32_t tone = (b == m_NumBands - 1) ? tones[3] : tones[b];
+        std::vector<float32_t> sine(16384);
+        for (size_t i = 0; i < sine.size(); i++)
+            sine[i] = sinf(2.F * (float32_t)M_PI * tone * i / m_Fs);
+
+        std::vector<std::vector<float32_t>> sum, bands;
+        run(sine, sum, bands);
+        for (auto ch = 0; ch < m_NumCh; ch++)
+        {
+            cfloat32_t level = rms(bands[b * m_NumCh + ch], 8192);
+            for (auto other = 0; other < m_NumBands; other++)
+            {
+                if (other != b)
+                {
+                    ASSERT_LT(rms(bands[other * m_NumCh + ch], 8192), 0.5F * level);
+                }
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AtomCrossoverP, AtomCrossover,
+                         testing::Values(
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR2, 1, 2},
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR4, 1, 2},
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR4, 2, 3},
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR4, 2, 4},
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR8, 2, 4},
+                             AtomCrossoverTestParams{CAtomCrossover::XOVER_LR2, 1, 4}));
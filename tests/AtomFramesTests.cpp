@@ -0,0 +1,195 @@
+#include "gtest/gtest.h"
+#include "AtomGain.h"
+#include "AtomDiode.h"
+#include "AtomBiquad.h"
+#include "AtomChain.h"
+#include "AtomGraph.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class AtomFrames : public AtomCompareTest
+{
+protected:
+    int32_t m_NumBlocks = 64;
+    int32_t m_ChangeAt = 32 * m_Blocksize; // sample of the second parameter change
+
+    /**
+     * @brief Play a stream through ref in full blocks and through var in
+     *        calls of varying size, with setParams(atom, 0) at the start and
+     *        setParams(atom, 1) at m_ChangeAt, and compare the streams
+     */
+    template <class A, class F>
+    void compare(A &ref, A &var, cint32_t nch, F setParams)
+    {
+        cint32_t len = m_NumBlocks * m_Blocksize;
+        auto in = sines(nch, len, 0.7F, 0.003F);
+        std::vector<std::vector<float32_t>> outRef(nch, std::vector<float32_t>(len));
+        std::vector<std::vector<float32_t>> outVar(nch, std::vector<float32_t>(len));
+
+        auto playAt = [&](A &atom, std::vector<std::vector<float32_t>> &out, cint32_t pos, cint32_t nframes)
+        {
+            std::vector<float32_t *> pIn = pointers(in, pos);
+            std::vector<float32_t *> pOut = pointers(out, pos);
+            atom.process(pIn.data(), pOut.data(), nframes);
+        };
+
+        setParams(ref, 0);
+        for (auto n = 0; n < m_NumBlocks; n++)
+        {
+            if (n * m_Blocksize == m_ChangeAt)
+                setParams(ref, 1);
+            playAt(ref, outRef, n * m_Blocksize, m_Blocksize);
+        }
+
+        setParams(var, 0);
+        uint32_t seed = 12345;
+        for (auto pos = 0; pos < len;)
+        {
+            if (pos == m_ChangeAt)
+                setParams(var, 1);
+            seed = seed * 1103515245U + 12345U;
+            int32_t nframes = 1 + (int32_t)((seed >> 16) % m_Blocksize);
+            if (pos < m_ChangeAt)
+                nframes = MIN(nframes, m_ChangeAt - pos);
+            nframes = MIN(nframes, len - pos);
+            playAt(var, outVar, pos, nframes);
+            pos += nframes;
+        }
+
+        ASSERT_NO_FATAL_FAILURE(expectNear(outRef, outVar, len));
+    }
+};
+
+/**
+ * @brief Atom bypassing or muting its input
+ */
+class CAtomThrough : public CAudioQuark<float32_t>
+{
+public:
+    using CAudioQuark<float32_t>::play;
+    bool_t m_Mute = false;
+
+    void play(float32_t **const in, float32_t **const out) override
+    {
+        if (m_Mute)
+            mute(out);
+        else
+            bypass(in, out);
+    };
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(AtomFrames, Gain_Diode_Biquad_Morph)
+{
+    CAtomGain gains[2];
+    for (auto &gain : gains)
+    {
+        ASSERT_EQ(0, gain.init({m_Fs, m_Blocksize, 2, 2}));
+        gain.setMorphSamples(1000);
+    }
+    compare(gains[0], gains[1], 2, [](CAtomGain &gain, cint32_t k)
+            { gain.set(SET_ALL_CH_IND, 0, k ? -12.0F : 3.0F); });
+
+    CAtomDiode diodes[2];
+    for (auto &diode : diodes)
+    {
+        ASSERT_EQ(0, diode.init({m_Fs, m_Blocksize, 2, 2, 0, 0, 1}));
+        diode.setMorphSamples(500);
+    }
+    compare(diodes[0], diodes[1], 2, [](CAtomDiode &diode, cint32_t k)
+            { diode.set(SET_ALL_CH_IND, 0, k ? 2000.0F : 500.0F); });
+
+    CAtomBiquad biquads[2];
+    for (auto &biquad : biquads)
+    {
+        ASSERT_EQ(0, biquad.init({m_Fs, m_Blocksize, 2, 2, 0, 0, 2}));
+        biquad.setMorphMs(20.0F); // a whole number of blocks, but counted in samples
+    }
+    compare(biquads[0], biquads[1], 2, [](CAtomBiquad &biquad, cint32_t k)
+            {
+                CAtomBiquad::tAtomBiquadParams params[] = {
+                    {0, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, k ? 2000.0F : 200.0F, 1.0F, 6.0F},
+                    {1, 1, CAtomBiquad::eBiquadType::BIQT_LPF, k ? 500.0F : 5000.0F, 0.7F, 0.0F},
+                };
+                biquad.set(params, sizeof(params)); });
+}
+
+TEST_F(AtomFrames, Chain_Graph)
+{
+    typedef CAtomChain<CAtomGain, CAtomBiquad> tChain;
+    tChain chains[2];
+    for (auto &chain : chains)
+    {
+        ASSERT_EQ(0, chain.init({m_Fs, m_Blocksize, 1, 1}, {1, 1}));
+        chain.getAtom<0>().setMorphSamples(300);
+    }
+    compare(chains[0], chains[1], 1, [](tChain &chain, cint32_t k)
+            {
+                chain.getAtom<0>().set(0, 0, k ? -6.0F : 0.0F);
+                CAtomBiquad::tAtomBiquadParams params = {0, 0, CAtomBiquad::eBiquadType::BIQT_HSH, 3000.0F, 0.7F, k ? 6.0F : -6.0F};
+                chain.getAtom<1>().set(&params, sizeof(params)); });
+
+    CAtomGain gains[2];
+    CAtomGraph graphs[2];
+    for (auto g = 0; g < 2; g++)
+    {
+        ASSERT_EQ(0, gains[g].init({m_Fs, m_Blocksize, 1, 1}));
+        gains[g].setMorphSamples(300);
+        ASSERT_EQ(0, graphs[g].init({m_Fs, m_Blocksize, 1, 1}));
+        graphs[g].addNode(gains[g]);
+        graphs[g].connect(GRAPH_IO_NODE, 0, 0, 0);
+        graphs[g].connect(0, 0, GRAPH_IO_NODE, 0);
+        ASSERT_EQ(0, graphs[g].compile());
+    }
+    compare(graphs[0], graphs[1], 1, [&](CAtomGraph &graph, cint32_t k)
+            { gains[(&graph == &graphs[0]) ? 0 : 1].set(0, 0, k ? -20.0F : 0.0F); });
+}
+
+TEST_F(AtomFrames, Events_Clipped)
+{
+    CAtomGain gain;
+    ASSERT_EQ(0, gain.init({m_Fs, m_Blocksize, 1, 1}));
+    gain.set(0, 0, 0.0F);
+    ASSERT_EQ(0, gain.post(0, 0, -6.0F, 40));
+
+    // offset 40 is past the 16 frames of the call: applied at the last one
+    std::vector<float32_t> buf(m_Blocksize, 1.0F);
+    float32_t *pBuf[] = {buf.data()};
+    gain.play(pBuf, pBuf, 16);
+    ASSERT_EQ(1.0F, buf[14]);
+    ASSERT_NEAR(powf(10.F, -6.0F / 20.F), buf[15], 1.E-6F);
+    ASSERT_EQ(1.0F, buf[16]); // untouched
+}
+
+TEST_F(AtomFrames, Bypass_Mute)
+{
+    // 2 inputs, 3 outputs: the third one is muted by bypass()
+    CAtomThrough atom;
+    ASSERT_EQ(0, atom.init({m_Fs, m_Blocksize, 2, 3}));
+    auto in = sines(2, m_Blocksize, 0.5F, 0.01F);
+    std::vector<std::vector<float32_t>> out(3, std::vector<float32_t>(m_Blocksize, 1.0F));
+    std::vector<float32_t *> pIn = pointers(in), pOut = pointers(out);
+
+    // only the frames of the call are written
+    for (auto mute : {false, true})
+    {
+        atom.m_Mute = mute;
+        atom.play(pIn.data(), pOut.data(), 16);
+        for (auto ch = 0; ch < 3; ch++)
+        {
+            for (auto i = 0; i < m_Blocksize; i++)
+            {
+                cfloat32_t expected = (i >= 16) ? 1.0F : ((mute || ch == 2) ? 0.0F : in[ch][i]);
+                ASSERT_EQ(expected, out[ch][i]) << "mute " << mute << " ch " << ch << " sample " << i;
+            }
+        }
+    }
+}
@@ -138,4 +138,63 @@ TEST_F(AtomGain, Multisine_Gain_NoMorph_Stereo)
     }
     write_wav(m_PathOut.string(), wavOut);
     ASSERT_EQ(true, compare_wav(m_PathOut.string(), m_PathRef.string()));
-}
\ No newline at end of file
+}
+TEST(AtomGainMem, Reinit_Reuses_Block)
+{
+    class CAtomGainMem : public CAtomGain
+    {
+    public:
+        const uint8_t *getMem(void) { return m_Mem; };
+    } gain;
+
+    ASSERT_EQ(0, gain.init({48000, 64, 8, 8, 0, 0, 0}));
+    const uint8_t *mem = gain.getMem();
+    ASSERT_NE(nullptr, mem);
+    ASSERT_EQ(0, (uintptr_t)mem % ATOM_MEM_ALIGN);
+
+    // smaller: same block
+    ASSERT_EQ(0, gain.init({48000, 64, 2, 2, 0, 0, 0}));
+    ASSERT_EQ(mem, gain.getMem());
+
+    // larger: new block, still functional
+    ASSERT_EQ(0, gain.init({48000, 64, 64, 64, 0, 0, 0}));
+    gain.set(SET_ALL_CH_IND, 0, -6.0F);
+    std::vector<float32_t> buf(64 * 64, 1.0F);
+    std::vector<float32_t *> pBuf(64);
+    for (auto ch = 0; ch < 64; ch++)
+        pBuf[ch] = &buf[ch * 64];
+    gain.play(pBuf.data(), pBuf.data());
+    ASSERT_NEAR(powf(10.F, -6.0F / 20.F), buf[63 * 64 + 63], 1.E-6F);
+}
+
+TEST(AtomGainMem, In_Place_And_Bypass)
+{
+    cint32_t bs = 64;
+    CAtomGain gain;
+    ASSERT_EQ(0, gain.init({48000, bs, 2, 2, 0, 0, 0}));
+    ASSERT_TRUE(gain.isInPlace());
+    gain.set(SET_ALL_CH_IND, 0, -6.0F);
+
+    std::vector<float32_t> bufIn(2 * bs), bufOut(2 * bs), bufInPlace(2 * bs);
+    for (auto i = 0; i < 2 * bs; i++)
+        bufIn[i] = bufInPlace[i] = sinf(0.1F * i);
+    float32_t *pIn[] = {&bufIn[0], &bufIn[bs]};
+    float32_t *pOut[] = {&bufOut[0], &bufOut[bs]};
+    float32_t *pInPlace[] = {&bufInPlace[0], &bufInPlace[bs]};
+    gain.play(pIn, pOut);
+    gain.play(pInPlace, pInPlace);
+    for (auto i = 0; i < 2 * bs; i++)
+        ASSERT_EQ(bufOut[i], bufInPlace[i]);
+
+    // more outputs than inputs: the extra outputs are muted, inputs beyond
+    // the input count are never read
+    CAtomGain wide;
+    ASSERT_EQ(0, wide.init({48000, bs, 1, 2, 0, 0, 0}));
+    float32_t *pOne[] = {&bufIn[0], nullptr};
+    wide.bypass(pOne, pOut);
+    for (auto i = 0; i < bs; i++)
+    {
+        ASSERT_EQ(bufIn[i], bufOut[i]);
+        ASSERT_EQ(0.0F, bufOut[bs + i]);
+    }
+}
@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+#include "AtomGraph.h"
+#include "AtomGain.h"
+#include "AtomBiquad.h"
+#include "AtomCrossover.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class AtomGraph : public ::testing::Test
+{
+protected:
+    int32_t m_Blocksize = 64;
+    int32_t m_Fs = 48000;
+    std::vector<std::vector<float32_t>> m_Buf;
+    std::vector<float32_t *> m_Ptr;
+
+    float32_t **alloc(cint32_t nch)
+    {
+        m_Buf.assign(nch, std::vector<float32_t>(m_Blocksize));
+        m_Ptr.resize(nch);
+        for (auto ch = 0; ch < nch; ch++)
+            m_Ptr[ch] = m_Buf[ch].data();
+        return m_Ptr.data();
+    }
+
+    static void fill(std::vector<std::vector<float32_t>> &buf, cint32_t n)
+    {
+        for (size_t ch = 0; ch < buf.size(); ch++)
+            for (size_t i = 0; i < buf[ch].size(); i++)
+                buf[ch][i] = sinf(0.01F * (ch + 1) * (n * buf[ch].size() + i));
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(AtomGraph, Chain_Matches_Manual)
+{
+    cint32_t nch = 2;
+    cint32_t len = 8;
+    CAtomGain gainsG[len], gainsM[len];
+    CAtomGraph graph;
+    ASSERT_EQ(0, graph.init({m_Fs, m_Blocksize, nch, nch}));
+
+    int32_t prev = GRAPH_IO_NODE;
+    for (auto n = 0; n < len; n++)
+    {
+        for (auto gain : {&gainsG[n], &gainsM[n]})
+        {
+            ASSERT_EQ(0, gain->init({m_Fs, m_Blocksize, nch, nch}));
+            gain->set(SET_ALL_CH_IND, 0, (n % 2) ? 1.0F : -1.0F);
+        }
+        cint32_t node = graph.addNode(gainsG[n]);
+        ASSERT_EQ(n, node);
+        for (auto ch = 0; ch < nch; ch++)
+            ASSERT_EQ(0, graph.connect(prev, ch, node, ch));
+        prev = node;
+    }
+    for (auto ch = 0; ch < nch; ch++)
+        ASSERT_EQ(0, graph.connect(prev, ch, GRAPH_IO_NODE, ch));
+    ASSERT_EQ(0, graph.compile());
+
+    // gains are in-place: a single generation of buffers, whatever the
+    // length of the chain
+    ASSERT_EQ(nch, graph.getNumBuffers());
+
+    std::vector<std::vector<float32_t>> bufIn(nch, std::vector<float32_t>(m_Blocksize));
+    std::vector<std::vector<float32_t>> bufRef(nch, std::vector<float32_t>(m_Blocksize));
+    std::vector<float32_t *> pIn = {bufIn[0].data(), bufIn[1].data()};
+    std::vector<float32_t *> pRef = {bufRef[0].data(), bufRef[1].data()};
+    float32_t **pOut = alloc(nch);
+    for (auto n = 0; n < 16; n++)
+    {
+        fill(bufIn, n);
+        graph.play(pIn.data(), pOut);
+
+        gainsM[0].play(pIn.data(), pRef.data());
+        for (auto g = 1; g < len; g++)
+            gainsM[g].play(pRef.data(), pRef.data());
+
+        for (auto ch = 0; ch < nch; ch++)
+            for (auto i = 0; i < m_Blocksize; i++)
+                ASSERT_EQ(bufRef[ch][i], m_Buf[ch][i]);
+    }
+}
+
+TEST_F(AtomGraph, Split_Branches)
+{
+    // input -> crossover -> one biquad per band -> outputs
+    CAtomCrossover xover;
+    CAtomBiquad eqLow, eqHigh;
+    ASSERT_EQ(0, xover.init({m_Fs, m_Blocksize, 1, 2, 0, 0, 2}));
+    ASSERT_EQ(0, eqLow.init({m_Fs, m_Blocksize, 1, 1, 0, 0, 1}));
+    ASSERT_EQ(0, eqHigh.init({m_Fs, m_Blocksize, 1, 1, 0, 0, 1}));
+    CAtomBiquad::tAtomBiquadParams params = {0, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 100.0F, 1.0F, 6.0F};
+    eqLow.set(&params, sizeof(params));
+    params.freq = 8000.0F;
+    eqHigh.set(&params, sizeof(params));
+
+    CAtomGraph graph;
+    ASSERT_EQ(0, graph.init({m_Fs, m_Blocksize, 1, 2}));
+    // added out of processing order on purpose
+    cint32_t nodeHigh = graph.addNode(eqHigh);
+    cint32_t nodeLow = graph.addNode(eqLow);
+    cint32_t nodeXover = graph.addNode(xover);
+    ASSERT_EQ(0, graph.connect(GRAPH_IO_NODE, 0, nodeXover, 0));
+    ASSERT_EQ(0, graph.connect(nodeXover, 0, nodeLow, 0));
+    ASSERT_EQ(0, graph.connect(nodeXover, 1, nodeHigh, 0));
+    ASSERT_EQ(0, graph.connect(nodeLow, 0, GRAPH_IO_NODE, 0));
+    ASSERT_EQ(0, graph.connect(nodeHigh, 0, GRAPH_IO_NODE, 1));
+    ASSERT_EQ(0, graph.compile());
+
+    // reference, processed by hand on a second set of atoms
+    CAtomCrossover xoverM;
+    CAtomBiquad eqLowM, eqHighM;
+    xoverM.init({m_Fs, m_Blocksize, 1, 2, 0, 0, 2});
+    eqLowM.init({m_Fs, m_Blocksize, 1, 1, 0, 0, 1});
+    eqHighM.init({m_Fs, m_Blocksize, 1, 1, 0, 0, 1});
+    params.freq = 100.0F;
+    eqLowM.set(&params, sizeof(params));
+    params.freq = 8000.0F;
+    eqHighM.set(&params, sizeof(params));
+
+    std::vector<std::vector<float32_t>> bufIn(1, std::vector<float32_t>(m_Blocksize));
+    std::vector<std::vector<float32_t>> bufBands(2, std::vector<float32_t>(m_Blocksize));
+    float32_t *pIn[] = {bufIn[0].data()};
+    float32_t *pBands[] = {bufBands[0].data(), bufBands[1].data()};
+    float32_t **pOut = alloc(2);
+    for (auto n = 0; n < 16; n++)
+    {
+        fill(bufIn, n);
+        graph.play(pIn, pOut);
+
+        xoverM.play(pIn, pBands);
+        eqLowM.play(&pBands[0], &pBands[0]);
+        eqHighM.play(&pBands[1], &pBands[1]);
+
+        for (auto ch = 0; ch < 2; ch++)
+            for (auto i = 0; i < m_Blocksize; i++)
+                ASSERT_EQ(bufBands[ch][i], m_Buf[ch][i]);
+    }
+}
+
+TEST_F(AtomGraph, Invalid_Topology)
+{
+    CAtomGain gainA, gainB;
+    ASSERT_EQ(0, gainA.init({m_Fs, m_Blocksize, 1, 1}));
+    ASSERT_EQ(0, gainB.init({m_Fs, m_Blocksize, 1, 1}));
+    gainA.set(SET_ALL_CH_IND, 0, 0.0F);
+
+    CAtomGraph graph;
+    ASSERT_EQ(0, graph.init({m_Fs, m_Blocksize, 1, 1}));
+    int32_t a = graph.addNode(gainA);
+    cint32_t b = graph.addNode(gainB);
+
+    // out of range
+    ASSERT_EQ(-1, graph.connect(a, 1, b, 0));
+    ASSERT_EQ(-1, graph.connect(a, 0, 2, 0));
+    ASSERT_EQ(-1, graph.connect(GRAPH_IO_NODE, 1, a, 0));
+
+    // block size mismatch
+    CAtomGain gainC;
+    gainC.init({m_Fs, 2 * m_Blocksize, 1, 1});
+    ASSERT_EQ(-1, graph.addNode(gainC));
+
+    // cycle
+    ASSERT_EQ(0, graph.connect(a, 0, b, 0));
+    ASSERT_EQ(0, graph.connect(b, 0, a, 0));
+    ASSERT_EQ(-1, graph.compile());
+
+    // unconnected input reads silence
+    ASSERT_EQ(0, graph.init({m_Fs, m_Blocksize, 1, 1}));
+    a = graph.addNode(gainA);
+    ASSERT_EQ(0, graph.connect(a, 0, GRAPH_IO_NODE, 0));
+    ASSERT_EQ(0, graph.compile());
+    std::vector<float32_t> bufIn(m_Blocksize, 1.0F);
+    float32_t *pIn[] = {bufIn.data()};
+    float32_t **pOut = alloc(1);
+    m_Buf[0].assign(m_Blocksize, 1.0F);
+    graph.play(pIn, pOut);
+    for (auto i = 0; i < m_Blocksize; i++)
+        ASSERT_EQ(0.0F, m_Buf[0][i]);
+}
@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "AtomGain.h"
+#include "AtomDiode.h"
+#include "AtomBiquad.h"
+#include "AtomCrossover.h"
+#include "AtomChain.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class AtomInterleaved : public AtomCompareTest
+{
+protected:
+    /**
+     * @brief Play planar through play() and interleaved through
+     *        playInterleaved() for numBlocks, calling setParams(atom, n) on
+     *        both before each block, and compare. In-place if inPlace.
+     */
+    template <class A, class F>
+    void compare(A &planar, A &interleaved, F setParams, cint32_t numBlocks = 100, bool_t inPlace = false)
+    {
+        cint32_t nchIn = planar.getProps().m_NumChIn;
+        cint32_t nchOut = planar.getProps().m_NumChOut;
+        std::vector<std::vector<float32_t>> bufOut(nchOut, std::vector<float32_t>(m_Blocksize));
+        std::vector<float32_t *> pOut = pointers(bufOut);
+        std::vector<float32_t> framesOut(nchOut * m_Blocksize);
+
+        for (auto n = 0; n < numBlocks; n++)
+        {
+            setParams(planar, n);
+            setParams(interleaved, n);
+            auto bufIn = sines(nchIn, m_Blocksize, 0.5F, 0.01F, n * m_Blocksize);
+            std::vector<float32_t *> pIn = pointers(bufIn);
+
+            std::vector<float32_t> framesIn = interleave(bufIn);
+            planar.play(pIn.data(), pOut.data());
+            if (inPlace)
+            {
+                interleaved.playInterleaved(framesIn.data(), framesIn.data());
+                framesOut = framesIn;
+            }
+            else
+            {
+                interleaved.playInterleaved(framesIn.data(), framesOut.data());
+            }
+
+            ASSERT_NO_FATAL_FAILURE(expectNear(bufOut, deinterleave(framesOut, nchOut), m_Blocksize,
+                                               "block " + std::to_string(n)));
+        }
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(AtomInterleaved, Gain_Diode_Morph_Events)
+{
+    CAtomGain gains[2];
+    for (auto &gain : gains)
+    {
+        ASSERT_EQ(0, gain.init({m_Fs, m_Blocksize, 3, 3}));
+        gain.setMorphSamples(100);
+    }
+    auto setGain = [](CAtomGain &gain, cint32_t n)
+    {
+        if (n % 10 == 0)
+            gain.post(n % 3, 0, -0.5F * n, (7 * n) % 64);
+    };
+    compare(gains[0], gains[1], setGain);
+    compare(gains[0], gains[1], setGain, 20, true);
+
+    CAtomDiode diodes[2];
+    for (auto &diode : diodes)
+    {
+        ASSERT_EQ(0, diode.init({m_Fs, m_Blocksize, 2, 2, 0, 0, 1}));
+        diode.setMorphMs(5.0F);
+    }
+    compare(diodes[0], diodes[1], [](CAtomDiode &diode, cint32_t n)
+            {
+                if (n % 25 == 0)
+                    diode.set(SET_ALL_CH_IND, 0, 500.0F + 10.0F * n); });
+}
+
+TEST_F(AtomInterleaved, Biquad_Morph_Silence)
+{
+    CAtomBiquad biquads[2];
+    for (auto &biquad : biquads)
+    {
+        ASSERT_EQ(0, biquad.init({m_Fs, m_Blocksize, 2, 2, 0, 0, 3}));
+        biquad.setMorphSamples(300);
+    }
+    compare(biquads[0], biquads[1], [](CAtomBiquad &biquad, cint32_t n)
+            {
+                if (n % 40 == 0)
+                {
+                    CAtomBiquad::tAtomBiquadParams params[] = {
+                        {0, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 300.0F + n, 2.0F, 6.0F},
+                        {1, 1, CAtomBiquad::eBiquadType::BIQT_LPF, 3000.0F - n, 0.7F, 0.0F},
+                        {1, 2, CAtomBiquad::eBiquadType::BIQT_BYPASS, 1000.0F, 0.7F, 0.0F},
+                    };
+                    biquad.post(params, sizeof(params), n % 64);
+                } });
+}
+
+TEST_F(AtomInterleaved, Chain_Fused)
+{
+    CAtomChain<CAtomGain, CAtomDiode, CAtomBiquad> chains[2];
+    for (auto &chain : chains)
+    {
+        ASSERT_EQ(0, chain.init({m_Fs, m_Blocksize, 2, 2}, {1, 1, 2}));
+        chain.getAtom<0>().setMorphMs(5.0F);
+    }
+    compare(chains[0], chains[1], [](CAtomChain<CAtomGain, CAtomDiode, CAtomBiquad> &chain, cint32_t n)
+            {
+                if (n % 30 == 0)
+                {
+                    chain.getAtom<0>().set(SET_ALL_CH_IND, 0, 3.0F - 0.1F * n);
+                    chain.getAtom<1>().set(SET_ALL_CH_IND, 0, 600.0F + n);
+                    CAtomBiquad::tAtomBiquadParams params = {1, 0, CAtomBiquad::eBiquadType::BIQT_HSH, 2000.0F, 0.7F, -6.0F};
+                    chain.getAtom<2>().set(&params, sizeof(params));
+                } });
+    ASSERT_TRUE(chains[1].isFused());
+}
+
+TEST_F(AtomInterleaved, Crossover_Scratch)
+{
+    CAtomCrossover xovers[2];
+    xovers[1].setInterleavedIo(true);
+    for (auto &xover : xovers)
+        ASSERT_EQ(0, xover.init({m_Fs, m_Blocksize, 2, 6, 0, 0, 3}));
+    compare(xovers[0], xovers[1], [](CAtomCrossover &xover, cint32_t n) {});
+
+    // no scratch reserved: muted
+    CAtomCrossover xover;
+    ASSERT_EQ(0, xover.init({m_Fs, m_Blocksize, 1, 2, 0, 0, 2}));
+    std::vector<float32_t> framesIn(m_Blocksize, 1.0F), framesOut(2 * m_Blocksize, 1.0F);
+    xover.playInterleaved(framesIn.data(), framesOut.data());
+    for (auto sample : framesOut)
+        ASSERT_EQ(0.0F, sample);
+}
@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+#include "AtomMemory.h"
+#include "AtomGain.h"
+#include "AtomDiode.h"
+#include "AtomBiquad.h"
+#include "AtomCrossover.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+static const CQuarkProps propsGain = {48000, 64, 4, 4, 0, 0, 0};
+static const CQuarkProps propsDiode = {48000, 64, 4, 4, 0, 0, 1};
+static const CQuarkProps propsBiquad = {48000, 64, 4, 4, 0, 0, 6};
+
+/**
+ * @brief Set the same parameters on a gain -> diode -> biquad chain
+ */
+static void setChain(CAtomGain &gain, CAtomDiode &diode, CAtomBiquad &biquad)
+{
+    gain.set(SET_ALL_CH_IND, 0, 6.0F);
+    diode.set(SET_ALL_CH_IND, 0, 1000.0F);
+    for (auto ch = 0; ch < propsBiquad.m_NumChIn; ch++)
+    {
+        CAtomBiquad::tAtomBiquadParams params = {
+            ch, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 1000.0F, 1.0F, 6.0F};
+        biquad.set(&params, sizeof(params));
+    }
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(AtomMemory, Arena_Sizes_Chain)
+{
+    const size_t sizeGain = CAtomGain::getMemRequirement(propsGain);
+    const size_t sizeDiode = CAtomDiode::getMemRequirement(propsDiode);
+    const size_t sizeBiquad = CAtomBiquad::getMemRequirement(propsBiquad);
+    ASSERT_GT(sizeGain, 0u);
+    ASSERT_GT(sizeDiode, 0u);
+    ASSERT_GT(sizeBiquad, 0u);
+
+    CAtomArena arena;
+    ASSERT_EQ(0, arena.init(sizeGain + sizeDiode + sizeBiquad));
+
+    CAtomGain gain;
+    CAtomDiode diode;
+    CAtomBiquad biquad;
+    ASSERT_EQ(0, gain.init(propsGain, arena));
+    ASSERT_EQ(0, diode.init(propsDiode, arena));
+    ASSERT_EQ(0, biquad.init(propsBiquad, arena));
+    ASSERT_EQ(arena.getSize(), arena.getUsed());
+
+    // re-init with the same props reuses the blocks, nothing more taken
+    ASSERT_EQ(0, biquad.init(propsBiquad, arena));
+    ASSERT_EQ(arena.getSize(), arena.getUsed());
+
+    // exhausted arena
+    CAtomBiquad extra;
+    ASSERT_EQ(-1, extra.init(propsBiquad, arena));
+}
+
+TEST(AtomMemory, Arena_Matches_Heap)
+{
+    CAtomArena arena;
+    ASSERT_EQ(0, arena.init(CAtomGain::getMemRequirement(propsGain) +
+                            CAtomDiode::getMemRequirement(propsDiode) +
+                            CAtomBiquad::getMemRequirement(propsBiquad)));
+
+    CAtomGain gainA, gainH;
+    CAtomDiode diodeA, diodeH;
+    CAtomBiquad biquadA, biquadH;
+    ASSERT_EQ(0, gainA.init(propsGain, arena));
+    ASSERT_EQ(0, diodeA.init(propsDiode, arena));
+    ASSERT_EQ(0, biquadA.init(propsBiquad, arena));
+    ASSERT_EQ(0, gainH.init(propsGain));
+    ASSERT_EQ(0, diodeH.init(propsDiode));
+    ASSERT_EQ(0, biquadH.init(propsBiquad));
+    setChain(gainA, diodeA, biquadA);
+    setChain(gainH, diodeH, biquadH);
+
+    cint32_t nch = propsGain.m_NumChIn;
+    cint32_t bs = propsGain.m_BlockSize;
+    std::vector<float32_t> bufA(nch * bs), bufH(nch * bs);
+    std::vector<float32_t *> pA(nch), pH(nch);
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        pA[ch] = &bufA[ch * bs];
+        pH[ch] = &bufH[ch * bs];
+    }
+
+    for (auto n = 0; n < 64; n++)
+    {
+        for (auto i = 0; i < nch * bs; i++)
+            bufA[i] = bufH[i] = 0.5F * sinf(0.01F * (n * bs + i));
+
+        gainA.play(pA.data(), pA.data());
+        diodeA.play(pA.data(), pA.data());
+        biquadA.play(pA.data(), pA.data());
+        gainH.play(pH.data(), pH.data());
+        diodeH.play(pH.data(), pH.data());
+        biquadH.play(pH.data(), pH.data());
+
+        for (auto i = 0; i < nch * bs; i++)
+            ASSERT_EQ(bufH[i], bufA[i]);
+    }
+}
+
+TEST(AtomMemory, Arena_External_Too_Small)
+{
+    alignas(ATOM_MEM_ALIGN) static uint8_t mem[256];
+    CAtomArena arena(mem, sizeof(mem));
+    ASSERT_EQ(sizeof(mem), arena.getSize());
+
+    CAtomBiquad biquad;
+    ASSERT_GT(CAtomBiquad::getMemRequirement(propsBiquad), sizeof(mem));
+    ASSERT_EQ(-1, biquad.init(propsBiquad, arena));
+    ASSERT_EQ(0u, arena.getUsed());
+}
+
+TEST(AtomMemory, Failed_Init_Keeps_Props)
+{
+    CAtomArena arena;
+    ASSERT_EQ(0, arena.init(CAtomGain::getMemRequirement(propsGain) +
+                            CAtomDiode::getMemRequirement(propsDiode) +
+                            CAtomBiquad::getMemRequirement(propsBiquad)));
+
+    CAtomGain gainA, gainH;
+    CAtomDiode diodeA, diodeH;
+    CAtomBiquad biquadA, biquadH;
+    ASSERT_EQ(0, gainA.init(propsGain, arena));
+    ASSERT_EQ(0, diodeA.init(propsDiode, arena));
+    ASSERT_EQ(0, biquadA.init(propsBiquad, arena));
+    ASSERT_EQ(0, gainH.init(propsGain));
+    ASSERT_EQ(0, diodeH.init(propsDiode));
+    ASSERT_EQ(0, biquadH.init(propsBiquad));
+    setChain(gainA, diodeA, biquadA);
+    setChain(gainH, diodeH, biquadH);
+
+    // growing through the exhausted arena fails, the atoms keep their block
+    CQuarkProps wide = propsBiquad;
+    wide.m_NumChIn = wide.m_NumChOut = 256;
+    ASSERT_EQ(-1, gainA.init({48000, 64, 256, 256, 0, 0, 0}, arena));
+    ASSERT_EQ(-1, diodeA.init({48000, 64, 256, 256, 0, 0, 1}, arena));
+    ASSERT_EQ(-1, biquadA.init(wide, arena));
+    ASSERT_EQ(propsGain.m_NumChOut, gainA.getProps().m_NumChOut);
+    ASSERT_EQ(propsDiode.m_NumChOut, diodeA.getProps().m_NumChOut);
+    ASSERT_EQ(propsBiquad.m_NumChOut, biquadA.getProps().m_NumChOut);
+
+    // a failed first init leaves an atom which plays nothing
+    CAtomCrossover xover;
+    ASSERT_EQ(-1, xover.init({48000, 64, 4, 8, 0, 0, 2}, arena));
+
+    cint32_t nch = propsGain.m_NumChIn;
+    cint32_t bs = propsGain.m_BlockSize;
+    std::vector<float32_t> bufA(nch * bs), bufH(nch * bs);
+    std::vector<float32_t *> pA(nch), pH(nch);
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        pA[ch] = &bufA[ch * bs];
+        pH[ch] = &bufH[ch * bs];
+    }
+
+    for (auto n = 0; n < 64; n++)
+    {
+        for (auto i = 0; i < nch * bs; i++)
+            bufA[i] = bufH[i] = 0.5F * sinf(0.01F * (n * bs + i));
+
+        gainA.play(pA.data(), pA.data());
+        diodeA.play(pA.data(), pA.data());
+        biquadA.play(pA.data(), pA.data());
+        xover.play(pA.data(), pA.data());
+        gainH.play(pH.data(), pH.data());
+        diodeH.play(pH.data(), pH.data());
+        biquadH.play(pH.data(), pH.data());
+
+        for (auto i = 0; i < nch * bs; i++)
+            ASSERT_EQ(bufH[i], bufA[i]);
+    }
+}
+
+TEST(AtomMemory, Arena_Sizes_Settings)
+{
+    const size_t queueSize = 4 * ATOM_PARAM_QUEUE_SIZE;
+    ASSERT_GT(CAtomBiquad::getMemRequirement(propsBiquad, true, queueSize),
+              CAtomBiquad::getMemRequirement(propsBiquad));
+
+    CAtomArena arena;
+    ASSERT_EQ(0, arena.init(CAtomGain::getMemRequirement(propsGain, true, queueSize) +
+                            CAtomDiode::getMemRequirement(propsDiode, true, queueSize) +
+                            CAtomBiquad::getMemRequirement(propsBiquad, true, queueSize)));
+
+    CAtomGain gain;
+    CAtomDiode diode;
+    CAtomBiquad biquad;
+    gain.setInterleavedIo(true);
+    diode.setInterleavedIo(true);
+    biquad.setInterleavedIo(true);
+    gain.setParamQueueSize(queueSize);
+    diode.setParamQueueSize(queueSize);
+    biquad.setParamQueueSize(queueSize);
+    ASSERT_EQ(0, gain.init(propsGain, arena));
+    ASSERT_EQ(0, diode.init(propsDiode, arena));
+    ASSERT_EQ(0, biquad.init(propsBiquad, arena));
+    ASSERT_EQ(arena.getSize(), arena.getUsed());
+}
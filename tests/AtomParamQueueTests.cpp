@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+#include "AtomParamQueue.h"
+#include "AtomGain.h"
+#include "AtomBiquad.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include "TestUtils.h"
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(AtomParamQueue, Multi_Producer_Order)
+{
+    cint32_t numProducers = 4;
+    cint32_t numMsgs = 20000;
+    std::vector<CAtomParamQueue::tAtomParamCell> cells(64);
+    CAtomParamQueue queue;
+    queue.init(cells.data(), cells.size());
+
+    std::vector<std::thread> producers;
+    for (auto p = 0; p < numProducers; p++)
+    {
+        producers.emplace_back([&queue, p, numMsgs]
+                               {
+                                   for (auto n = 0; n < numMsgs; n++)
+                                   {
+                                       tAtomParamMsg msg = {p, n, 0, {(float32_t)n}};
+                                       while (!queue.push(msg))
+                                           std::this_thread::yield();
+                                   } });
+    }
+
+    // per producer, messages arrive complete and in order
+    std::vector<int32_t> next(numProducers, 0);
+    int32_t received = 0;
+    while (received < numProducers * numMsgs)
+    {
+        tAtomParamMsg msg;
+        if (queue.pop(msg))
+        {
+            ASSERT_EQ(next[msg.ch], msg.el);
+            ASSERT_EQ((float32_t)msg.el, msg.val[0]);
+            next[msg.ch]++;
+            received++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &producer : producers)
+        producer.join();
+
+    tAtomParamMsg msg;
+    ASSERT_FALSE(queue.pop(msg));
+}
+
+TEST(AtomParamQueue, Post_Matches_Set)
+{
+    cint32_t nch = 2;
+    cint32_t bs = 64;
+    CAtomBiquad biqSet, biqPost;
+    CAtomGain gainSet, gainPost;
+    for (auto biquad : {&biqSet, &biqPost})
+    {
+        ASSERT_EQ(0, biquad->init({48000, bs, nch, nch, 0, 0, 2}));
+        biquad->setMorphMs(5.0F);
+    }
+    for (auto gain : {&gainSet, &gainPost})
+    {
+        ASSERT_EQ(0, gain->init({48000, bs, nch, nch}));
+        gain->setMorphMs(5.0F);
+    }
+
+    std::vector<float32_t> bufSet(nch * bs), bufPost(nch * bs);
+    float32_t *pSet[] = {&bufSet[0], &bufSet[bs]};
+    float32_t *pPost[] = {&bufPost[0], &bufPost[bs]};
+    for (auto n = 0; n < 100; n++)
+    {
+        if (n % 20 == 0)
+        {
+            CAtomBiquad::tAtomBiquadParams params[] = {
+                {0, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 500.0F + n, 2.0F, 6.0F},
+                {1, 1, CAtomBiquad::eBiquadType::BIQT_LPF, 2000.0F + n, 0.7F, 0.0F},
+            };
+            // applied at the start of the next play()
+            ASSERT_EQ(0, biqPost.post(params, sizeof(params)));
+            ASSERT_EQ(0, gainPost.post(SET_ALL_CH_IND, 0, -0.1F * n));
+            biqSet.set(params, sizeof(params));
+            gainSet.set(SET_ALL_CH_IND, 0, -0.1F * n);
+        }
+        for (auto i = 0; i < nch * bs; i++)
+            bufSet[i] = bufPost[i] = sinf(0.05F * (n * nch * bs + i));
+
+        gainSet.play(pSet, pSet);
+        biqSet.play(pSet, pSet);
+        gainPost.play(pPost, pPost);
+        biqPost.play(pPost, pPost);
+        for (auto i = 0; i < nch * bs; i++)
+            ASSERT_EQ(bufSet[i], bufPost[i]);
+    }
+
+    // invalid changes are rejected on the posting side
+    CAtomBiquad::tAtomBiquadParams params = {nch, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 500.0F, 2.0F, 6.0F};
+    ASSERT_EQ(-1, biqPost.post(&params, sizeof(params)));
+    ASSERT_EQ(-1, gainPost.post(nch, 0, 0.0F));
+}
+
+TEST(AtomParamQueue, Queue_Full)
+{
+    CAtomGain gain;
+    gain.setParamQueueSize(3); // rounded up to 4
+    ASSERT_EQ(0, gain.init({48000, 64, 1, 1}));
+    for (auto n = 0; n < 4; n++)
+        ASSERT_EQ(0, gain.post(0, 0, -6.0F));
+    ASSERT_EQ(-1, gain.post(0, 0, -6.0F));
+
+    // drained by play()
+    std::vector<float32_t> buf(64, 1.0F);
+    float32_t *pBuf[] = {buf.data()};
+    gain.play(pBuf, pBuf);
+    ASSERT_NEAR(powf(10.F, -6.0F / 20.F), buf[63], 1.E-6F);
+    ASSERT_EQ(0, gain.post(0, 0, 0.0F));
+}
+
+TEST(AtomParamQueue, Sample_Accurate_Events)
+{
+    const int32_t bs = 64;
+    CAtomGain gain;
+    ASSERT_EQ(0, gain.init({48000, bs, 1, 1}));
+    gain.set(0, 0, 0.0F);
+
+    // posted out of order, applied sorted by offset
+    ASSERT_EQ(0, gain.post(0, 0, -6.0F, 40));
+    ASSERT_EQ(0, gain.post(0, 0, -12.0F, 10));
+
+    std::vector<float32_t> buf(bs, 1.0F);
+    float32_t *pBuf[] = {buf.data()};
+    gain.play(pBuf, pBuf);
+    for (auto i = 0; i < bs; i++)
+    {
+        float32_t expected = 1.0F;
+        if (i >= 40)
+            expected = powf(10.F, -6.0F / 20.F);
+        else if (i >= 10)
+            expected = powf(10.F, -12.0F / 20.F);
+        ASSERT_NEAR(expected, buf[i], 1.E-6F) << "sample " << i;
+    }
+
+    // offsets beyond the block are clipped to its last sample
+    ASSERT_EQ(0, gain.post(0, 0, 0.0F, 1000));
+    std::fill(buf.begin(), buf.end(), 1.0F);
+    gain.play(pBuf, pBuf);
+    ASSERT_NEAR(powf(10.F, -6.0F / 20.F), buf[bs - 2], 1.E-6F);
+    ASSERT_NEAR(1.0F, buf[bs - 1], 1.E-6F);
+}
+
+TEST(AtomParamQueue, Morph_Within_Block)
+{
+    const int32_t bs = 64;
+    cfloat32_t target = powf(10.F, -6.0F / 20.F);
+    CAtomGain gain;
+    ASSERT_EQ(0, gain.init({48000, bs, 1, 1}));
+    gain.set(0, 0, 0.0F);
+    gain.setMorphSamples(10);
+
+    // the morph starts at sample 5 and is over after sample 14
+    ASSERT_EQ(0, gain.post(0, 0, -6.0F, 5));
+    std::vector<float32_t> buf(bs, 1.0F);
+    float32_t *pBuf[] = {buf.data()};
+    gain.play(pBuf, pBuf);
+    for (auto i = 0; i < bs; i++)
+    {
+        float32_t expected = 1.0F;
+        if (i >= 15)
+            expected = target;
+        else if (i >= 5)
+            expected = 1.0F + (target - 1.0F) * (i - 4) / 10.F;
+        ASSERT_NEAR(expected, buf[i], 1.E-6F) << "sample " << i;
+    }
+    for (auto i = 15; i < bs; i++)
+        ASSERT_EQ(target, buf[i]);
+}
@@ -0,0 +1,180 @@
+#include "gtest/gtest.h"
+#include "AtomSlicer.h"
+#include "AtomBiquad.h"
+#include "AtomGain.h"
+#include "AtomDiode.h"
+#include "AtomCrossover.h"
+#include "AtomGraph.h"
+#include <iostream>
+#include <vector>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class AtomSlicer : public ::testing::Test
+{
+protected:
+    int32_t m_Blocksize = 64;
+    int32_t m_Fs = 48000;
+    int32_t m_NumCh = 32;
+    CAtomThreadPool m_Pool;
+    std::vector<float32_t> m_BufIn, m_BufRef, m_BufOut;
+    std::vector<float32_t *> m_In, m_Ref, m_Out;
+
+    void SetUp() override
+    {
+        ASSERT_EQ(0, m_Pool.init(4, 16));
+        m_BufIn.resize(m_NumCh * m_Blocksize);
+        m_BufRef.resize(m_NumCh * m_Blocksize);
+        m_BufOut.resize(m_NumCh * m_Blocksize);
+        for (auto ch = 0; ch < m_NumCh; ch++)
+        {
+            m_In.push_back(&m_BufIn[ch * m_Blocksize]);
+            m_Ref.push_back(&m_BufRef[ch * m_Blocksize]);
+            m_Out.push_back(&m_BufOut[ch * m_Blocksize]);
+        }
+    }
+
+    /**
+     * @brief Play ref directly and sliced through a slicer, changing the
+     *        parameters of both with setParams every 50 blocks, and compare
+     */
+    template <class A, class F>
+    void compare(A &ref, A &sliced, F setParams)
+    {
+        CAtomSlicer slicer;
+        ASSERT_EQ(0, slicer.init(sliced, m_Pool, 5));
+        ASSERT_EQ(5, slicer.getNumSlices());
+
+        for (auto n = 0; n < 200; n++)
+        {
+            if (n % 50 == 0)
+            {
+                setParams(ref, n);
+                setParams(sliced, n);
+            }
+            for (size_t i = 0; i < m_BufIn.size(); i++)
+                m_BufIn[i] = 0.5F * sinf(0.003F * (n * m_BufIn.size() + i));
+
+            // as the workers, both with denormals flushed to zero
+            ref.process(m_In.data(), m_Ref.data());
+            slicer.process(m_In.data(), m_Out.data());
+            for (size_t i = 0; i < m_BufIn.size(); i++)
+                ASSERT_EQ(m_BufRef[i], m_BufOut[i]) << "block " << n << " sample " << i;
+        }
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(AtomSlicer, Biquad_Morph)
+{
+    CAtomBiquad ref, sliced;
+    for (auto biquad : {&ref, &sliced})
+    {
+        ASSERT_EQ(0, biquad->init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 10}));
+        biquad->setMorphMs(20.0F);
+    }
+    compare(ref, sliced, [&](CAtomBiquad &biquad, cint32_t n)
+            {
+                for (auto ch = 0; ch < m_NumCh; ch++)
+                {
+                    for (auto el = 0; el < 10; el++)
+                    {
+                        CAtomBiquad::tAtomBiquadParams params = {
+                            ch, el, CAtomBiquad::eBiquadType::BIQT_PEAK, 100.0F * (el + 1) + n, 2.0F, 3.0F};
+                        biquad.set(&params, sizeof(params));
+                    }
+                } });
+}
+
+TEST_F(AtomSlicer, Gain_Diode_Morph)
+{
+    CAtomGain gainRef, gainSliced;
+    for (auto gain : {&gainRef, &gainSliced})
+    {
+        ASSERT_EQ(0, gain->init({m_Fs, m_Blocksize, m_NumCh, m_NumCh}));
+        gain->setMorphMs(10.0F);
+    }
+    compare(gainRef, gainSliced, [&](CAtomGain &gain, cint32_t n)
+            { gain.set(SET_ALL_CH_IND, 0, -0.1F * n); });
+
+    CAtomDiode diodeRef, diodeSliced;
+    for (auto diode : {&diodeRef, &diodeSliced})
+    {
+        ASSERT_EQ(0, diode->init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 1}));
+        diode->setMorphMs(10.0F);
+    }
+    compare(diodeRef, diodeSliced, [&](CAtomDiode &diode, cint32_t n)
+            { diode.set(SET_ALL_CH_IND, 0, 500.0F + 10.0F * n); });
+}
+
+TEST_F(AtomSlicer, Posted_Within_Block)
+{
+    CAtomBiquad ref, sliced;
+    for (auto biquad : {&ref, &sliced})
+    {
+        ASSERT_EQ(0, biquad->init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 2}));
+        biquad->setMorphSamples(100);
+    }
+    compare(ref, sliced, [&](CAtomBiquad &biquad, cint32_t n)
+            {
+                for (auto ch = 0; ch < m_NumCh; ch++)
+                {
+                    CAtomBiquad::tAtomBiquadParams params = {
+                        ch, ch % 2, CAtomBiquad::eBiquadType::BIQT_PEAK, 200.0F + 10.0F * n, 2.0F, 6.0F};
+                    ASSERT_EQ(0, biquad.post(&params, sizeof(params), (7 * ch + n) % m_Blocksize));
+                } });
+}
+
+TEST_F(AtomSlicer, Not_Sliceable)
+{
+    CAtomCrossover xover;
+    ASSERT_EQ(0, xover.init({m_Fs, m_Blocksize, 2, 4, 0, 0, 2}));
+    CAtomSlicer slicer;
+    ASSERT_EQ(-1, slicer.init(xover, m_Pool, 2));
+}
+
+TEST_F(AtomSlicer, Within_Graph_On_Same_Pool)
+{
+    // the graph keeps the pool busy, the slicer plays its slices serially
+    CAtomBiquad ref, sliced;
+    for (auto biquad : {&ref, &sliced})
+    {
+        ASSERT_EQ(0, biquad->init({m_Fs, m_Blocksize, m_NumCh, m_NumCh, 0, 0, 2}));
+        for (auto ch = 0; ch < m_NumCh; ch++)
+        {
+            CAtomBiquad::tAtomBiquadParams params = {
+                ch, 0, CAtomBiquad::eBiquadType::BIQT_PEAK, 200.0F + 10.0F * ch, 2.0F, 6.0F};
+            biquad->set(&params, sizeof(params));
+        }
+    }
+    CAtomSlicer slicer;
+    ASSERT_EQ(0, slicer.init(sliced, m_Pool, 4));
+
+    CAtomGraph graph;
+    ASSERT_EQ(0, graph.init({m_Fs, m_Blocksize, m_NumCh, m_NumCh}));
+    cint32_t node = graph.addNode(slicer);
+    for (auto ch = 0; ch < m_NumCh; ch++)
+    {
+        graph.connect(GRAPH_IO_NODE, ch, node, ch);
+        graph.connect(node, ch, GRAPH_IO_NODE, ch);
+    }
+    graph.setThreadPool(&m_Pool);
+    ASSERT_EQ(0, graph.compile());
+
+    for (auto n = 0; n < 20; n++)
+    {
+        for (size_t i = 0; i < m_BufIn.size(); i++)
+            m_BufIn[i] = 0.5F * sinf(0.003F * (n * m_BufIn.size() + i));
+        ref.process(m_In.data(), m_Ref.data());
+        graph.process(m_In.data(), m_Out.data());
+        for (size_t i = 0; i < m_BufIn.size(); i++)
+            ASSERT_EQ(m_BufRef[i], m_BufOut[i]) << "block " << n << " sample " << i;
+    }
+    ASSERT_FALSE(m_Pool.isRunning());
+}
@@ -0,0 +1,223 @@
+#include "gtest/gtest.h"
+#include "AtomThreadPool.h"
+#include "AtomGraph.h"
+#include "AtomBiquad.h"
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+typedef struct
+{
+    CAtomThreadPool *pool;
+    std::atomic<int32_t> count[64];
+    int32_t numTasks;
+} tTreeJob;
+
+// binary tree: task t makes tasks 2t + 1 and 2t + 2 ready
+static void treeTask(void *ctx, cint32_t task, cint32_t worker)
+{
+    tTreeJob *pJob = static_cast<tTreeJob *>(ctx);
+    pJob->count[task].fetch_add(1);
+    for (auto child : {2 * task + 1, 2 * task + 2})
+    {
+        if (child < pJob->numTasks)
+            pJob->pool->push(worker, child);
+    }
+}
+
+/**
+ * @brief numBranches parallel branches of 10 peak sections each, one per
+ *        graph channel
+ */
+static void buildBranches(CAtomGraph &graph, std::vector<CAtomBiquad> &eqs, cint32_t numBranches, cint32_t bs)
+{
+    graph.init({48000, bs, numBranches, numBranches});
+    for (auto b = 0; b < numBranches; b++)
+    {
+        eqs[b].init({48000, bs, 1, 1, 0, 0, 10});
+        for (auto el = 0; el < 10; el++)
+        {
+            CAtomBiquad::tAtomBiquadParams params = {
+                0, el, CAtomBiquad::eBiquadType::BIQT_PEAK, 100.0F * (el + 1) + b, 2.0F, 3.0F};
+            eqs[b].set(&params, sizeof(params));
+        }
+        cint32_t node = graph.addNode(eqs[b]);
+        graph.connect(GRAPH_IO_NODE, b, node, 0);
+        graph.connect(node, 0, GRAPH_IO_NODE, b);
+    }
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(AtomThreadPool, All_Tasks_Once)
+{
+    CAtomThreadPool pool;
+    ASSERT_EQ(-1, pool.init(0, 64));
+    ASSERT_EQ(0, pool.init(4, 64));
+    ASSERT_EQ(4, pool.getNumThreads());
+
+    tTreeJob job;
+    job.pool = &pool;
+    job.numTasks = 63;
+    cint32_t root = 0;
+    for (auto n = 0; n < 200; n++)
+    {
+        for (auto &c : job.count)
+            c.store(0);
+        pool.run(treeTask, &job, &root, 1, job.numTasks);
+        for (auto t = 0; t < job.numTasks; t++)
+            ASSERT_EQ(1, job.count[t].load()) << "run " << n << " task " << t;
+
+        // let the workers park now and then
+        if (n % 50 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_GT(pool.getParallelEfficiency(), 0.F);
+    ASSERT_LE(pool.getParallelEfficiency(), 1.F);
+}
+
+TEST(AtomThreadPool, Late_Workers)
+{
+    CAtomThreadPool pool;
+    ASSERT_EQ(0, pool.init(4, 64));
+
+    // single task jobs complete before the parked workers wake up, which then
+    // must not run the tasks of the next jobs with a stale context
+    tTreeJob jobs[2];
+    for (auto &job : jobs)
+    {
+        job.pool = &pool;
+        job.numTasks = 3;
+        for (auto &c : job.count)
+            c.store(0);
+    }
+    cint32_t root = 0;
+    cint32_t niter = 2000;
+    for (auto n = 0; n < niter; n++)
+    {
+        pool.run(treeTask, &jobs[n % 2], &root, 1, jobs[n % 2].numTasks);
+        if (n % 200 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    for (auto &job : jobs)
+    {
+        for (auto t = 0; t < job.numTasks; t++)
+            ASSERT_EQ(niter / 2, job.count[t].load()) << "task " << t;
+    }
+}
+
+TEST(AtomThreadPool, Graph_Parallel_Matches_Serial)
+{
+    cint32_t numBranches = 16;
+    cint32_t bs = 64;
+    CAtomGraph graphSer, graphPar;
+    std::vector<CAtomBiquad> eqsSer(numBranches), eqsPar(numBranches);
+    buildBranches(graphSer, eqsSer, numBranches, bs);
+    buildBranches(graphPar, eqsPar, numBranches, bs);
+
+    CAtomThreadPool pool;
+    ASSERT_EQ(0, pool.init(4, numBranches));
+    graphPar.setThreadPool(&pool);
+    ASSERT_EQ(0, graphSer.compile());
+    ASSERT_EQ(0, graphPar.compile());
+
+    std::vector<float32_t> bufIn(numBranches * bs), bufSer(numBranches * bs), bufPar(numBranches * bs);
+    std::vector<float32_t *> pIn(numBranches), pSer(numBranches), pPar(numBranches);
+    for (auto b = 0; b < numBranches; b++)
+    {
+        pIn[b] = &bufIn[b * bs];
+        pSer[b] = &bufSer[b * bs];
+        pPar[b] = &bufPar[b * bs];
+    }
+
+    cint32_t niter = 256;
+    for (auto n = 0; n < niter; n++)
+    {
+        for (size_t i = 0; i < bufIn.size(); i++)
+            bufIn[i] = sinf(0.001F * (n * bufIn.size() + i));
+        graphSer.process(pIn.data(), pSer.data());
+        graphPar.process(pIn.data(), pPar.data());
+
+        for (size_t i = 0; i < bufIn.size(); i++)
+            ASSERT_EQ(bufSer[i], bufPar[i]);
+    }
+}
+
+/**
+ * @brief Biquad that claims not to be in-place, so that the graph has to
+ *        assign distinct buffers
+ */
+class CAtomBiquadOutOfPlace : public CAtomBiquad
+{
+public:
+    bool_t isInPlace(void) const override { return false; };
+};
+
+TEST(AtomThreadPool, Graph_Parallel_Buffers_Ordered)
+{
+    // a -> b and c -> d in parallel: b must not reuse the buffer of c
+    cint32_t bs = 64;
+    CAtomBiquadOutOfPlace eqs[4];
+    CAtomGraph graph;
+    CAtomThreadPool pool;
+    ASSERT_EQ(0, pool.init(2, 4));
+    graph.init({48000, bs, 2, 2});
+    graph.setThreadPool(&pool);
+    for (auto &eq : eqs)
+    {
+        eq.init({48000, bs, 1, 1, 0, 0, 1});
+        graph.addNode(eq);
+    }
+    graph.connect(GRAPH_IO_NODE, 0, 0, 0);
+    graph.connect(0, 0, 1, 0);
+    graph.connect(1, 0, GRAPH_IO_NODE, 0);
+    graph.connect(GRAPH_IO_NODE, 1, 2, 0);
+    graph.connect(2, 0, 3, 0);
+    graph.connect(3, 0, GRAPH_IO_NODE, 1);
+    ASSERT_EQ(0, graph.compile());
+    ASSERT_EQ(4, graph.getNumBuffers());
+
+    // serial, the chains share their intermediate buffer
+    graph.setThreadPool(NULL);
+    ASSERT_EQ(0, graph.compile());
+    ASSERT_EQ(3, graph.getNumBuffers());
+}
+
+TEST(AtomThreadPool, Graph_Parallel_In_Place)
+{
+    // a -> b and c -> d in parallel: b runs in-place on the buffer of its
+    // ancestor a, but c -> d must not take it
+    cint32_t bs = 64;
+    CAtomBiquad eqs[4];
+    CAtomGraph graph;
+    CAtomThreadPool pool;
+    ASSERT_EQ(0, pool.init(2, 4));
+    graph.init({48000, bs, 2, 2});
+    graph.setThreadPool(&pool);
+    for (auto &eq : eqs)
+    {
+        eq.init({48000, bs, 1, 1, 0, 0, 1});
+        graph.addNode(eq);
+    }
+    graph.connect(GRAPH_IO_NODE, 0, 0, 0);
+    graph.connect(0, 0, 1, 0);
+    graph.connect(1, 0, GRAPH_IO_NODE, 0);
+    graph.connect(GRAPH_IO_NODE, 1, 2, 0);
+    graph.connect(2, 0, 3, 0);
+    graph.connect(3, 0, GRAPH_IO_NODE, 1);
+    ASSERT_EQ(0, graph.compile());
+    ASSERT_EQ(2, graph.getNumBuffers());
+
+    // a node read by two others does not run in-place
+    graph.connect(0, 0, 2, 0);
+    ASSERT_EQ(0, graph.compile());
+    ASSERT_EQ(3, graph.getNumBuffers());
+}
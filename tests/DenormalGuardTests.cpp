@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "DenormalGuard.h"
+#include "AtomBiquad.h"
+#include "AtomDiode.h"
+#include "AtomGain.h"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include "TestUtils.h"
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+static float32_t multiply(cfloat32_t a, cfloat32_t b)
+{
+    volatile float32_t x = a;
+    volatile float32_t y = b;
+    return x * y;
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(DenormalGuard, FlushToZeroScope)
+{
+    cfloat32_t tiny = std::numeric_limits<float32_t>::min();
+
+    // denormal result outside of the scope
+    ASSERT_NE(0.0F, multiply(tiny, 0.5F));
+    {
+        CDenormalGuard guard;
+        if (CDenormalGuard::isSupported())
+        {
+            ASSERT_EQ(0.0F, multiply(tiny, 0.5F));
+        }
+    }
+    // previous mode restored
+    ASSERT_NE(0.0F, multiply(tiny, 0.5F));
+}
+
+TEST(DenormalGuard, Process_Flushes_Denormal_Input)
+{
+    cint32_t nch = 2;
+    cint32_t bs = 64;
+    cfloat32_t tiny = 0.25F * std::numeric_limits<float32_t>::min();
+
+    CAtomGain gain;
+    ASSERT_EQ(0, gain.init({48000, bs, nch, nch, 0, 0, 0}));
+    gain.setMorphMs(0.0F);
+    gain.set(SET_ALL_CH_IND, 0, -6.0F);
+
+    std::vector<std::vector<float32_t>> bufIn(nch, std::vector<float32_t>(bs, tiny));
+    std::vector<std::vector<float32_t>> bufOut(nch, std::vector<float32_t>(bs));
+    std::vector<float32_t *> pIn(nch), pOut(nch);
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        pIn[ch] = bufIn[ch].data();
+        pOut[ch] = bufOut[ch].data();
+    }
+    ASSERT_EQ(FP_SUBNORMAL, std::fpclassify(tiny));
+
+    // without the guard the denormals go through
+    gain.play(pIn.data(), pOut.data());
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        for (auto i = 0; i < bs; i++)
+            ASSERT_EQ(FP_SUBNORMAL, std::fpclassify(bufOut[ch][i])) << "ch " << ch << " smp " << i;
+    }
+
+    if (!CDenormalGuard::isSupported())
+        return;
+
+    // process() reads them as zeros
+    gain.process(pIn.data(), pOut.data());
+    for (auto ch = 0; ch < nch; ch++)
+        ASSERT_EQ(std::vector<float32_t>(bs, 0.0F), bufOut[ch]) << "ch " << ch;
+}
+
+TEST(DenormalGuard, Tail_Flushed_To_Zero)
+{
+    cint32_t nch = 8;
+    cint32_t nel = 4;
+    cint32_t bs = 64;
+    cint32_t niter = 8192;
+
+    CAtomBiquad biquad;
+    CAtomDiode diode;
+    biquad.init({48000, bs, nch, nch, 0, 0, nel});
+    diode.init({48000, bs, nch, nch, 0, 0, 1});
+    biquad.setStateFlush(true);
+
+    // slowly decaying, resonant sections
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        for (auto el = 0; el < nel; el++)
+        {
+            CAtomBiquad::tAtomBiquadParams params = {
+                ch, el, CAtomBiquad::eBiquadType::BIQT_PEAK, 50.0F * (el + 1), 20.0F, 12.0F};
+            biquad.set(&params, sizeof(params));
+        }
+    }
+    diode.set(SET_ALL_CH_IND, 0, 1000.0F);
+
+    std::vector<std::vector<float32_t>> bufIn(nch, std::vector<float32_t>(bs));
+    std::vector<std::vector<float32_t>> bufMid(nch, std::vector<float32_t>(bs));
+    std::vector<std::vector<float32_t>> bufOut(nch, std::vector<float32_t>(bs));
+    std::vector<float32_t *> pIn(nch), pMid(nch), pOut(nch);
+    for (auto ch = 0; ch < nch; ch++)
+    {
+        pIn[ch] = bufIn[ch].data();
+        pMid[ch] = bufMid[ch].data();
+        pOut[ch] = bufOut[ch].data();
+        bufIn[ch][0] = 1.0F; // dirac
+    }
+
+    // the tail of the impulse response never goes through denormals, the one
+    // of the biquads ends in zeros instead
+    for (auto n = 0; n < niter; n++)
+    {
+        biquad.process(pIn.data(), pMid.data());
+        diode.process(pMid.data(), pOut.data());
+        for (auto ch = 0; ch < nch; ch++)
+        {
+            for (auto i = 0; i < bs; i++)
+            {
+                ASSERT_NE(FP_SUBNORMAL, std::fpclassify(bufMid[ch][i])) << "block " << n << " ch " << ch;
+                ASSERT_NE(FP_SUBNORMAL, std::fpclassify(bufOut[ch][i])) << "block " << n << " ch " << ch;
+            }
+        }
+
+        if (n == 0)
+        {
+            for (auto ch = 0; ch < nch; ch++)
+                bufIn[ch][0] = 0.0F;
+        }
+    }
+    for (auto ch = 0; ch < nch; ch++)
+        ASSERT_EQ(std::vector<float32_t>(bs, 0.0F), bufMid[ch]) << "ch " << ch;
+}
@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+#include "Sample.h"
+#include "SampleCache.h"
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <stdio.h>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+static std::vector<float32_t> playAll(CSample &sample, cint32_t bs = 64)
+{
+    std::vector<float32_t> out;
+    std::vector<float32_t> buf(bs);
+    sample.on();
+    while (sample.getNumSamplesUntilFinished() > 0)
+    {
+        sample.play(buf.data(), bs);
+        out.insert(out.end(), buf.begin(), buf.end());
+    }
+    return out;
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(SampleCache, Map_And_Play)
+{
+    auto base = fs::absolute(__FILE__).parent_path();
+    auto cache = base / "out" / "SampleCache_Map_And_Play.bin";
+    fs::remove(cache);
+
+    CSampleParams params;
+    params.append = false;
+    params.path = (base / "in" / "Multisine_100_1k_10k_3s.wav").string();
+    CSample ref(params);
+    ASSERT_TRUE(ref.isLoaded());
+
+    // the first load writes the cache, the next ones map it
+    params.cache = cache.string();
+    CSample first(params);
+    ASSERT_TRUE(fs::exists(cache));
+    CSample second(params);
+    CSample clone(second);
+
+    CSampleCache map;
+    ASSERT_EQ(0, map.open(params.cache));
+    ASSERT_EQ(48000, map.getFs());
+    ASSERT_EQ(3 * 48000, map.getNumFrames());
+    map.close();
+    ASSERT_EQ(NULL, map.getData());
+
+    auto out = playAll(ref);
+    ASSERT_EQ(out, playAll(first));
+    ASSERT_EQ(out, playAll(second));
+    ASSERT_EQ(out, playAll(clone));
+}
+
+TEST(SampleCache, Invalid)
+{
+    auto base = fs::absolute(__FILE__).parent_path();
+    auto cache = base / "out" / "SampleCache_Invalid.bin";
+
+    FILE *fp = fopen(cache.string().c_str(), "wb");
+    ASSERT_NE(nullptr, fp);
+    fputs("not a cache file", fp);
+    fclose(fp);
+
+    CSampleCache map;
+    ASSERT_EQ(-1, map.open(cache.string()));
+    ASSERT_EQ(-1, map.open((base / "out" / "SampleCache_Missing.bin").string()));
+
+    // an invalid cache is rewritten from the WAV file
+    CSampleParams params;
+    params.path = (base / "in" / "Triangle_1Hz_1s_0dB.wav").string();
+    params.cache = cache.string();
+    CSample sample(params);
+    ASSERT_TRUE(sample.isLoaded());
+    ASSERT_EQ(0, map.open(cache.string()));
+    ASSERT_EQ(48000, map.getFs());
+
+    // the cache is not used for another sampling rate
+    params.fs = 44100;
+    CSample other(params);
+    ASSERT_FALSE(other.isLoaded());
+}
+
+TEST(SampleCache, Loop_In_Header)
+{
+    // a copy of the WAV file, gone once the cache is written
+    auto base = fs::absolute(__FILE__).parent_path();
+    auto wav = base / "out" / "SampleCache_Loop.wav";
+    auto cache = base / "out" / "SampleCache_Loop.bin";
+    fs::remove(cache);
+    fs::copy_file(base / "in" / "Sine_1kHz_0p25s_Loop_4800_9600.wav", wav,
+                  fs::copy_options::overwrite_existing);
+
+    CSampleParams params;
+    params.append = false;
+    params.path = wav.string();
+    params.cache = cache.string();
+    CSample first(params);
+    ASSERT_TRUE(first.isLooped());
+
+    CSampleCache map;
+    ASSERT_EQ(0, map.open(params.cache));
+    ASSERT_EQ(4800, map.getLoopStart());
+    ASSERT_EQ(9600, map.getLoopEnd());
+    map.close();
+
+    // the loop comes from the cache alone
+    fs::remove(wav);
+    CSample second(params);
+    ASSERT_TRUE(second.isLoaded());
+    ASSERT_EQ(4800, second.getAsset()->getLoopStart());
+    ASSERT_EQ(9600, second.getAsset()->getLoopEnd());
+
+    // without loop in the file
+    params.path = (base / "in" / "Triangle_1Hz_1s_0dB.wav").string();
+    fs::remove(cache);
+    CSample noLoop(params);
+    ASSERT_EQ(0, map.open(params.cache));
+    ASSERT_EQ(-1, map.getLoopStart());
+    ASSERT_FALSE(CSample(params).isLooped());
+}
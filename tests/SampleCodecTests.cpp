@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "Sample.h"
+#include "SampleCodec.h"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <filesystem>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+static std::vector<int16_t> roundTrip(const CSampleCodec &codec)
+{
+    std::vector<int16_t> out(codec.getNumBlocks() * CSampleCodec::BLOCK);
+    for (auto b = 0; b < codec.getNumBlocks(); b++)
+        codec.decode(b, &out[b * CSampleCodec::BLOCK]);
+    out.resize(codec.getNumFrames());
+    return out;
+}
+
+static std::vector<float32_t> playAll(CSample &sample, cint32_t bs)
+{
+    std::vector<float32_t> out;
+    std::vector<float32_t> buf(bs);
+    sample.on();
+    while (sample.getNumSamplesUntilFinished() > 0)
+    {
+        sample.play(buf.data(), bs);
+        out.insert(out.end(), buf.begin(), buf.end());
+    }
+    return out;
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(SampleCodec, Lossless)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> dist(INT16_MIN, INT16_MAX);
+    CSampleCodec codec;
+
+    // full scale noise and extremes, odd length
+    std::vector<int16_t> noise(10 * CSampleCodec::BLOCK + 3);
+    for (auto &x : noise)
+        x = (int16_t)dist(gen);
+    noise[7] = INT16_MIN;
+    noise[8] = INT16_MAX;
+    noise[9] = INT16_MIN;
+    codec.encode(noise.data(), (int32_t)noise.size());
+    ASSERT_EQ(11, codec.getNumBlocks());
+    ASSERT_EQ(3, codec.getBlockLen(10));
+    ASSERT_EQ(noise, roundTrip(codec));
+
+    // silence and a single sample
+    std::vector<int16_t> zeros(CSampleCodec::BLOCK + 1, 0);
+    codec.encode(zeros.data(), (int32_t)zeros.size());
+    ASSERT_EQ(zeros, roundTrip(codec));
+    ASSERT_LT(codec.getMemorySize(), 32u);
+}
+
+TEST(SampleCodec, Compressed_Sample)
+{
+    CSampleParams params;
+    params.append = false;
+    params.path = (fs::absolute(__FILE__).parent_path() / "in" / "A4v16.wav").string();
+    CSample ref(params);
+    params.compress = true;
+    CSample compressed(params);
+    CSample clone(compressed);
+
+    // less than half of the raw size, same output whatever the block size
+    ASSERT_LT(compressed.getMemorySize(), ref.getMemorySize() / 2);
+    auto out = playAll(ref, 64);
+    ASSERT_EQ(out, playAll(compressed, 64));
+    ASSERT_EQ(out, playAll(clone, 64));
+    auto out100 = playAll(ref, 100);
+    ASSERT_EQ(out100, playAll(compressed, 100));
+}
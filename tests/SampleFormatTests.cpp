@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+#include "Sample.h"
+#include "SampleFormat.h"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <filesystem>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+static std::vector<float32_t> playAll(CSample &sample, cint32_t bs)
+{
+    std::vector<float32_t> out;
+    std::vector<float32_t> buf(bs);
+    sample.on();
+    while (sample.getNumSamplesUntilFinished() > 0)
+    {
+        sample.play(buf.data(), bs);
+        out.insert(out.end(), buf.begin(), buf.end());
+    }
+    return out;
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(SampleFormat, Int16_As_Asset)
+{
+    // same frames as the int16_t of CSampleAsset and CSampleStream
+    cint32_t len = 4096;
+    std::vector<float32_t> in(len);
+    for (auto i = 0; i < len; i++)
+        in[i] = 2.0F * (float32_t)i / (float32_t)(len - 1) - 1.0F;
+
+    auto buffer = CSampleBuffer::create(SFMT_INT16, len);
+    buffer->encode(in.data(), 0, len);
+    std::vector<float32_t> out(len);
+    buffer->decode(0, len, out.data());
+    for (auto i = 0; i < len; i++)
+        ASSERT_EQ(int16ToFloat(floatToInt16(in[i])), out[i]) << "frame " << i;
+}
+
+TEST(SampleFormat, Round_Trip)
+{
+    struct
+    {
+        eSampleFormat format;
+        float32_t eps;     // absolute error, one step of the format
+        float32_t epsRel;  // relative error, for mu-law
+        size_t size;       // of 1001 frames
+    } formats[] = {
+        {SFMT_INT16, 1.F / 32768, 0.0F, 2002},
+        {SFMT_INT24, 1.F / 8388608, 0.0F, 3003},
+        {SFMT_FLOAT32, 0.0F, 0.0F, 4004},
+        {SFMT_MULAW8, 1.F / 4096, 1.F / 16, 1001},
+        {SFMT_INT12, 1.F / 2048, 0.0F, 1502},
+    };
+
+    cint32_t len = 1001;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float32_t> dist(-1.0F, 1.0F);
+    std::vector<float32_t> in(len);
+    for (auto &x : in)
+        x = dist(gen) * dist(gen);
+    in[0] = -1.0F;
+    in[1] = 1.0F;
+    in[2] = 0.0F;
+
+    for (auto &f : formats)
+    {
+        auto buffer = CSampleBuffer::create(f.format, len);
+        ASSERT_NE(nullptr, buffer);
+        ASSERT_EQ(f.format, buffer->getFormat());
+        ASSERT_EQ(f.size, buffer->getMemorySize());
+
+        // encoded in uneven chunks, decoded from odd positions
+        for (auto pos = 0; pos < len; pos += 97)
+            buffer->encode(&in[pos], pos, MIN(97, len - pos));
+        std::vector<float32_t> out(len);
+        for (auto pos = 0; pos < len; pos += 33)
+            buffer->decode(pos, MIN(33, len - pos), &out[pos]);
+
+        for (auto i = 0; i < len; i++)
+            ASSERT_NEAR(in[i], out[i], f.eps + f.epsRel * fabsf(in[i])) << "format " << f.format << " frame " << i;
+        ASSERT_EQ(0.0F, out[2]);
+    }
+}
+
+TEST(SampleFormat, Sample_Storage)
+{
+    CSampleParams params;
+    params.append = false;
+    params.path = (fs::absolute(__FILE__).parent_path() / "in" / "A4v16.wav").string();
+    CSample ref(params);
+    auto out = playAll(ref, 64);
+    const size_t numFrames = ref.getMemorySize() / 2;
+
+    // the 16 bit source survives the wider formats, fits the narrower ones
+    struct
+    {
+        eSampleFormat format;
+        float32_t eps;
+        size_t size;
+    } formats[] = {
+        {SFMT_INT24, 1.E-4F, numFrames * 3},
+        {SFMT_FLOAT32, 1.E-4F, numFrames * 4},
+        {SFMT_INT12, 1.F / 2048, (numFrames * 3 + 1) / 2},
+        {SFMT_MULAW8, 1.F / 32, numFrames},
+    };
+    for (auto &f : formats)
+    {
+        params.format = f.format;
+        CSample sample(params);
+        CSample clone(sample);
+        ASSERT_EQ(f.size, sample.getMemorySize());
+        auto outFormat = playAll(sample, 64);
+        ASSERT_EQ(out.size(), outFormat.size());
+        for (size_t i = 0; i < out.size(); i++)
+            ASSERT_NEAR(out[i], outFormat[i], f.eps) << "format " << f.format << " frame " << i;
+        ASSERT_EQ(outFormat, playAll(clone, 64));
+    }
+}
+
+TEST(SampleFormat, Unknown_Format)
+{
+    CSampleParams params;
+    params.append = false;
+    params.path = (fs::absolute(__FILE__).parent_path() / "in" / "A4v16.wav").string();
+    params.format = (eSampleFormat)(SFMT_INT12 + 1);
+    CSample sample(params);
+    ASSERT_FALSE(sample.isLoaded());
+    ASSERT_EQ(0u, sample.getMemorySize());
+}
@@ -0,0 +1,171 @@
+#include "gtest/gtest.h"
+#include "Sample.h"
+#include "Sampler.h"
+#include "SampleStream.h"
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class SampleStream : public ::testing::Test
+{
+protected:
+    static const int32_t m_Blocksize = 64;
+    CSampleParams m_Params;
+
+    void SetUp() override
+    {
+        m_Params.append = false;
+        m_Params.path = (fs::absolute(__FILE__).parent_path() / "in" / "Multisine_100_1k_10k_3s.wav").string();
+    }
+
+    /**
+     * @brief Play numBlocks blocks of sample, calling between(n) before each
+     */
+    template <class F>
+    std::vector<float32_t> play(CSample &sample, cint32_t numBlocks, F between)
+    {
+        std::vector<float32_t> out(numBlocks * m_Blocksize);
+        sample.on();
+        for (auto n = 0; n < numBlocks; n++)
+        {
+            between(n);
+            sample.play(&out[n * m_Blocksize], m_Blocksize);
+        }
+        return out;
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(SampleStream, Head_And_Stream)
+{
+    CSample ref(m_Params);
+    m_Params.preload_s = 0.1F;
+    CSample streamed(m_Params);
+    ASSERT_FALSE(ref.isStreamed());
+    ASSERT_TRUE(streamed.isStreamed());
+
+    CSampleStream stream;
+    stream.init(1000);
+    ASSERT_EQ(1024, stream.getHorizon());
+    streamed.setStream(&stream);
+
+    cint32_t numBlocks = 3 * 48000 / m_Blocksize;
+    auto out = play(ref, numBlocks, [](cint32_t) {});
+    ASSERT_EQ(out, play(streamed, numBlocks, [&](cint32_t)
+                        { stream.fill(); }));
+    ASSERT_EQ(0, stream.getNumUnderruns());
+
+    // restart: the stream follows
+    ASSERT_EQ(out, play(streamed, numBlocks, [&](cint32_t)
+                        { stream.fill(); }));
+    ASSERT_EQ(0, stream.getNumUnderruns());
+}
+
+TEST_F(SampleStream, Resident_Source_Stops_Stream)
+{
+    CSample ref(m_Params);
+    m_Params.preload_s = 0.1F;
+    CSample streamed(m_Params);
+    CSampleStream stream;
+    stream.init(4096);
+
+    CSample voice;
+    voice.setStream(&stream);
+    voice.setSource(streamed);
+    voice.on();
+
+    // the voice moves on to a resident source: nothing left to stream
+    voice.setSource(ref);
+    voice.on();
+    ASSERT_EQ(0, stream.fill());
+}
+
+TEST_F(SampleStream, Underrun)
+{
+    CSample ref(m_Params);
+    m_Params.preload_s = 0.1F;
+    CSample streamed(m_Params);
+    CSampleStream stream;
+    stream.init(4096);
+    streamed.setStream(&stream);
+
+    // the I/O thread falls behind after 0.2s: silence, then the stream resumes
+    cint32_t numBlocks = 48000 / m_Blocksize;
+    cint32_t stall = 9600 / m_Blocksize;
+    auto out = play(ref, numBlocks, [](cint32_t) {});
+    auto outStreamed = play(streamed, numBlocks, [&](cint32_t n)
+                            { if (n < stall || n >= 2 * stall) stream.fill(); });
+    ASSERT_GT(stream.getNumUnderruns(), 0);
+    ASSERT_LT(stream.getNumUnderruns(), stall);
+    for (auto i = 0; i < 9600; i++)
+        ASSERT_EQ(out[i], outStreamed[i]);
+    ASSERT_EQ(0.0F, outStreamed[2 * 9600 - 1]);
+    for (auto i = 3 * 9600; i < numBlocks * m_Blocksize; i++)
+        ASSERT_EQ(out[i], outStreamed[i]);
+}
+
+TEST_F(SampleStream, Sampler_Streams)
+{
+    m_Params.append = true;
+    CSample ref(m_Params);
+    m_Params.preload_s = 0.05F;
+    m_Params.lokey = 60;
+    m_Params.hikey = 60;
+    m_Params.hivel = 127;
+
+    // streams filled before each block rather than by the I/O thread
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(m_Params));
+    ASSERT_EQ(0, sampler.init(2, 8192, false));
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+
+    cint32_t numBlocks = 300;
+    std::vector<float32_t> out(m_Blocksize);
+    std::vector<float32_t> outRef(m_Blocksize);
+    ref.on();
+    for (auto n = 0; n < numBlocks; n++)
+    {
+        sampler.runIO();
+        sampler.play(out.data(), m_Blocksize);
+        std::fill(outRef.begin(), outRef.end(), 0.0F);
+        ref.play(outRef.data(), m_Blocksize);
+        ASSERT_EQ(outRef, out) << "block " << n;
+    }
+    ASSERT_EQ(0, sampler.getNumUnderruns());
+}
+
+TEST_F(SampleStream, Sampler_Underruns_Per_Block)
+{
+    m_Params.append = true;
+    m_Params.preload_s = 0.05F;
+    m_Params.lokey = 60;
+    m_Params.hikey = 60;
+    m_Params.hivel = 127;
+
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(m_Params));
+    cint32_t blocksize = 512; // several read() per block
+    ASSERT_EQ(0, sampler.init(1, 8 * blocksize, false));
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+
+    // without fill from block 20 to 29, the ring runs dry for the last 3,
+    // each missing 2 read() of 256 frames
+    std::vector<float32_t> out(blocksize);
+    for (auto n = 0; n < 40; n++)
+    {
+        if (n < 20 || n >= 30)
+            sampler.runIO();
+        sampler.play(out.data(), blocksize);
+    }
+    ASSERT_EQ(3, sampler.getNumUnderruns());
+}
@@ -0,0 +1,315 @@
+#include "gtest/gtest.h"
+#include "Sample.h"
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+/**
+ * @brief Serial one-pole envelope of CSample, segment by segment
+ */
+static void envelope(std::vector<double> &out, double &gain, cint32_t len,
+                     const double target, cint32_t smp)
+{
+    const double factor = (smp > 0) ? exp(log(1.0 - 0.99) / (smp + 1)) : 1.0;
+    for (auto i = 0; i < len; i++)
+    {
+        out.push_back(gain);
+        gain = factor * gain + (1.0 - factor) * target;
+    }
+}
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST(Sample, Envelope)
+{
+    cint32_t len = 48000;
+    cfloat32_t value = 0.5F;
+    auto path = fs::absolute(__FILE__).parent_path() / "out" / "Sample_Envelope.wav";
+    write_wav(path.string(), std::vector<float32_t>(len, value));
+    const double stored = floatToInt16(value) / (double)INT16_MAX;
+
+    CSampleParams params;
+    params.path = path.string();
+    params.append = false;
+    params.attack_s = 0.01F;
+    params.decay_s = 0.02F;
+    params.decay_gain = 0.5F;
+    params.release_s = 0.1F;
+
+    // attack to 1, decay to the sustain level, sustain, release to 0
+    std::vector<double> gains;
+    double gain = 0.0;
+    envelope(gains, gain, 480, 1.0, 480);
+    gain = 1.0;
+    envelope(gains, gain, 960, 0.5, 960);
+    gain = 0.5;
+    envelope(gains, gain, len - 480 - 960 - 4800, 0.0, 0);
+    envelope(gains, gain, 4800, 0.0, 4800);
+
+    for (auto bs : {64, 100, 7})
+    {
+        CSample sample(params);
+        std::vector<float32_t> buf(bs);
+        sample.on();
+        for (auto pos = 0; pos < len; pos += bs)
+        {
+            sample.play(buf.data(), bs);
+            for (auto i = 0; i < MIN(bs, len - pos); i++)
+                ASSERT_NEAR(stored * gains[pos + i], buf[i], 1.E-5) << "bs " << bs << " sample " << pos + i;
+        }
+        ASSERT_EQ(0, sample.getNumSamplesUntilFinished());
+    }
+}
+
+TEST(Sample, Loop)
+{
+    cint32_t len = 10000;
+    cint32_t loopStart = 2000;
+    cint32_t loopEnd = 6000;
+    cint32_t bs = 64;
+    std::vector<float32_t> in(len);
+    for (auto i = 0; i < len; i++)
+        in[i] = (float32_t)(i % 4096) / 4096.0F - 0.5F;
+    auto path = fs::absolute(__FILE__).parent_path() / "out" / "Sample_Loop.wav";
+    write_wav(path.string(), in);
+    // as stored, see write_wav()
+    auto stored = [&](cint32_t pos)
+    { return int16ToFloat(floatToInt16(lrintf(in[pos] * 32767.0F) / 32768.0F)); };
+
+    CSampleParams params;
+    params.path = path.string();
+    params.append = false;
+    params.loop_start = loopStart;
+    params.loop_end = loopEnd;
+    params.release_s = 0.05F;
+
+    CSample sample(params);
+    ASSERT_TRUE(sample.isLooped());
+    CSample voice;
+    voice.setSource(sample);
+
+    // the loop stays resident, even if streamed
+    params.preload_s = 0.01F;
+    CSample streamed(params);
+    ASSERT_TRUE(streamed.isStreamed());
+
+    for (auto *s : {&sample, &voice, &streamed})
+    {
+        std::vector<float32_t> buf(bs);
+        s->on();
+
+        // held for several times the length of the sample
+        int32_t pos = 0;
+        for (auto n = 0; n < 266; n++)
+        {
+            std::fill(buf.begin(), buf.end(), 0.0F); // voices append
+            s->play(buf.data(), bs);
+            for (auto i = 0; i < bs; i++)
+            {
+                ASSERT_NEAR(stored(pos), buf[i], 1.E-6) << "block " << n << " sample " << i;
+                if (++pos == loopEnd)
+                    pos = loopStart;
+            }
+        }
+        ASSERT_FALSE(s->isFinished());
+
+        // the release plays on past the loop end
+        std::vector<double> gains;
+        double gain = 1.0;
+        envelope(gains, gain, 2400, 0.0, 2400);
+        s->off();
+        ASSERT_TRUE(s->isReleasing());
+        for (auto n = 0; n < 2400; n += bs)
+        {
+            std::fill(buf.begin(), buf.end(), 0.0F); // voices append
+            s->play(buf.data(), bs);
+            for (auto i = 0; i < MIN(bs, 2400 - n); i++, pos++)
+            {
+                // silence past the head, without stream
+                cfloat32_t expected = (s->isStreamed() && pos >= loopEnd) ? 0.0F : stored(pos);
+                ASSERT_NEAR(expected * gains[n + i], buf[i], 1.E-5) << "release sample " << n + i;
+            }
+        }
+        ASSERT_GT(pos, loopEnd);
+        ASSERT_TRUE(s->isFinished());
+    }
+
+    // no loop
+    params.loop_end = loopStart;
+    ASSERT_FALSE(CSample(params).isLooped());
+}
+
+TEST(Sample, Loop_From_Smpl_Chunk)
+{
+    // one forward loop over frames [4800, 9599] in the smpl chunk
+    CSampleParams params;
+    params.path = (fs::absolute(__FILE__).parent_path() / "in" / "Sine_1kHz_0p25s_Loop_4800_9600.wav").string();
+    params.append = false;
+    params.release_s = 0.01F;
+    CSample sample(params);
+    ASSERT_TRUE(sample.isLooped());
+    ASSERT_EQ(4800, sample.getAsset()->getLoopStart());
+    ASSERT_EQ(9600, sample.getAsset()->getLoopEnd());
+
+    // plays as the same loop given by the parameters
+    params.loop_start = 4800;
+    params.loop_end = 9600;
+    CSample ref(params);
+    cint32_t bs = 64;
+    std::vector<float32_t> buf(bs);
+    std::vector<float32_t> bufRef(bs);
+    sample.on();
+    ref.on();
+    ASSERT_EQ(INT32_MAX, sample.getNumSamplesUntilFinished());
+    for (auto n = 0; n < 600; n++)
+    {
+        sample.play(buf.data(), bs);
+        ref.play(bufRef.data(), bs);
+        ASSERT_EQ(bufRef, buf) << "block " << n;
+    }
+    ASSERT_FALSE(sample.isFinished());
+    ASSERT_EQ(INT32_MAX, sample.getNumSamplesUntilFinished());
+
+    // released: plays on to the end of the file at most
+    sample.off();
+    ASSERT_LE(sample.getNumSamplesUntilFinished(), 12000);
+    ASSERT_GT(sample.getNumSamplesUntilFinished(), 0);
+
+    // the loop of the parameters comes first
+    params.loop_start = 0;
+    params.loop_end = 0;
+    ASSERT_FALSE(CSample(params).isLooped());
+}
+
+TEST(Sample, Loop_Crossfade)
+{
+    // the loop is not a whole number of periods
+    cint32_t len = 24000;
+    cint32_t loopStart = 4800;
+    cint32_t loopEnd = 14450;
+    cint32_t xfade = 480;
+    std::vector<float32_t> in(len);
+    for (auto i = 0; i < len; i++)
+        in[i] = 0.5F * sinf(2.0F * (float32_t)M_PI * 440.0F * (float32_t)i / 48000.0F);
+    auto path = fs::absolute(__FILE__).parent_path() / "out" / "Sample_Loop_Crossfade.wav";
+    write_wav(path.string(), in);
+
+    CSampleParams params;
+    params.path = path.string();
+    params.append = false;
+    params.loop_start = loopStart;
+    params.loop_end = loopEnd;
+
+    // largest step between consecutive samples, over three passes of the loop
+    auto maxStep = [&](CSample &sample)
+    {
+        std::vector<float32_t> out(48000);
+        sample.on();
+        for (auto pos = 0; pos < (int32_t)out.size(); pos += 100)
+            sample.play(&out[pos], 100);
+        float32_t step = 0.0F;
+        for (size_t i = 1; i < out.size(); i++)
+            step = MAX(step, fabsf(out[i] - out[i - 1]));
+        return step;
+    };
+    const float32_t sineStep = 0.5F * 2.0F * (float32_t)M_PI * 440.0F / 48000.0F;
+
+    CSample hard(params);
+    ASSERT_GT(maxStep(hard), 4.0F * sineStep);
+
+    params.loop_xfade_s = 0.01F;
+    CSample sample(params);
+    ASSERT_LE(maxStep(sample), 1.05F * sineStep);
+    ASSERT_EQ(hard.getMemorySize() + xfade * sizeof(float32_t), sample.getMemorySize());
+
+    // the crossfade is limited by the frames before the loop start
+    params.loop_start = 100;
+    params.loop_xfade_s = 1.0F;
+    CSample short_(params);
+    ASSERT_EQ(hard.getMemorySize() + 100 * sizeof(float32_t), short_.getMemorySize());
+}
+
+TEST(Sample, Shared_Asset)
+{
+    cint32_t bs = 64;
+    CSampleParams params;
+    params.path = (fs::absolute(__FILE__).parent_path() / "in" / "A4v16.wav").string();
+    params.append = false;
+    CSample sample(params);
+    ASSERT_NE(nullptr, sample.getAsset());
+
+    // clones and voices play the asset of the sample, without resampler
+    CSample clone(sample, 60, 62);
+    CSample voice;
+    ASSERT_EQ(nullptr, voice.getAsset());
+    voice.setSource(clone);
+    ASSERT_EQ(sample.getAsset(), clone.getAsset());
+    ASSERT_EQ(sample.getAsset(), voice.getAsset());
+    ASSERT_EQ(60, voice.getLowKey());
+    ASSERT_EQ(62, voice.getHighKey());
+    ASSERT_EQ(sample.getMemorySize(), clone.getMemorySize());
+
+    std::vector<float32_t> ref(bs);
+    std::vector<float32_t> buf(bs);
+    sample.on();
+    voice.on();
+    while (sample.getNumSamplesUntilFinished() > 0)
+    {
+        // the last block is partial, voices append
+        std::fill(ref.begin(), ref.end(), 0.0F);
+        std::fill(buf.begin(), buf.end(), 0.0F);
+        sample.play(ref.data(), bs);
+        voice.play(buf.data(), bs);
+        ASSERT_EQ(ref, buf);
+    }
+    ASSERT_TRUE(voice.isFinished());
+    ASSERT_FALSE(sample.isResampling());
+    ASSERT_FALSE(voice.isResampling());
+
+    // a clone only keeps its pitch, without resampler it does not play
+    CSample up(sample, 0, 0, 2, 1);
+    CSample upRef(params, 2, 1);
+    ASSERT_EQ(sample.getAsset(), up.getAsset());
+    ASSERT_FALSE(up.isResampling());
+    ASSERT_TRUE(upRef.isResampling());
+    up.on();
+    up.play(buf.data(), bs);
+    ASSERT_TRUE(up.isFinished());
+
+    // a voice holding resamplers takes the one of the pitch of its source,
+    // and plays as a sample owning its asset
+    voice.addResampler(3, 2);
+    voice.addResampler(2, 1);
+    voice.addResampler(2, 1);
+    voice.setSource(up);
+    ASSERT_TRUE(voice.isResampling());
+    voice.on();
+    upRef.on();
+    int32_t numBlocks = 0;
+    while (!upRef.isFinished())
+    {
+        std::fill(buf.begin(), buf.end(), 0.0F);
+        upRef.play(ref.data(), bs);
+        voice.play(buf.data(), bs);
+        ASSERT_EQ(ref, buf) << "block " << numBlocks;
+        numBlocks++;
+    }
+    ASSERT_TRUE(voice.isFinished());
+    ASSERT_GT(numBlocks, 1);
+    voice.setSource(sample);
+    ASSERT_FALSE(voice.isResampling());
+
+    // unsupported ratios play as is
+    CSample bypass(sample, 0, 0, 5, 1);
+    ASSERT_FALSE(bypass.isResampling());
+    ASSERT_EQ(1, bypass.getUsFactor());
+}
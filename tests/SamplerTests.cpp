@@ -0,0 +1,376 @@
+#include "gtest/gtest.h"
+#include "Sampler.h"
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include "TestUtils.h"
+
+namespace fs = std::filesystem;
+
+//=============================================================
+// Helper functions
+//=============================================================
+
+class Sampler : public ::testing::Test
+{
+protected:
+    static const int32_t m_Blocksize = 64;
+    static const int32_t m_Len = 75 * m_Blocksize;
+    std::vector<float32_t> m_Buf = std::vector<float32_t>(m_Blocksize);
+
+    /**
+     * @brief Write a constant WAV of m_Len samples to out/ and get the
+     *        parameters of a zone playing it without envelope
+     */
+    CSampleParams makeZone(cfloat32_t value, cint32_t lokey, cint32_t hikey,
+                           cint32_t lovel = 0, cint32_t hivel = 127, cint32_t len = m_Len)
+    {
+        auto path = fs::absolute(__FILE__).parent_path() / "out" /
+                    ("Sampler_" + std::to_string(lokey) + "_" + std::to_string(lovel) + ".wav");
+        write_wav(path.string(), std::vector<float32_t>(len, value));
+
+        CSampleParams params;
+        params.path = path.string();
+        params.lokey = lokey;
+        params.hikey = hikey;
+        params.lovel = lovel;
+        params.hivel = hivel;
+        return params;
+    }
+
+    float32_t play(CSampler &sampler, cint32_t numBlocks = 1)
+    {
+        for (auto n = 0; n < numBlocks; n++)
+            sampler.play(m_Buf.data(), m_Blocksize);
+        return m_Buf[m_Blocksize - 1];
+    }
+};
+
+//=============================================================
+// Test cases
+//=============================================================
+
+TEST_F(Sampler, Dispatch)
+{
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(makeZone(0.25F, 60, 60, 0, 63)));
+    ASSERT_EQ(1, sampler.addSample(makeZone(0.5F, 60, 60, 64, 127)));
+    ASSERT_EQ(2, sampler.addSample(makeZone(0.125F, 61, 62)));
+    ASSERT_EQ(0, sampler.init(8));
+
+    ASSERT_EQ(0, play(sampler));
+    ASSERT_EQ(1, sampler.noteOn(60, 30));
+    ASSERT_NEAR(0.25F, play(sampler), 1.E-4F);
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    ASSERT_NEAR(0.75F, play(sampler), 1.E-4F);
+    ASSERT_EQ(1, sampler.noteOn(62, 1));
+    ASSERT_NEAR(0.875F, play(sampler), 1.E-4F);
+    ASSERT_EQ(0, sampler.noteOn(70, 100));
+    ASSERT_EQ(-1, sampler.noteOn(128, 100));
+    ASSERT_EQ(3, sampler.getNumActiveVoices());
+
+    // without release nor fade out, the voices fade out over STEAL_FADE_S
+    sampler.noteOff(60);
+    cfloat32_t fading = play(sampler);
+    ASSERT_GT(fading, 0.125F);
+    ASSERT_LT(fading, 0.875F);
+    ASSERT_NEAR(0.125F, play(sampler, 4), 1.E-4F);
+    ASSERT_EQ(1, sampler.getNumActiveVoices());
+
+    // voices go back to the pool when their sample ends
+    play(sampler, 75);
+    ASSERT_EQ(0, sampler.getNumActiveVoices());
+    ASSERT_EQ(0, play(sampler));
+    ASSERT_EQ(0, sampler.getNumStolen());
+}
+
+TEST_F(Sampler, Voice_Stealing)
+{
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(makeZone(0.25F, 60, 61)));
+    auto slow = makeZone(0.5F, 62, 62);
+    slow.attack_s = 0.5F;
+    ASSERT_EQ(1, sampler.addSample(slow));
+    auto looped = makeZone(0.5F, 63, 63);
+    looped.loop_start = 0;
+    looped.loop_end = m_Len;
+    looped.release_s = 0.5F;
+    ASSERT_EQ(2, sampler.addSample(looped));
+    ASSERT_EQ(0, sampler.init(2));
+    cint32_t fadeBlocks = 4; // STEAL_FADE_S
+
+    // the oldest voice fades out, then the new note starts
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    play(sampler, 10);
+    ASSERT_EQ(1, sampler.noteOn(61, 100));
+    play(sampler, 10);
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    ASSERT_EQ(1, sampler.getNumStolen());
+    cfloat32_t fading = play(sampler);
+    ASSERT_GT(fading, 0.25F);
+    ASSERT_LT(fading, 0.5F);
+    play(sampler, fadeBlocks - 1);
+    ASSERT_EQ(1, sampler.getNumActiveVoices());
+    ASSERT_NEAR(0.5F, play(sampler), 1.E-4F);
+    ASSERT_EQ(2, sampler.getNumActiveVoices());
+    play(sampler, 60); // the voice of 61 ends before the new one
+    ASSERT_EQ(1, sampler.getNumActiveVoices());
+
+    // a voice in its attack is not stolen before an older one
+    sampler.allNotesOff();
+    play(sampler, fadeBlocks);
+    ASSERT_EQ(0, sampler.getNumActiveVoices());
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    play(sampler, 10);
+    ASSERT_EQ(1, sampler.noteOn(62, 100));
+    play(sampler);
+    ASSERT_EQ(1, sampler.noteOn(61, 100));
+    ASSERT_EQ(2, sampler.getNumStolen());
+    sampler.noteOff(60); // stolen already
+    play(sampler, fadeBlocks + 1);
+    cfloat32_t attack = play(sampler) - 0.25F;
+    ASSERT_GT(attack, 1.E-3F);
+    ASSERT_LT(attack, 0.25F);
+
+    // a releasing voice is stolen before an older one
+    sampler.allNotesOff();
+    play(sampler, fadeBlocks);
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    play(sampler);
+    ASSERT_EQ(1, sampler.noteOn(63, 100));
+    play(sampler);
+    sampler.noteOff(63);
+    ASSERT_GT(play(sampler), 0.5F);
+    ASSERT_EQ(1, sampler.noteOn(61, 100));
+    ASSERT_EQ(3, sampler.getNumStolen());
+    play(sampler, fadeBlocks + 1);
+    ASSERT_NEAR(0.5F, play(sampler), 1.E-4F);
+
+    // notes queued behind a stolen voice are dropped by their note off
+    ASSERT_EQ(1, sampler.noteOn(62, 100));
+    sampler.noteOff(62);
+    play(sampler, fadeBlocks + 1);
+    ASSERT_EQ(1, sampler.getNumActiveVoices());
+}
+
+TEST_F(Sampler, Voice_Stealing_Closest_To_End)
+{
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(makeZone(0.25F, 60, 60)));
+    ASSERT_EQ(1, sampler.addSample(makeZone(0.5F, 61, 61, 0, 127, 20 * m_Blocksize)));
+    ASSERT_EQ(2, sampler.addSample(makeZone(0.125F, 62, 62)));
+    ASSERT_EQ(0, sampler.init(2));
+    cint32_t fadeBlocks = 4; // STEAL_FADE_S
+
+    // the newer voice ends first, it is stolen rather than the older one
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    play(sampler, 2);
+    ASSERT_EQ(1, sampler.noteOn(61, 100));
+    play(sampler);
+    ASSERT_EQ(1, sampler.noteOn(62, 100));
+    ASSERT_EQ(1, sampler.getNumStolen());
+    play(sampler, fadeBlocks + 1);
+    ASSERT_NEAR(0.375F, play(sampler), 1.E-4F);
+    ASSERT_EQ(2, sampler.getNumActiveVoices());
+}
+
+TEST_F(Sampler, Pitched_Zones)
+{
+    CSampler sampler;
+    ASSERT_EQ(0, sampler.addSample(makeZone(0.25F, 60, 60)));
+    ASSERT_EQ(1, sampler.addSample(makeZone(0.25F, 61, 61), 2, 1));
+    ASSERT_EQ(2, sampler.addSample(makeZone(0.25F, 62, 62), 2, 3));
+    ASSERT_EQ(0, sampler.init(2));
+
+    // the voices resample with the resampler of the pitch of the zone: an
+    // octave down plays twice as long
+    ASSERT_EQ(1, sampler.noteOn(61, 100));
+    play(sampler, 8);
+    ASSERT_NEAR(0.25F, play(sampler), 1.E-2F);
+    play(sampler, 100);
+    ASSERT_EQ(1, sampler.getNumActiveVoices());
+    play(sampler, 50);
+    ASSERT_EQ(0, sampler.getNumActiveVoices());
+
+    // a fifth up: each voice holds the resamplers of all pitches
+    ASSERT_EQ(1, sampler.noteOn(62, 100));
+    play(sampler, 8);
+    ASSERT_NEAR(0.25F, play(sampler), 1.E-2F);
+    play(sampler, 45);
+    ASSERT_EQ(0, sampler.getNumActiveVoices());
+}
+
+TEST_F(Sampler, Round_Robin)
+{
+    CSampler sampler;
+    for (auto pos = 1; pos <= 3; pos++)
+    {
+        auto params = makeZone(0.125F * pos, 40, 50, pos, 127);
+        params.lovel = 0;
+        params.seq_length = 3;
+        params.seq_position = pos;
+        ASSERT_EQ(pos - 1, sampler.addSample(params));
+    }
+    ASSERT_EQ(3, sampler.addSample(makeZone(0.0625F, 45, 45)));
+    ASSERT_EQ(0, sampler.init(16));
+
+    // each note on plays the next zone of the group, counted per key
+    cfloat32_t expected[] = {0.125F, 0.25F, 0.375F, 0.125F};
+    for (auto n = 0; n < 4; n++)
+    {
+        sampler.allNotesOff();
+        play(sampler, 4); // STEAL_FADE_S
+        ASSERT_EQ(1, sampler.noteOn(40, 64));
+        ASSERT_NEAR(expected[n], play(sampler), 1.E-4F);
+    }
+    sampler.allNotesOff();
+    play(sampler, 4);
+    ASSERT_EQ(2, sampler.noteOn(45, 64)); // group and the zone without group
+    ASSERT_NEAR(0.125F + 0.0625F, play(sampler), 1.E-4F);
+    ASSERT_EQ(1, sampler.noteOn(40, 1));
+    ASSERT_EQ(0, sampler.noteOn(51, 64));
+}
+
+TEST_F(Sampler, Round_Robin_Velocity)
+{
+    CSampler sampler;
+    for (auto pos = 1; pos <= 3; pos++)
+    {
+        auto params = makeZone(0.125F * pos, 40, 41, 0, 127);
+        params.seq_length = 3;
+        params.seq_position = pos;
+        ASSERT_EQ(pos - 1, sampler.addSample(params));
+    }
+    ASSERT_EQ(0, sampler.init(16));
+
+    // the group takes turns on a key whatever the velocity, each key on its own
+    const int32_t vels[] = {64, 100, 10, 127, 1, 90};
+    cfloat32_t expected[] = {0.125F, 0.25F, 0.375F, 0.125F, 0.25F, 0.375F};
+    for (auto n = 0; n < 6; n++)
+    {
+        sampler.allNotesOff();
+        play(sampler, 4); // STEAL_FADE_S
+        ASSERT_EQ(1, sampler.noteOn(40, vels[n]));
+        ASSERT_NEAR(expected[n], play(sampler), 1.E-4F) << "note " << n;
+    }
+    sampler.allNotesOff();
+    play(sampler, 4);
+    ASSERT_EQ(1, sampler.noteOn(41, 30));
+    ASSERT_NEAR(0.125F, play(sampler), 1.E-4F);
+}
+
+TEST_F(Sampler, Lazy_LRU)
+{
+    CSampler sampler;
+    for (auto key = 60; key < 66; key++)
+    {
+        auto params = makeZone(0.25F, key, key);
+        params.lazy = true;
+        ASSERT_EQ(key - 60, sampler.addSample(params));
+        ASSERT_FALSE(sampler.isResident(key - 60));
+    }
+    ASSERT_EQ(0u, sampler.getMemorySize());
+    ASSERT_EQ(0, sampler.init(4, CSampler::DEFAULT_HORIZON, false));
+    auto expectResident = [&](const std::vector<bool_t> &resident)
+    {
+        for (auto z = 0; z < 6; z++)
+            ASSERT_EQ(resident[z], sampler.isResident(z)) << "zone " << z;
+    };
+
+    // the note waits for the I/O thread to decode its zone, with the neighbours
+    ASSERT_EQ(1, sampler.noteOn(62, 100));
+    ASSERT_EQ(0, play(sampler));
+    ASSERT_EQ(0, sampler.getNumActiveVoices());
+    ASSERT_NO_FATAL_FAILURE(expectResident({false, false, false, false, false, false}));
+    ASSERT_EQ(3, sampler.runIO());
+    ASSERT_NEAR(0.25F, play(sampler), 1.E-4F);
+    ASSERT_NO_FATAL_FAILURE(expectResident({false, true, true, true, false, false}));
+    cint32_t zoneSize = m_Len * sizeof(int16_t);
+    ASSERT_EQ(3u * zoneSize, sampler.getMemorySize());
+
+    // with a budget of 3 zones, the least recently used ones go, unless playing
+    sampler.setMemoryBudget(3 * zoneSize);
+    ASSERT_EQ(1, sampler.noteOn(64, 100)); // 62 plays, 63 to 65 are used now: only 61 goes
+    sampler.runIO();
+    ASSERT_NEAR(0.5F, play(sampler), 1.E-4F);
+    ASSERT_EQ(4u * zoneSize, sampler.getMemorySize());
+    ASSERT_EQ(1, sampler.runIO());
+    ASSERT_NO_FATAL_FAILURE(expectResident({false, false, true, true, true, true}));
+
+    // evicted zones are decoded again, the zones played last stay longer
+    sampler.allNotesOff();
+    play(sampler, 4);
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    sampler.runIO();
+    ASSERT_NEAR(0.25F, play(sampler), 1.E-4F);
+    sampler.runIO();
+    ASSERT_NO_FATAL_FAILURE(expectResident({true, true, false, false, true, false}));
+    ASSERT_EQ(3u * zoneSize, sampler.getMemorySize());
+}
+
+TEST_F(Sampler, Lazy_IO_Thread)
+{
+    CSampler sampler;
+    auto params = makeZone(0.25F, 60, 60);
+    params.lazy = true;
+    ASSERT_EQ(0, sampler.addSample(params));
+    ASSERT_EQ(0, sampler.init(4));
+
+    // the note starts within a few blocks, whenever the zone is decoded
+    ASSERT_EQ(1, sampler.noteOn(60, 100));
+    float32_t out = 0.0F;
+    for (auto n = 0; n < 1000 && out == 0.0F; n++)
+    {
+        out = play(sampler);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_NEAR(0.25F, out, 1.E-4F);
+    ASSERT_TRUE(sampler.isResident(0));
+}
+
+TEST_F(Sampler, Lazy_LRU_IO_Thread)
+{
+    CSampler sampler;
+    for (auto key = 60; key < 66; key++)
+    {
+        auto params = makeZone(0.25F, key, key);
+        params.lazy = true;
+        ASSERT_EQ(key - 60, sampler.addSample(params));
+    }
+    ASSERT_EQ(0, sampler.init(4));
+    cint32_t zoneSize = m_Len * sizeof(int16_t);
+    sampler.setMemoryBudget(3 * zoneSize);
+    auto numResident = [&]()
+    {
+        int32_t num = 0;
+        for (auto z = 0; z < 6; z++)
+            num += sampler.isResident(z) ? 1 : 0;
+        return num;
+    };
+
+    // zones are decoded and evicted by the I/O thread while the notes play
+    for (auto n = 0; n < 24; n++)
+    {
+        ASSERT_EQ(1, sampler.noteOn(60 + (5 * n) % 6, 100));
+        float32_t out = 0.0F;
+        for (auto i = 0; i < 1000 && out == 0.0F; i++)
+        {
+            out = play(sampler);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        ASSERT_NEAR(0.25F, out, 1.E-4F) << "note " << n;
+        sampler.allNotesOff();
+        play(sampler, 4);
+    }
+
+    // once the I/O thread is done, the memory counted is the one of the resident zones
+    for (auto i = 0; i < 1000 && sampler.getMemorySize() != numResident() * (size_t)zoneSize; i++)
+    {
+        play(sampler);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(numResident() * (size_t)zoneSize, sampler.getMemorySize());
+    ASSERT_LE(sampler.getMemorySize(), 3u * zoneSize);
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include "AudioTypes.h"
+#include "AudioAtom.h"
 #include "gtest/gtest.h"
 #include <filesystem>
 
@@ -77,6 +78,55 @@ protected:
     }
 };
 
+/**
+ * @brief Base of the tests playing the same signal through two atoms in two
+ * different ways, e.g. planar and interleaved, and comparing their outputs
+ */
+class AtomCompareTest : public ::testing::Test
+{
+protected:
+    int32_t m_Blocksize = 64;
+    int32_t m_Fs = 48000;
+
+    /**
+     * @brief One sine of amplitude amp and pulsation (ch + 1) * w per channel,
+     * over samples [pos, pos + len)
+     */
+    static std::vector<std::vector<float32_t>> sines(cint32_t nch, cint32_t len, cfloat32_t amp,
+                                                     cfloat32_t w, cint32_t pos = 0)
+    {
+        std::vector<std::vector<float32_t>> bufs(nch, std::vector<float32_t>(len));
+        for (auto ch = 0; ch < nch; ch++)
+            for (auto i = 0; i < len; i++)
+                bufs[ch][i] = amp * sinf(w * (ch + 1) * (pos + i));
+        return bufs;
+    }
+
+    /**
+     * @brief Channel pointers into bufs, from sample pos
+     */
+    static std::vector<float32_t *> pointers(std::vector<std::vector<float32_t>> &bufs, cint32_t pos = 0)
+    {
+        std::vector<float32_t *> ptrs;
+        for (auto &buf : bufs)
+            ptrs.push_back(&buf[pos]);
+        return ptrs;
+    }
+
+    /**
+     * @brief Compare the first len samples of each channel of ref and var
+     */
+    static void expectNear(const std::vector<std::vector<float32_t>> &ref,
+                           const std::vector<std::vector<float32_t>> &var, cint32_t len,
+                           const std::string &what = "", cfloat32_t eps = 1.E-6F)
+    {
+        ASSERT_EQ(ref.size(), var.size());
+        for (size_t ch = 0; ch < ref.size(); ch++)
+            for (auto i = 0; i < len; i++)
+                ASSERT_NEAR(ref[ch][i], var[ch][i], eps) << what << " ch " << ch << " sample " << i;
+    }
+};
+
 /**
  * @brief Splits a string according to a delimiter
  *